@@ -0,0 +1,431 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  data_conversion_check.cpp
+ * @brief Data conversion table check.
+ *
+ * Sweeps every module, param ID and a dense range of values through the
+ * table-driven data conversions, and checks the results against the reference
+ * (switch based) implementation they replaced. The to normalised float results
+ * may differ by at most MAX_TO_NORMALISED_ERROR, as the tables use a multiply
+ * by the reciprocal rather than a divide, and the from normalised float results
+ * must be identical. Returns a non-zero exit code if any result differs.
+ *-----------------------------------------------------------------------------
+ */
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include "data_conversion.h"
+#include "monique_synth_parameters.h"
+#include "arp_manager.h"
+#include "seq_manager.h"
+#include "pedals_manager.h"
+
+// Constants
+constexpr float MAX_TO_NORMALISED_ERROR = 2 * __FLT_EPSILON__;
+constexpr int MIN_PARAM_ID              = -1;
+constexpr int MAX_PARAM_ID              = 32;
+constexpr float MIN_VALUE               = -10.0f;
+constexpr float MAX_VALUE               = 320.0f;
+constexpr float VALUE_STEP              = 0.01f;
+constexpr uint NORMALISED_STEPS         = 1000000;
+constexpr float MIN_PITCH_BEND_VALUE    = MIDI_PITCH_BEND_MIN_VALUE - 100.0f;
+constexpr float MAX_PITCH_BEND_VALUE    = MIDI_PITCH_BEND_MAX_VALUE + 100.0f;
+constexpr float PITCH_BEND_VALUE_STEP   = 0.25f;
+constexpr uint MAX_REPORTED_ERRORS      = 20;
+
+// Reference implementation
+// Note: This is the data conversion implementation replaced by the conversion
+// tables, and must not be changed
+namespace reference
+{
+    // Convert TO a normalised float
+    float to_normalised_float(MoniqueModule module, int param_id, float value) {
+        // Conversion based on the module
+        switch (module) {
+            case MoniqueModule::DAW:
+                // Call the MONIQUE synth params conversion function
+                return Monique::to_normalised_float(param_id, value);
+
+            case MoniqueModule::SYSTEM: {
+                switch (param_id) {
+                    case SystemParamId::TEMPO_BPM_PARAM_ID: {
+                        // Convert the tempo to normalised float
+                        auto tempo = std::clamp(value, common::MIN_TEMPO_BPM, common::MAX_TEMPO_BPM);
+                        return -0.1059 + (0.005330 * tempo) - (0.00000167 * tempo * tempo) - (0.00000000557 * tempo * tempo * tempo);
+                    }
+
+                    case SystemParamId::SEQ_ARP_MIDI_CHANNEL_PARAM_ID:
+                    case SystemParamId::KBD_MIDI_CHANNEL_PARAM_ID: {
+                        // Convert the MIDI channel to normalised float
+                        auto val = std::clamp(value, 0.0f, 16.0f);
+                        return val / 17;
+                    }
+
+                    case SystemParamId::SUSTAIN_POLARITY_PARAM_ID: {
+                        // Convert the Sustain Polarity to a normalised float
+                        auto val = std::clamp(value, static_cast<float>(SustainPolarity::POSITIVE), static_cast<float>(SustainPolarity::NEGATIVE));
+                        return val / SustainPolarity::NUM_SUSTAIN_POLARITIES;
+                    }
+
+                    case SystemParamId::MIDI_ECHO_FILTER_PARAM_ID: {
+                        // Convert the MIDI echo filter to a normalised float
+                        auto val = std::clamp(value, static_cast<float>(MidiEchoFilter::NO_FILTER), static_cast<float>(MidiEchoFilter::FILTER_ALL));
+                        return val / MidiEchoFilter::NUM_ECHO_FILTERS;
+                    }
+
+                    case SystemParamId::AT_SENSITIVITY_PARAM_ID: {
+                        // Convert the AT Sensitivity to a normalised float
+                        auto val = std::clamp(value, 0.0f, 15.0f);
+                        return val / 16.0f;
+                    }
+
+                    default:
+                        break;
+                }
+                break;
+            }
+
+            case MoniqueModule::SEQ: {
+                switch(param_id) {
+                    case SeqParamId::MODE_PARAM_ID: {
+                        // Convert the SEQ mode to a normalised float
+                        auto val = std::clamp(value, static_cast<float>(SeqMode::STEP), static_cast<float>(SeqMode::PHRASE_LOOPER));
+                        return val / (float)SeqMode::NUM_MODES;
+                    }
+
+                    case SeqParamId::NUM_STEPS_PARAM_ID: {
+                        // Convert the SEQ number of steps to a normalised float
+                        auto val = std::clamp(value, 1.0f, (float)STEP_SEQ_MAX_STEPS);
+                        return (val - 1.0f) / STEP_SEQ_MAX_STEPS;
+                    }
+
+                    case SeqParamId::TEMPO_NOTE_VALUE_PARAM_ID: {
+                        // Convert the Tempo Note value to a normalised float
+                        auto val = std::clamp(value, static_cast<float>(common::TempoNoteValue::QUARTER), static_cast<float>(common::TempoNoteValue::THIRTYSECOND_TRIPLETS));
+                        return val / common::TempoNoteValue::NUM_TEMPO_NOTE_VALUES;
+                    }
+
+                    case SeqParamId::PHRASE_QUANTISATION_PARAM_ID: {
+                        // Convert the Phrase Quantisation value to a normalised float
+                        auto val = std::clamp(value, static_cast<float>(PhraseQuantisation::NONE), static_cast<float>(PhraseQuantisation::THIRTYSECOND_TRIPLETS));
+                        return val / PhraseQuantisation::NUM_PHRASE_QUANTISATION_VALUES;
+                    }
+
+                    case SeqParamId::PHRASE_BEATS_PER_BAR_PARAM_ID: {
+                        // Convert the Phrase Beats per Bar to a normalised float
+                        auto val = std::clamp(value, static_cast<float>(PhraseBeatsPerBar::NONE), static_cast<float>(PhraseBeatsPerBar::FIVE));
+                        return val / (float)PhraseBeatsPerBar::NUM_BEATS_PER_BAR_VALUES;
+                    }
+
+                    default:
+                        break;
+                }
+                break;
+            }
+
+            case MoniqueModule::ARP: {
+                switch(param_id) {
+                    case ArpParamId::ARP_DIR_MODE_PARAM_ID: {
+                        // Convert the DIR mode to a normalised float
+                        auto val = std::clamp(value, static_cast<float>(ArpDirMode::UP), static_cast<float>(ArpDirMode::ASSIGNED));
+                        return val / ArpDirMode::NUM_DIR_MODES;
+                    }
+
+                    case ArpParamId::ARP_TEMPO_NOTE_VALUE_PARAM_ID: {
+                        // Convert the Tempo Note value to a normalised float
+                        auto val = std::clamp(value, static_cast<float>(common::TempoNoteValue::QUARTER), static_cast<float>(common::TempoNoteValue::THIRTYSECOND_TRIPLETS));
+                        return val / common::TempoNoteValue::NUM_TEMPO_NOTE_VALUES;
+                    }
+
+                    default:
+                        break;
+                }
+                break;
+            }
+
+            default:
+                break;
+        }
+        return value;
+    }
+
+    // Special cases - Pitch Bend, Aftertouch, and MIDI CC
+    float pitch_bend_to_normalised_float(float value) {
+        auto val = std::clamp(value, (float)MIDI_PITCH_BEND_MIN_VALUE, (float)MIDI_PITCH_BEND_MAX_VALUE);
+        return (val - MIDI_PITCH_BEND_MIN_VALUE) / (MIDI_PITCH_BEND_MAX_VALUE - MIDI_PITCH_BEND_MIN_VALUE);
+    }
+
+    float aftertouch_to_normalised_float(float value) {
+        // Note: Chanpress == Aftertouch
+        auto val = std::clamp(value, (float)MIDI_CHANPRESS_MIN_VALUE, (float)MIDI_CHANPRESS_MAX_VALUE);
+        return (val - MIDI_CHANPRESS_MIN_VALUE) / (MIDI_CHANPRESS_MAX_VALUE - MIDI_CHANPRESS_MIN_VALUE);
+    }
+
+    float midi_cc_to_normalised_float(float value) {
+        auto val = std::clamp(value, (float)MIDI_CC_MIN_VALUE, (float)MIDI_CC_MAX_VALUE);
+        return (val - MIDI_CC_MIN_VALUE) / (MIDI_CC_MAX_VALUE - MIDI_CC_MIN_VALUE);
+    }
+
+    // Convert FROM a normalised float
+    float from_normalised_float(MoniqueModule module, int param_id, float value) {
+        // Clamp the passed normalised float to min/max
+        value = std::clamp(value, 0.0f, 1.0f);
+
+        // Conversion based on the module
+        switch (module) {
+            case MoniqueModule::DAW:
+                // Call the MONIQUE synth params conversion function
+                return Monique::from_normalised_float(param_id, value);
+
+            case MoniqueModule::SYSTEM: {
+                switch (param_id) {
+                    case SystemParamId::TEMPO_BPM_PARAM_ID: {
+                        // Convert the normalised float to a value between the min and max bpm
+                        // Quantise the value to 0.1 if less than 100 BPM, and 0.5 if above
+                        auto val = std::pow(1.9, 3 + (3.106 * value)) + (176.5 * value) + 13.16;
+                        return val >= 100.0f ?
+                            std::round(val * 2.0f) / 2.0f :
+                            std::round(val * 10.0f) / 10.0f;
+                    }
+
+                    case SystemParamId::SEQ_ARP_MIDI_CHANNEL_PARAM_ID:
+                    case SystemParamId::KBD_MIDI_CHANNEL_PARAM_ID: {
+                        // Convert the normalised float to a MIDI channel value
+                        auto val = value * 17;
+                        return std::clamp(val, 0.0f, 16.0f);
+                    }
+
+                    case SystemParamId::SUSTAIN_POLARITY_PARAM_ID: {
+                        // Convert the normalised float to a Sustain Polarity
+                        auto val = value * SustainPolarity::NUM_SUSTAIN_POLARITIES;
+                        return std::clamp(val, static_cast<float>(SustainPolarity::POSITIVE), static_cast<float>(SustainPolarity::NEGATIVE));
+                    }
+
+                    case SystemParamId::MIDI_ECHO_FILTER_PARAM_ID: {
+                        // Convert the normalised float to a MIDI Echo Filter value
+                        auto val = value * MidiEchoFilter::NUM_ECHO_FILTERS;
+                        return std::clamp(val, static_cast<float>(MidiEchoFilter::NO_FILTER), static_cast<float>(MidiEchoFilter::FILTER_ALL));
+                    }
+
+                    case SystemParamId::AT_SENSITIVITY_PARAM_ID: {
+                        // Convert the normalised float to an AT Sensitivity value
+                        auto val = value * 16.0f;
+                        return std::clamp(val, 0.0f, 15.0f);
+                    }
+
+                    default:
+                        break;
+                }
+                break;
+            }
+
+            case MoniqueModule::SEQ: {
+                switch (param_id) {
+                    case SeqParamId::MODE_PARAM_ID: {
+                        // Convert the normalised float to a Seq mode
+                        auto val = value * (float)SeqMode::NUM_MODES;
+                        return std::clamp(val, static_cast<float>(SeqMode::STEP), static_cast<float>(SeqMode::PHRASE_LOOPER));
+                    }
+
+                    case SeqParamId::NUM_STEPS_PARAM_ID: {
+                        // Convert the normalised float to Sequencer number of steps
+                        auto val = value * STEP_SEQ_MAX_STEPS + 1.0f;
+                        return std::clamp(val, 1.0f, (float)STEP_SEQ_MAX_STEPS);
+                    }
+
+                    case SeqParamId::TEMPO_NOTE_VALUE_PARAM_ID: {
+                        // Convert the normalised float to a Tempo note value
+                        auto val = value * common::TempoNoteValue::NUM_TEMPO_NOTE_VALUES;
+                        return std::clamp(val, static_cast<float>(common::TempoNoteValue::QUARTER), static_cast<float>(common::TempoNoteValue::THIRTYSECOND_TRIPLETS));
+                    }
+
+                    case SeqParamId::PHRASE_QUANTISATION_PARAM_ID: {
+                        // Convert the normalised float to a Phrase Quantiastion value
+                        auto val = value * PhraseQuantisation::NUM_PHRASE_QUANTISATION_VALUES;
+                        return std::clamp(val, static_cast<float>(PhraseQuantisation::NONE), static_cast<float>(PhraseQuantisation::THIRTYSECOND_TRIPLETS));
+                    }
+
+                    case SeqParamId::PHRASE_BEATS_PER_BAR_PARAM_ID: {
+                        // Convert the normalised float to a Phrase Beats per Bar value
+                        auto val = value * (float)PhraseBeatsPerBar::NUM_BEATS_PER_BAR_VALUES;
+                        return std::clamp(val, static_cast<float>(PhraseBeatsPerBar::NONE), static_cast<float>(PhraseBeatsPerBar::FIVE));
+                    }
+                }
+                break;
+            }
+
+            case MoniqueModule::ARP: {
+                switch (param_id) {
+                    case ArpParamId::ARP_DIR_MODE_PARAM_ID: {
+                        // Convert the normalised float to a DIR mode
+                        auto val = value * ArpDirMode::NUM_DIR_MODES;
+                        return std::clamp(val, static_cast<float>(ArpDirMode::UP), static_cast<float>(ArpDirMode::ASSIGNED));
+                    }
+
+                    case ArpParamId::ARP_TEMPO_NOTE_VALUE_PARAM_ID: {
+                        // Convert the normalised float to a Tempo note value
+                        auto val = value * common::TempoNoteValue::NUM_TEMPO_NOTE_VALUES;
+                        return std::clamp(val, static_cast<float>(common::TempoNoteValue::QUARTER), static_cast<float>(common::TempoNoteValue::THIRTYSECOND_TRIPLETS));
+                    }
+                }
+                break;
+            }
+
+            default:
+                break;
+        }
+        return value;
+    }
+
+    // Special cases - Pitch Bend, Aftertouch, and MIDI CC
+    float pitch_bend_from_normalised_float(float value) {
+        auto val = (value * (MIDI_PITCH_BEND_MAX_VALUE - MIDI_PITCH_BEND_MIN_VALUE)) + MIDI_PITCH_BEND_MIN_VALUE;
+        return std::clamp(val, (float)MIDI_PITCH_BEND_MIN_VALUE, (float)MIDI_PITCH_BEND_MAX_VALUE);
+    }
+
+    float aftertouch_from_normalised_float(float value) {
+        // Note: Chanpress == Aftertouch
+        auto val = (value * (MIDI_CHANPRESS_MAX_VALUE - MIDI_CHANPRESS_MIN_VALUE)) + MIDI_CHANPRESS_MIN_VALUE;
+        return std::clamp(val, (float)MIDI_CHANPRESS_MIN_VALUE, (float)MIDI_CHANPRESS_MAX_VALUE);
+    }
+
+    float midi_cc_from_normalised_float(float value) {
+        auto val = (value * (MIDI_CC_MAX_VALUE - MIDI_CC_MIN_VALUE)) + MIDI_CC_MIN_VALUE;
+        return std::clamp(val, (float)MIDI_CC_MIN_VALUE, (float)MIDI_CC_MAX_VALUE);
+    }
+};
+
+// Check Results
+struct CheckResults
+{
+    uint64_t num_checks;
+    uint64_t num_errors;
+    float max_to_normalised_error;
+};
+
+// Global variables
+static CheckResults _results = {};
+
+//----------------------------------------------------------------------------
+// _check_to_normalised
+//----------------------------------------------------------------------------
+static void _check_to_normalised(const char *name, int param_id, float value, float result, float expected)
+{
+    // Check the result is within the allowed error of the reference result
+    auto error = std::fabs(result - expected);
+    _results.num_checks++;
+    _results.max_to_normalised_error = std::max(_results.max_to_normalised_error, error);
+    if (!(error <= MAX_TO_NORMALISED_ERROR)) {
+        if (_results.num_errors++ < MAX_REPORTED_ERRORS) {
+            std::printf("%s to normalised: param %d value %.9g: %.9g, expected %.9g\n", name, param_id, value, result, expected);
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// _check_from_normalised
+//----------------------------------------------------------------------------
+static void _check_from_normalised(const char *name, int param_id, float value, float result, float expected)
+{
+    // Check the result is identical to the reference result
+    _results.num_checks++;
+    if (std::memcmp(&result, &expected, sizeof(float)) != 0) {
+        if (_results.num_errors++ < MAX_REPORTED_ERRORS) {
+            std::printf("%s from normalised: param %d value %.9g: %.9g, expected %.9g\n", name, param_id, value, result, expected);
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// _check_module
+//----------------------------------------------------------------------------
+static void _check_module(const char *name, MoniqueModule module)
+{
+    // Check each param ID, including IDs with no conversion
+    for (int param_id=MIN_PARAM_ID; param_id<=MAX_PARAM_ID; param_id++) {
+        // Check the to normalised float conversion over the value range, and each
+        // integer value (as most params are integer values)
+        for (float value=MIN_VALUE; value<=MAX_VALUE; value+=VALUE_STEP) {
+            _check_to_normalised(name, param_id, value,
+                                 dataconv::to_normalised_float(module, param_id, value),
+                                 reference::to_normalised_float(module, param_id, value));
+        }
+        for (int value=MIN_VALUE; value<=MAX_VALUE; value++) {
+            _check_to_normalised(name, param_id, value,
+                                 dataconv::to_normalised_float(module, param_id, value),
+                                 reference::to_normalised_float(module, param_id, value));
+        }
+
+        // Check the from normalised float conversion over (and just outside) the
+        // normalised range
+        for (uint i=0; i<=NORMALISED_STEPS; i++) {
+            float value = -0.1f + ((1.2f * i) / NORMALISED_STEPS);
+            _check_from_normalised(name, param_id, value,
+                                   dataconv::from_normalised_float(module, param_id, value),
+                                   reference::from_normalised_float(module, param_id, value));
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// _check_special_cases
+//----------------------------------------------------------------------------
+static void _check_special_cases()
+{
+    // Check the Pitch Bend conversions
+    for (float value=MIN_PITCH_BEND_VALUE; value<=MAX_PITCH_BEND_VALUE; value+=PITCH_BEND_VALUE_STEP) {
+        _check_to_normalised("Pitch Bend", 0, value, dataconv::pitch_bend_to_normalised_float(value),
+                             reference::pitch_bend_to_normalised_float(value));
+    }
+
+    // Check the Aftertouch and MIDI CC conversions
+    for (float value=MIN_VALUE; value<=MAX_VALUE; value+=VALUE_STEP) {
+        _check_to_normalised("Aftertouch", 0, value, dataconv::aftertouch_to_normalised_float(value),
+                             reference::aftertouch_to_normalised_float(value));
+        _check_to_normalised("MIDI CC", 0, value, dataconv::midi_cc_to_normalised_float(value),
+                             reference::midi_cc_to_normalised_float(value));
+    }
+    for (int value=MIN_VALUE; value<=MAX_VALUE; value++) {
+        _check_to_normalised("Aftertouch", 0, value, dataconv::aftertouch_to_normalised_float(value),
+                             reference::aftertouch_to_normalised_float(value));
+        _check_to_normalised("MIDI CC", 0, value, dataconv::midi_cc_to_normalised_float(value),
+                             reference::midi_cc_to_normalised_float(value));
+    }
+
+    // Check the from normalised float conversions
+    for (uint i=0; i<=NORMALISED_STEPS; i++) {
+        float value = -0.1f + ((1.2f * i) / NORMALISED_STEPS);
+        _check_from_normalised("Pitch Bend", 0, value, dataconv::pitch_bend_from_normalised_float(value),
+                               reference::pitch_bend_from_normalised_float(value));
+        _check_from_normalised("Aftertouch", 0, value, dataconv::aftertouch_from_normalised_float(value),
+                               reference::aftertouch_from_normalised_float(value));
+        _check_from_normalised("MIDI CC", 0, value, dataconv::midi_cc_from_normalised_float(value),
+                               reference::midi_cc_from_normalised_float(value));
+    }
+}
+
+//----------------------------------------------------------------------------
+// main
+//----------------------------------------------------------------------------
+int main()
+{
+    // Check each module except the DAW, which is converted by the MONIQUE
+    // synth params conversion functions in both implementations
+    _check_module("SYSTEM", MoniqueModule::SYSTEM);
+    _check_module("MIDI_DEVICE", MoniqueModule::MIDI_DEVICE);
+    _check_module("SEQ", MoniqueModule::SEQ);
+    _check_module("ARP", MoniqueModule::ARP);
+    _check_module("FILE_MANAGER", MoniqueModule::FILE_MANAGER);
+    _check_module("SFC_CONTROL", MoniqueModule::SFC_CONTROL);
+    _check_module("PEDALS", MoniqueModule::PEDALS);
+    _check_module("GUI", MoniqueModule::GUI);
+    _check_module("SOFTWARE", MoniqueModule::SOFTWARE);
+    _check_special_cases();
+
+    // Show the results
+    std::printf("%lu checks, %lu errors, max to normalised error %.3g\n",
+                _results.num_checks, _results.num_errors, _results.max_to_normalised_error);
+    return (_results.num_errors == 0) ? 0 : 1;
+}
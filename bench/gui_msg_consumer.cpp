@@ -0,0 +1,288 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  gui_msg_consumer.cpp
+ * @brief Headless GUI message consumer.
+ *
+ * Attaches to the GUI Message Ring (or the GUI Message Queue) in place of the
+ * GUI app, and records the rate, size and inter-arrival time of each GUI message
+ * type sent by the UI app. Can also simulate a slow GUI, by delaying after each
+ * message read.
+ *-----------------------------------------------------------------------------
+ */
+#include <unistd.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <mqueue.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <thread>
+#include "ui_common.h"
+#include "gui_msg_ring.h"
+#include "gui_msg_mqueue.h"
+
+// Message Type Stats
+struct MsgTypeStats
+{
+    uint64_t count;
+    uint64_t payload_bytes;
+    uint max_payload_bytes;
+    uint64_t interval_count;
+    std::chrono::microseconds interval_total;
+    std::chrono::microseconds interval_min;
+    std::chrono::microseconds interval_max;
+    std::chrono::steady_clock::time_point last_time;
+};
+
+// Constants
+constexpr uint RING_WAIT_TIMEOUT_MS      = 100;
+constexpr uint RING_OPEN_RETRY_MS        = 500;
+constexpr uint DEFAULT_REPORT_INTERVAL_S = 5;
+
+// Global variables
+static std::atomic<bool> _running = true;
+static GuiMsgRing _ring;
+static mqd_t _mq_desc = (mqd_t)-1;
+static uint64_t _mq_seq = 0;
+
+//----------------------------------------------------------------------------
+// _signal_handler
+//----------------------------------------------------------------------------
+static void _signal_handler([[maybe_unused]] int sig)
+{
+    // Stop reading messages
+    _running = false;
+}
+
+//----------------------------------------------------------------------------
+// _payload_bytes
+//----------------------------------------------------------------------------
+static uint _payload_bytes(const GuiMsg& msg)
+{
+    // GUI messages are a fixed size, so use the offset of the last non-zero
+    // byte as the size of the data actually sent
+    auto data = reinterpret_cast<const uint8_t *>(&msg);
+    uint size = sizeof(GuiMsg);
+    while ((size > 0) && (data[size - 1] == 0)) {
+        size--;
+    }
+    return size;
+}
+
+//----------------------------------------------------------------------------
+// _open_mqueue
+//----------------------------------------------------------------------------
+static bool _open_mqueue()
+{
+    mq_attr attr;
+
+    // Open the GUI Message Queue for reading, creating it if needed with the same
+    // attributes as the UI app, so that either app can be started first
+    std::memset(&attr, 0, sizeof(attr));
+    attr.mq_maxmsg = GUI_MSG_MQUEUE_SIZE;
+    attr.mq_msgsize = sizeof(GuiMsg);
+    _mq_desc = ::mq_open(GUI_MSG_MQUEUE_NAME, (O_CREAT|O_RDONLY),
+                         (S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH),
+                         &attr);
+    return _mq_desc != (mqd_t)-1;
+}
+
+//----------------------------------------------------------------------------
+// _read_mqueue
+//----------------------------------------------------------------------------
+static bool _read_mqueue(GuiMsg& msg, uint64_t& seq, uint timeout_ms)
+{
+    timespec timeout;
+
+    // Read the next message from the GUI Message Queue, waiting up to the timeout
+    // for one to be available (a zero timeout does not wait)
+    ::clock_gettime(CLOCK_REALTIME, &timeout);
+    timeout.tv_sec += timeout_ms / 1000;
+    timeout.tv_nsec += (timeout_ms % 1000) * 1000000;
+    if (timeout.tv_nsec >= 1000000000) {
+        timeout.tv_sec++;
+        timeout.tv_nsec -= 1000000000;
+    }
+    if (::mq_timedreceive(_mq_desc, (char *)&msg, sizeof(msg), nullptr, &timeout) != sizeof(msg)) {
+        return false;
+    }
+
+    // The queue has no sequence numbers, so number the messages as they are read
+    // Note: The UI app does not drop a message if the queue is full, it sends it
+    // again later, so no gaps are reported for the queue
+    seq = _mq_seq++;
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// _print_report
+//----------------------------------------------------------------------------
+static void _print_report(const std::map<int, MsgTypeStats>& stats, std::chrono::duration<double> elapsed, uint64_t gaps, uint max_batch)
+{
+    uint64_t total = 0;
+
+    // Print the stats for each message type
+    std::printf("%-6s %9s %9s %10s %10s %12s %12s %12s\n",
+                "type", "count", "rate(/s)", "mean(B)", "max(B)", "mean_ia(us)", "min_ia(us)", "max_ia(us)");
+    for (const auto& [type, s] : stats) {
+        auto mean_interval = s.interval_count ? (s.interval_total.count() / s.interval_count) : 0;
+        std::printf("%-6d %9lu %9.1f %10lu %10u %12ld %12ld %12ld\n",
+                    type, s.count, s.count / elapsed.count(), s.payload_bytes / s.count, s.max_payload_bytes,
+                    mean_interval, s.interval_min.count(), s.interval_max.count());
+        total += s.count;
+    }
+    std::printf("total %lu messages in %.1fs (%.1f/s), %lu dropped, max %u messages per wakeup\n\n",
+                total, elapsed.count(), total / elapsed.count(), gaps, max_batch);
+}
+
+//----------------------------------------------------------------------------
+// main
+//----------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    uint duration_s = 0;
+    uint report_interval_s = DEFAULT_REPORT_INTERVAL_S;
+    uint slow_gui_us = 0;
+    bool use_mqueue = false;
+    int opt;
+
+    // Parse the command line options
+    while ((opt = getopt(argc, argv, "d:r:s:q")) != -1) {
+        switch (opt) {
+            case 'd':
+                duration_s = std::atoi(optarg);
+                break;
+
+            case 'r':
+                report_interval_s = std::max(1, std::atoi(optarg));
+                break;
+
+            case 's':
+                slow_gui_us = std::atoi(optarg);
+                break;
+
+            case 'q':
+                use_mqueue = true;
+                break;
+
+            default:
+                MSG("Usage: " << argv[0] << " [-d run seconds, 0 to run until stopped] [-r report seconds] [-s slow GUI delay per message us] [-q read the GUI Message Queue rather than the Ring]");
+                return 1;
+        }
+    }
+    ::signal(SIGINT, _signal_handler);
+    ::signal(SIGTERM, _signal_handler);
+
+    // Open the GUI Message Queue or Ring
+    if (use_mqueue) {
+        // Note: Reading the queue in place of the GUI app means the GUI app must not
+        // be running, otherwise the messages are split between the two readers
+        if (!_open_mqueue()) {
+            MSG("ERROR: Opening the GUI Message Queue: " << GUI_MSG_MQUEUE_NAME << ": " << errno);
+            return 1;
+        }
+        MSG("GUI Message Queue open: " << GUI_MSG_MQUEUE_NAME);
+    }
+    else {
+        // The UI app creates the ring, so wait until it is running
+        MSG("Waiting for the GUI Message Ring: " << GUI_MSG_RING_NAME);
+        while (!_ring.open()) {
+            if (!_running) {
+                return 0;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(RING_OPEN_RETRY_MS));
+        }
+        MSG("GUI Message Ring open");
+    }
+    auto read_msg = [use_mqueue](GuiMsg& msg, uint64_t& seq) {
+        return use_mqueue ? _read_mqueue(msg, seq, 0) : _ring.read(msg, seq);
+    };
+
+    // Read the GUI messages until stopped
+    std::map<int, MsgTypeStats> stats;
+    uint64_t next_seq = 0;
+    uint64_t gaps = 0;
+    uint max_batch = 0;
+    bool first_msg = true;
+    auto start_time = std::chrono::steady_clock::now();
+    auto report_time = start_time + std::chrono::seconds(report_interval_s);
+    while (_running) {
+        // Wait for messages, and read all messages available
+        GuiMsg msg;
+        uint64_t seq;
+        uint batch = 0;
+        bool msg_read = false;
+        if (use_mqueue) {
+            msg_read = _read_mqueue(msg, seq, RING_WAIT_TIMEOUT_MS);
+        }
+        else {
+            _ring.wait(RING_WAIT_TIMEOUT_MS);
+            msg_read = _ring.read(msg, seq);
+        }
+        while (msg_read) {
+            auto now = std::chrono::steady_clock::now();
+            batch++;
+
+            // Any gap in the sequence numbers is the number of messages dropped
+            if (!first_msg && (seq > next_seq)) {
+                gaps += seq - next_seq;
+            }
+            next_seq = seq + 1;
+            first_msg = false;
+
+            // Update the stats for this message type
+            auto itr = stats.find(static_cast<int>(msg.type));
+            if (itr == stats.end()) {
+                itr = stats.emplace(static_cast<int>(msg.type), MsgTypeStats()).first;
+                itr->second.interval_min = std::chrono::microseconds::max();
+            }
+            auto& s = itr->second;
+            uint bytes = _payload_bytes(msg);
+            if (s.count > 0) {
+                auto interval = std::chrono::duration_cast<std::chrono::microseconds>(now - s.last_time);
+                s.interval_count++;
+                s.interval_total += interval;
+                s.interval_min = std::min(s.interval_min, interval);
+                s.interval_max = std::max(s.interval_max, interval);
+            }
+            s.count++;
+            s.payload_bytes += bytes;
+            s.max_payload_bytes = std::max(s.max_payload_bytes, bytes);
+            s.last_time = now;
+
+            // Simulate a slow GUI if needed
+            if (slow_gui_us) {
+                std::this_thread::sleep_for(std::chrono::microseconds(slow_gui_us));
+            }
+            msg_read = read_msg(msg, seq);
+        }
+        max_batch = std::max(max_batch, batch);
+
+        // Print a report if it is time to, and check if the run has finished
+        auto now = std::chrono::steady_clock::now();
+        if (now >= report_time) {
+            _print_report(stats, now - start_time, gaps, max_batch);
+            report_time += std::chrono::seconds(report_interval_s);
+        }
+        if (duration_s && (now >= (start_time + std::chrono::seconds(duration_s)))) {
+            break;
+        }
+    }
+
+    // Print the final report
+    _print_report(stats, std::chrono::steady_clock::now() - start_time, gaps, max_batch);
+    if (use_mqueue) {
+        // Close the GUI Message Queue - don't unlink, this is done by the GUI app
+        ::mq_close(_mq_desc);
+    }
+    else {
+        _ring.close();
+    }
+    return 0;
+}
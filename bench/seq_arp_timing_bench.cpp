@@ -0,0 +1,469 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  seq_arp_timing_bench.cpp
+ * @brief Sequencer and Arpeggiator timing accuracy benchmark.
+ *
+ * Runs the tempo thread of the Sequencer (step mode) or Arpeggiator against a
+ * simulated clock source, capturing the time each note is sent. The clock
+ * source signals the tempo thread at the same rate as the MIDI Device Manager,
+ * and the tempo thread counts the pulses with the TempoPulseCounter used by the
+ * SeqManager and ArpManager, sending notes either immediately or via the
+ * NoteScheduler.
+ *-----------------------------------------------------------------------------
+ */
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "ui_common.h"
+#include "timer.h"
+#include "note_scheduler.h"
+#include "tempo_pulse_counter.h"
+
+// Clock Source
+enum class ClockSource
+{
+    INTERNAL,
+    MIDI_CLOCK_IN
+};
+
+// Tempo Thread
+enum class TempoThread
+{
+    SEQ,
+    ARP
+};
+
+// Load Scenario
+enum class LoadScenario
+{
+    NONE,
+    CPU,
+    PRESET_LOAD
+};
+
+// Benchmark Run
+struct BenchRun
+{
+    ClockSource clock_source;
+    TempoThread tempo_thread;
+    float tempo_bpm;
+    float end_tempo_bpm;
+    common::TempoNoteValue note_value;
+    LoadScenario load;
+    bool scheduled;
+    uint duration_s;
+};
+
+// Benchmark Result
+struct BenchResult
+{
+    uint notes;
+    double mean_us;
+    int64_t p99_us;
+    int64_t max_us;
+    double drift_us;
+    uint missed_pulses;
+};
+
+// Constants
+constexpr auto MIDI_CLOCK_IN_JITTER      = std::chrono::microseconds(250);
+constexpr auto PRESET_LOAD_INTERVAL      = std::chrono::milliseconds(500);
+constexpr auto PRESET_LOAD_DURATION      = std::chrono::milliseconds(20);
+constexpr uint DEFAULT_RUN_DURATION      = 2;
+constexpr uint DEFAULT_DRIFT_RUN_DURATION = 60;
+constexpr uint DRIFT_NOTES_PERCENT       = 10;
+
+// Tempo Engine class
+// Runs the tempo thread of the SeqManager and ArpManager
+class TempoEngine
+{
+public:
+    TempoEngine(uint tempo_pulse_count, bool scheduled) : _scheduled(scheduled)
+    {
+        _running = true;
+        _signalled = false;
+        _note_on = false;
+        _missed_pulses = 0;
+        _pulse_counter.set_tempo_pulse_count(tempo_pulse_count);
+        _sent_times.reserve(100000);
+        if (_scheduled) {
+            _note_scheduler.start([this](const snd_seq_event_t& event) { _capture_note(event); });
+        }
+        _thread = new std::thread(&TempoEngine::_process_tempo_event, this);
+    }
+
+    ~TempoEngine()
+    {
+        {
+            std::lock_guard<std::mutex> lk(_mutex);
+            _running = false;
+            _signalled = true;
+        }
+        _cv.notify_all();
+        _thread->join();
+        delete _thread;
+        _note_scheduler.stop();
+    }
+
+    std::mutex& mutex() { return _mutex; }
+    uint missed_pulses() const { return _missed_pulses; }
+    std::vector<std::chrono::steady_clock::time_point> sent_times()
+    {
+        std::lock_guard<std::mutex> lk(_sent_times_mutex);
+        return _sent_times;
+    }
+
+    // Signal a tempo pulse - as per utils::seq_signal() and utils::arp_signal()
+    void signal()
+    {
+        {
+            std::lock_guard<std::mutex> lk(_mutex);
+
+            // If the previous pulse has not been processed yet, it is lost
+            if (_signalled) {
+                _missed_pulses++;
+            }
+            _signalled = true;
+            _pulse_time = std::chrono::steady_clock::now();
+        }
+        _cv.notify_all();
+    }
+
+private:
+    const bool _scheduled;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    bool _running;
+    bool _signalled;
+    bool _note_on;
+    uint _missed_pulses;
+    TempoPulseCounter _pulse_counter;
+    std::chrono::steady_clock::time_point _pulse_time;
+    std::thread *_thread;
+    NoteScheduler _note_scheduler;
+    std::mutex _sent_times_mutex;
+    std::vector<std::chrono::steady_clock::time_point> _sent_times;
+
+    void _process_tempo_event()
+    {
+        while (true) {
+            // Wait for a tempo pulse - as per utils::seq_wait() and utils::arp_wait()
+            std::unique_lock<std::mutex> lk(_mutex);
+            _cv.wait(lk, [this]{return _signalled;});
+            _signalled = false;
+            if (!_running) {
+                break;
+            }
+
+            // Count the pulse, and once the note duration is reached send the next
+            // NOTE ON or NOTE OFF - as per the Sequencer step mode and Arpeggiator
+            if (_pulse_counter.pulse()) {
+                _note_on = !_note_on;
+                snd_seq_event_t note = {};
+                note.type = _note_on ? SND_SEQ_EVENT_NOTEON : SND_SEQ_EVENT_NOTEOFF;
+                note.data.note.note = 60;
+                note.data.note.velocity = _note_on ? 127 : 0;
+                if (!_scheduled || !_note_scheduler.schedule(note, _pulse_time + NOTE_SCHEDULER_LATENCY)) {
+                    _capture_note(note);
+                }
+                _pulse_counter.next_duration();
+            }
+        }
+    }
+
+    void _capture_note(const snd_seq_event_t& event)
+    {
+        // Capture the time each NOTE ON is sent
+        if (event.type == SND_SEQ_EVENT_NOTEON) {
+            std::lock_guard<std::mutex> lk(_sent_times_mutex);
+            _sent_times.push_back(std::chrono::steady_clock::now());
+        }
+    }
+};
+
+//----------------------------------------------------------------------------
+// _tempo_pulse_count
+//----------------------------------------------------------------------------
+static uint _tempo_pulse_count(const BenchRun& run)
+{
+    // Return the tempo note pulse count as set by the SeqManager and ArpManager -
+    // the Sequencer is signalled on every internal clock pulse, rather than each
+    // MIDI clock pulse
+    uint pulse_count = TempoPulseCounter::PulseCount(run.note_value);
+    if ((run.tempo_thread == TempoThread::SEQ) && (run.clock_source == ClockSource::INTERNAL)) {
+        pulse_count *= PPQN_CLOCK_PULSES_PER_MIDI_CLOCK;
+    }
+    return pulse_count;
+}
+
+//----------------------------------------------------------------------------
+// _signals_pulse
+//----------------------------------------------------------------------------
+static bool _signals_pulse(const BenchRun& run, uint pulse)
+{
+    // The internal clock only signals the Arpeggiator on every MIDI clock pulse,
+    // as per the MIDI Device Manager
+    return (run.tempo_thread == TempoThread::SEQ) || (run.clock_source == ClockSource::MIDI_CLOCK_IN) ||
+           (((pulse + 1) % PPQN_CLOCK_PULSES_PER_MIDI_CLOCK) == 0);
+}
+
+//----------------------------------------------------------------------------
+// _note_on_pulses
+//----------------------------------------------------------------------------
+static std::vector<uint> _note_on_pulses(const BenchRun& run, uint num_pulses)
+{
+    std::vector<uint> note_on_pulses;
+    TempoPulseCounter pulse_counter;
+    bool note_on = false;
+
+    // Count the clock pulses that signal the tempo thread, as it does, to get the
+    // clock pulse on which each NOTE ON is due if no pulses are lost
+    pulse_counter.set_tempo_pulse_count(_tempo_pulse_count(run));
+    for (uint pulse=0; pulse<num_pulses; pulse++) {
+        if (_signals_pulse(run, pulse) && pulse_counter.pulse()) {
+            note_on = !note_on;
+            if (note_on) {
+                note_on_pulses.push_back(pulse);
+            }
+            pulse_counter.next_duration();
+        }
+    }
+    return note_on_pulses;
+}
+
+//----------------------------------------------------------------------------
+// _note_value_name
+//----------------------------------------------------------------------------
+static const char *_note_value_name(common::TempoNoteValue note_value)
+{
+    switch (note_value) {
+        case common::TempoNoteValue::EIGHTH:
+            return "1/8";
+        case common::TempoNoteValue::SIXTEENTH:
+            return "1/16";
+        case common::TempoNoteValue::THIRTYSECOND:
+            return "1/32";
+        case common::TempoNoteValue::QUARTER_TRIPLETS:
+            return "1/4T";
+        case common::TempoNoteValue::EIGHTH_TRIPLETS:
+            return "1/8T";
+        case common::TempoNoteValue::SIXTEENTH_TRIPLETS:
+            return "1/16T";
+        case common::TempoNoteValue::THIRTYSECOND_TRIPLETS:
+            return "1/32T";
+        case common::TempoNoteValue::QUARTER:
+        default:
+            return "1/4";
+    }
+}
+
+//----------------------------------------------------------------------------
+// _run_bench
+//----------------------------------------------------------------------------
+static BenchResult _run_bench(const BenchRun& run)
+{
+    uint ppqn = (run.clock_source == ClockSource::INTERNAL) ? PPQN : NUM_MIDI_CLOCK_PULSES_PER_QTR_NOTE_BEAT;
+    auto engine = new TempoEngine(_tempo_pulse_count(run), run.scheduled);
+    std::atomic<bool> running = true;
+    std::vector<std::thread> load_threads;
+
+    // Start the load threads
+    if (run.load == LoadScenario::CPU) {
+        // Keep every core busy
+        for (uint i=0; i<std::thread::hardware_concurrency(); i++) {
+            load_threads.emplace_back([&running]() {
+                volatile uint64_t count = 0;
+                while (running) {
+                    count = count + 1;
+                }
+            });
+        }
+    }
+    else if (run.load == LoadScenario::PRESET_LOAD) {
+        // Periodically hold the tempo mutex, as happens when presets are processed
+        load_threads.emplace_back([&running, engine]() {
+            while (running) {
+                std::this_thread::sleep_for(PRESET_LOAD_INTERVAL);
+                std::lock_guard<std::mutex> lk(engine->mutex());
+                std::vector<std::string> strings;
+                auto end = std::chrono::steady_clock::now() + PRESET_LOAD_DURATION;
+                while (std::chrono::steady_clock::now() < end) {
+                    strings.emplace_back(std::to_string(strings.size()));
+                }
+            }
+        });
+    }
+
+    // Calculate the ideal time of each clock pulse, changing the tempo linearly over
+    // the run
+    std::vector<std::chrono::steady_clock::time_point> pulse_times;
+    std::vector<int> pulse_intervals_us;
+    auto start = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+    auto time = start;
+    while (time < (start + std::chrono::seconds(run.duration_s))) {
+        float progress = std::chrono::duration<float>(time - start).count() / run.duration_s;
+        float tempo_bpm = run.tempo_bpm + ((run.end_tempo_bpm - run.tempo_bpm) * progress);
+        int interval_us = US_PER_MINUTE / (tempo_bpm * ppqn);
+        time += std::chrono::microseconds(interval_us);
+        pulse_times.push_back(time);
+        pulse_intervals_us.push_back(interval_us);
+    }
+
+    // Run the clock source
+    if (run.clock_source == ClockSource::INTERNAL) {
+        // Use a periodic timer, as per the MIDI Device Manager
+        uint pulse = 0;
+        Timer timer(TimerType::PERIODIC);
+        std::this_thread::sleep_until(start);
+        timer.start(pulse_intervals_us[0], [&]() {
+            if (_signals_pulse(run, pulse)) {
+                engine->signal();
+            }
+            if (++pulse < pulse_intervals_us.size()) {
+                timer.change_interval(pulse_intervals_us[pulse]);
+            }
+        });
+        std::this_thread::sleep_until(pulse_times.back());
+        timer.stop();
+    }
+    else {
+        // MIDI clock in - each pulse is received at its ideal time plus some
+        // random jitter
+        std::mt19937 gen(0);
+        std::uniform_int_distribution<int> jitter(0, MIDI_CLOCK_IN_JITTER.count());
+        for (auto t : pulse_times) {
+            std::this_thread::sleep_until(t + std::chrono::microseconds(jitter(gen)));
+            engine->signal();
+        }
+    }
+
+    // Wait for any scheduled notes, then stop the load threads and engine
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    running = false;
+    for (auto& t : load_threads) {
+        t.join();
+    }
+    auto sent_times = engine->sent_times();
+    uint missed_pulses = engine->missed_pulses();
+    delete engine;
+
+    // Calculate the timing error of each note, relative to the ideal time of the
+    // clock pulse it is due on
+    // Note: A lost pulse delays every following note, and this is included in the
+    // error
+    BenchResult result = {};
+    std::vector<int64_t> errors;
+    auto note_on_pulses = _note_on_pulses(run, pulse_times.size());
+    auto latency = run.scheduled ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(NOTE_SCHEDULER_LATENCY) : std::chrono::steady_clock::duration(0);
+    for (uint i=0; i<std::min(sent_times.size(), note_on_pulses.size()); i++) {
+        auto expected = pulse_times[note_on_pulses[i]] + latency;
+        errors.push_back(std::chrono::duration_cast<std::chrono::microseconds>(sent_times[i] - expected).count());
+    }
+    result.notes = errors.size();
+    result.missed_pulses = missed_pulses;
+    if (errors.size()) {
+        // Drift is the change in the mean error between the start and end of the run
+        uint n = std::max(1U, (uint)((errors.size() * DRIFT_NOTES_PERCENT) / 100));
+        double start_error = 0;
+        double end_error = 0;
+        for (uint i=0; i<n; i++) {
+            start_error += errors[i];
+            end_error += errors[errors.size() - 1 - i];
+        }
+        result.drift_us = (end_error - start_error) / n;
+        for (auto e : errors) {
+            result.mean_us += std::abs(e);
+        }
+        result.mean_us /= errors.size();
+        std::vector<int64_t> abs_errors;
+        for (auto e : errors) {
+            abs_errors.push_back(std::abs(e));
+        }
+        std::sort(abs_errors.begin(), abs_errors.end());
+        result.p99_us = abs_errors[(abs_errors.size() * 99) / 100];
+        result.max_us = abs_errors.back();
+    }
+    return result;
+}
+
+//----------------------------------------------------------------------------
+// _print_result
+//----------------------------------------------------------------------------
+static void _print_result(const BenchRun& run, const BenchResult& result)
+{
+    const char *load = run.load == LoadScenario::CPU ? "cpu" : (run.load == LoadScenario::PRESET_LOAD ? "preset" : "none");
+    std::printf("%-8s %-6s %5.0f-%-5.0f %-6s %-7s %-6s %7u %10.1f %9ld %9ld %10.1f %7u\n",
+                (run.clock_source == ClockSource::INTERNAL ? "internal" : "midi_in"),
+                (run.tempo_thread == TempoThread::SEQ ? "seq" : "arp"), run.tempo_bpm, run.end_tempo_bpm, _note_value_name(run.note_value), load,
+                (run.scheduled ? "sched" : "direct"), result.notes, result.mean_us, (long)result.p99_us,
+                (long)result.max_us, result.drift_us, result.missed_pulses);
+    std::fflush(stdout);
+}
+
+//----------------------------------------------------------------------------
+// main
+//----------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    uint duration_s = DEFAULT_RUN_DURATION;
+    uint drift_duration_s = DEFAULT_DRIFT_RUN_DURATION;
+    int opt;
+
+    // Parse the command line options
+    while ((opt = getopt(argc, argv, "d:l:")) != -1) {
+        switch (opt) {
+            case 'd':
+                duration_s = std::max(1, std::atoi(optarg));
+                break;
+
+            case 'l':
+                drift_duration_s = std::atoi(optarg);
+                break;
+
+            default:
+                MSG("Usage: " << argv[0] << " [-d run seconds] [-l drift run seconds, 0 to skip]");
+                return 1;
+        }
+    }
+    std::printf("%-8s %-6s %-11s %-6s %-7s %-6s %7s %10s %9s %9s %10s %7s\n",
+                "clock", "thread", "tempo", "value", "load", "mode", "notes", "mean(us)", "p99(us)", "max(us)", "drift(us)", "missed");
+
+    // Sweep the clock sources, tempo threads, tempos, note values and load scenarios,
+    // sending the notes both directly and scheduled
+    for (auto clock_source : {ClockSource::INTERNAL, ClockSource::MIDI_CLOCK_IN}) {
+        for (auto tempo_thread : {TempoThread::SEQ, TempoThread::ARP}) {
+            for (auto tempo : {60.0f, 120.0f, 240.0f}) {
+                for (auto note_value : {common::TempoNoteValue::QUARTER, common::TempoNoteValue::SIXTEENTH, common::TempoNoteValue::QUARTER_TRIPLETS, common::TempoNoteValue::EIGHTH_TRIPLETS}) {
+                    for (auto load : {LoadScenario::NONE, LoadScenario::CPU, LoadScenario::PRESET_LOAD}) {
+                        for (bool scheduled : {false, true}) {
+                            BenchRun run = {clock_source, tempo_thread, tempo, tempo, note_value, load, scheduled, duration_s};
+                            _print_result(run, _run_bench(run));
+                        }
+                    }
+                }
+            }
+
+            // Tempo changes
+            for (bool scheduled : {false, true}) {
+                BenchRun run = {clock_source, tempo_thread, 80.0f, 200.0f, common::TempoNoteValue::SIXTEENTH, LoadScenario::NONE, scheduled, duration_s};
+                _print_result(run, _run_bench(run));
+            }
+        }
+    }
+
+    // Long runs to measure drift
+    if (drift_duration_s) {
+        for (auto clock_source : {ClockSource::INTERNAL, ClockSource::MIDI_CLOCK_IN}) {
+            for (bool scheduled : {false, true}) {
+                BenchRun run = {clock_source, TempoThread::ARP, 120.0f, 120.0f, common::TempoNoteValue::SIXTEENTH, LoadScenario::NONE, scheduled, drift_duration_s};
+                _print_result(run, _run_bench(run));
+            }
+        }
+    }
+    return 0;
+}
@@ -7,6 +7,7 @@
  *-----------------------------------------------------------------------------
  */
 
+#include <array>
 #include "data_conversion.h"
 #include "monique_synth_parameters.h"
 #include "arp_manager.h"
@@ -17,114 +18,139 @@ namespace dataconv
 {
     constexpr float LOG2_20 = std::log2f(20);
     constexpr float LOG2_12 = std::log2f(12);
+    constexpr float MIDI_7BIT_RANGE = MIDI_CC_MAX_VALUE - MIDI_CC_MIN_VALUE;
+    constexpr float MIDI_PITCH_BEND_SCALE = 1.0f / (MIDI_PITCH_BEND_MAX_VALUE - MIDI_PITCH_BEND_MIN_VALUE);
+    constexpr uint NUM_MODULES = static_cast<uint>(MoniqueModule::SOFTWARE) + 1;
+
+    // Conversion Type
+    enum class ConversionType
+    {
+        NONE,
+        LINEAR,
+        TEMPO
+    };
+
+    // Param Conversion
+    // A LINEAR conversion clamps the value to the min/max, and then converts it
+    // with a multiply-add:
+    // normalised = (value * to_scale) + to_offset
+    // value = (normalised * from_scale) + from_offset
+    struct ParamConversion
+    {
+        ConversionType type;
+        float min;
+        float max;
+        float to_scale;
+        float to_offset;
+        float from_scale;
+        float from_offset;
+    };
+
+    // Module Conversions
+    // The conversion table for a module, indexed by param ID
+    struct ModuleConversions
+    {
+        const ParamConversion *conversions;
+        uint num_conversions;
+    };
+
+    // Linear conversion, specified by the FROM normalised float scale and offset
+    constexpr ParamConversion linear(float min, float max, float from_scale, float from_offset = 0.0f) {
+        return {ConversionType::LINEAR, min, max, (1.0f / from_scale), -(from_offset / from_scale), from_scale, from_offset};
+    }
 
-    // Convert TO a normalised float
-    float to_normalised_float(MoniqueModule module, int param_id, float value) {
-        // Conversion based on the module
-        switch (module) {
-            case MoniqueModule::DAW:
-                // Call the MONIQUE synth params conversion function
-                return Monique::to_normalised_float(param_id, value);
-
-            case MoniqueModule::SYSTEM: {
-                switch (param_id) {
-                    case SystemParamId::TEMPO_BPM_PARAM_ID: {
-                        // Convert the tempo to normalised float
-                        auto tempo = std::clamp(value, common::MIN_TEMPO_BPM, common::MAX_TEMPO_BPM);
-                        return -0.1059 + (0.005330 * tempo) - (0.00000167 * tempo * tempo) - (0.00000000557 * tempo * tempo * tempo);
-                    }
-
-                    case SystemParamId::SEQ_ARP_MIDI_CHANNEL_PARAM_ID:
-                    case SystemParamId::KBD_MIDI_CHANNEL_PARAM_ID: {
-                        // Convert the MIDI channel to normalised float
-                        auto val = std::clamp(value, 0.0f, 16.0f);
-                        return val / 17;
-                    }
-
-                    case SystemParamId::SUSTAIN_POLARITY_PARAM_ID: {
-                        // Convert the Sustain Polarity to a normalised float
-                        auto val = std::clamp(value, static_cast<float>(SustainPolarity::POSITIVE), static_cast<float>(SustainPolarity::NEGATIVE));
-                        return val / SustainPolarity::NUM_SUSTAIN_POLARITIES;
-                    }
-
-                    case SystemParamId::MIDI_ECHO_FILTER_PARAM_ID: {
-                        // Convert the MIDI echo filter to a normalised float
-                        auto val = std::clamp(value, static_cast<float>(MidiEchoFilter::NO_FILTER), static_cast<float>(MidiEchoFilter::FILTER_ALL));
-                        return val / MidiEchoFilter::NUM_ECHO_FILTERS;                        
-                    }
-
-                    case SystemParamId::AT_SENSITIVITY_PARAM_ID: {
-                        // Convert the AT Sensitivity to a normalised float
-                        auto val = std::clamp(value, 0.0f, 15.0f);
-                        return val / 16.0f;
-                    }
-
-                    default:
-                        break;
-                }
-                break;
-            }
-
-            case MoniqueModule::SEQ: {
-                switch(param_id) {
-                    case SeqParamId::MODE_PARAM_ID: {
-                        // Convert the SEQ mode to a normalised float
-                        auto val = std::clamp(value, static_cast<float>(SeqMode::STEP), static_cast<float>(SeqMode::PHRASE_LOOPER));
-                        return val / (float)SeqMode::NUM_MODES;                        
-                    }
-            
-                    case SeqParamId::NUM_STEPS_PARAM_ID: {
-                        // Convert the SEQ number of steps to a normalised float
-                        auto val = std::clamp(value, 1.0f, (float)STEP_SEQ_MAX_STEPS);
-                        return (val - 1.0f) / STEP_SEQ_MAX_STEPS;                        
-                    }
-
-                    case SeqParamId::TEMPO_NOTE_VALUE_PARAM_ID: {
-                        // Convert the Tempo Note value to a normalised float
-                        auto val = std::clamp(value, static_cast<float>(common::TempoNoteValue::QUARTER), static_cast<float>(common::TempoNoteValue::THIRTYSECOND_TRIPLETS));
-                        return val / common::TempoNoteValue::NUM_TEMPO_NOTE_VALUES;
-                    }
-
-                    case SeqParamId::PHRASE_QUANTISATION_PARAM_ID: {
-                        // Convert the Phrase Quantisation value to a normalised float
-                        auto val = std::clamp(value, static_cast<float>(PhraseQuantisation::NONE), static_cast<float>(PhraseQuantisation::THIRTYSECOND_TRIPLETS));
-                        return val / PhraseQuantisation::NUM_PHRASE_QUANTISATION_VALUES;
-                    }
-
-                    case SeqParamId::PHRASE_BEATS_PER_BAR_PARAM_ID: {
-                        // Convert the Phrase Beats per Bar to a normalised float
-                        auto val = std::clamp(value, static_cast<float>(PhraseBeatsPerBar::NONE), static_cast<float>(PhraseBeatsPerBar::FIVE));
-                        return val / (float)PhraseBeatsPerBar::NUM_BEATS_PER_BAR_VALUES;                         
-                    }
-
-                    default:
-                        break;
-                }
-                break;
-            }
+    // System param conversions
+    constexpr auto SYSTEM_PARAM_CONVERSIONS = [] {
+        std::array<ParamConversion, SystemParamId::AT_SENSITIVITY_PARAM_ID + 1> c = {};
+        c[SystemParamId::TEMPO_BPM_PARAM_ID] = {ConversionType::TEMPO, common::MIN_TEMPO_BPM, common::MAX_TEMPO_BPM, 0.0f, 0.0f, 0.0f, 0.0f};
+        c[SystemParamId::SEQ_ARP_MIDI_CHANNEL_PARAM_ID] = linear(0.0f, 16.0f, 17.0f);
+        c[SystemParamId::KBD_MIDI_CHANNEL_PARAM_ID] = linear(0.0f, 16.0f, 17.0f);
+        c[SystemParamId::SUSTAIN_POLARITY_PARAM_ID] = linear(SustainPolarity::POSITIVE, SustainPolarity::NEGATIVE, SustainPolarity::NUM_SUSTAIN_POLARITIES);
+        c[SystemParamId::MIDI_ECHO_FILTER_PARAM_ID] = linear(MidiEchoFilter::NO_FILTER, MidiEchoFilter::FILTER_ALL, MidiEchoFilter::NUM_ECHO_FILTERS);
+        c[SystemParamId::AT_SENSITIVITY_PARAM_ID] = linear(0.0f, 15.0f, 16.0f);
+        return c;
+    }();
+
+    // SEQ param conversions
+    constexpr auto SEQ_PARAM_CONVERSIONS = [] {
+        std::array<ParamConversion, SeqParamId::CHUNK_PARAM_ID + 1> c = {};
+        c[SeqParamId::MODE_PARAM_ID] = linear(static_cast<float>(SeqMode::STEP), static_cast<float>(SeqMode::PHRASE_LOOPER), static_cast<float>(SeqMode::NUM_MODES));
+        c[SeqParamId::NUM_STEPS_PARAM_ID] = linear(1.0f, STEP_SEQ_MAX_STEPS, STEP_SEQ_MAX_STEPS, 1.0f);
+        c[SeqParamId::TEMPO_NOTE_VALUE_PARAM_ID] = linear(common::TempoNoteValue::QUARTER, common::TempoNoteValue::THIRTYSECOND_TRIPLETS, common::TempoNoteValue::NUM_TEMPO_NOTE_VALUES);
+        c[SeqParamId::PHRASE_QUANTISATION_PARAM_ID] = linear(PhraseQuantisation::NONE, PhraseQuantisation::THIRTYSECOND_TRIPLETS, PhraseQuantisation::NUM_PHRASE_QUANTISATION_VALUES);
+        c[SeqParamId::PHRASE_BEATS_PER_BAR_PARAM_ID] = linear(static_cast<float>(PhraseBeatsPerBar::NONE), static_cast<float>(PhraseBeatsPerBar::FIVE), static_cast<float>(PhraseBeatsPerBar::NUM_BEATS_PER_BAR_VALUES));
+        return c;
+    }();
+
+    // ARP param conversions
+    constexpr auto ARP_PARAM_CONVERSIONS = [] {
+        std::array<ParamConversion, ArpParamId::ARP_RUN_PARAM_ID + 1> c = {};
+        c[ArpParamId::ARP_DIR_MODE_PARAM_ID] = linear(ArpDirMode::UP, ArpDirMode::ASSIGNED, ArpDirMode::NUM_DIR_MODES);
+        c[ArpParamId::ARP_TEMPO_NOTE_VALUE_PARAM_ID] = linear(common::TempoNoteValue::QUARTER, common::TempoNoteValue::THIRTYSECOND_TRIPLETS, common::TempoNoteValue::NUM_TEMPO_NOTE_VALUES);
+        return c;
+    }();
+
+    // Module conversions, indexed by module
+    // Note: The DAW params are converted by the MONIQUE synth params conversion
+    // functions
+    constexpr auto MODULE_CONVERSIONS = [] {
+        std::array<ModuleConversions, NUM_MODULES> c = {};
+        c[static_cast<uint>(MoniqueModule::SYSTEM)] = {SYSTEM_PARAM_CONVERSIONS.data(), SYSTEM_PARAM_CONVERSIONS.size()};
+        c[static_cast<uint>(MoniqueModule::SEQ)] = {SEQ_PARAM_CONVERSIONS.data(), SEQ_PARAM_CONVERSIONS.size()};
+        c[static_cast<uint>(MoniqueModule::ARP)] = {ARP_PARAM_CONVERSIONS.data(), ARP_PARAM_CONVERSIONS.size()};
+        return c;
+    }();
+
+    // MIDI 7-bit value (CC and Aftertouch) to normalised float lookup table
+    constexpr auto MIDI_7BIT_TO_NORMALISED = [] {
+        std::array<float, MIDI_CC_MAX_VALUE + 1> t = {};
+        for (uint i=MIDI_CC_MIN_VALUE; i<=MIDI_CC_MAX_VALUE; i++) {
+            t[i] = (i - MIDI_CC_MIN_VALUE) / MIDI_7BIT_RANGE;
+        }
+        return t;
+    }();
+    static_assert((MIDI_CHANPRESS_MIN_VALUE == MIDI_CC_MIN_VALUE) && (MIDI_CHANPRESS_MAX_VALUE == MIDI_CC_MAX_VALUE));
+
+    // Get the conversion for a param, or nullptr if it has none
+    // Note: NUM_MODULES assumes SOFTWARE is the last module, so the module is range
+    // checked in case a module is added after it
+    inline const ParamConversion *get_conversion(MoniqueModule module, int param_id) {
+        if (static_cast<uint>(module) >= NUM_MODULES) {
+            return nullptr;
+        }
+        auto& mc = MODULE_CONVERSIONS[static_cast<uint>(module)];
+        if ((param_id >= 0) && (static_cast<uint>(param_id) < mc.num_conversions)) {
+            auto c = &mc.conversions[param_id];
+            return (c->type != ConversionType::NONE) ? c : nullptr;
+        }
+        return nullptr;
+    }
 
-            case MoniqueModule::ARP: {
-                switch(param_id) {
-                    case ArpParamId::ARP_DIR_MODE_PARAM_ID: {
-                        // Convert the DIR mode to a normalised float
-                        auto val = std::clamp(value, static_cast<float>(ArpDirMode::UP), static_cast<float>(ArpDirMode::ASSIGNED));
-                        return val / ArpDirMode::NUM_DIR_MODES;
-                    }
+    // Convert a 7-bit MIDI value to a normalised float
+    inline float midi_7bit_to_normalised_float(float value) {
+        auto val = std::clamp(value, (float)MIDI_CC_MIN_VALUE, (float)MIDI_CC_MAX_VALUE);
+        auto index = static_cast<uint>(val);
+        return (index == val) ? MIDI_7BIT_TO_NORMALISED[index] : ((val - MIDI_CC_MIN_VALUE) / MIDI_7BIT_RANGE);
+    }
 
-                    case ArpParamId::ARP_TEMPO_NOTE_VALUE_PARAM_ID: {
-                        // Convert the Tempo Note value to a normalised float
-                        auto val = std::clamp(value, static_cast<float>(common::TempoNoteValue::QUARTER), static_cast<float>(common::TempoNoteValue::THIRTYSECOND_TRIPLETS));
-                        return val / common::TempoNoteValue::NUM_TEMPO_NOTE_VALUES;
-                    }                    
+    // Convert TO a normalised float
+    float to_normalised_float(MoniqueModule module, int param_id, float value) {
+        // Call the MONIQUE synth params conversion function for DAW params
+        if (module == MoniqueModule::DAW) {
+            return Monique::to_normalised_float(param_id, value);
+        }
 
-                    default:
-                        break;
-                }
-                break;
+        // Get the conversion for this param - if it has none the value is already
+        // normalised
+        auto c = get_conversion(module, param_id);
+        if (c) {
+            auto val = std::clamp(value, c->min, c->max);
+            if (c->type == ConversionType::LINEAR) {
+                return (val * c->to_scale) + c->to_offset;
             }
 
-            default:
-                break;
+            // Convert the tempo to normalised float
+            return -0.1059f + (val * (0.005330f + (val * (-0.00000167f + (val * -0.00000000557f)))));
         }
         return value;
     }
@@ -132,127 +158,44 @@ namespace dataconv
     // Special cases - Pitch Bend, Aftertouch, and MIDI CC
     float pitch_bend_to_normalised_float(float value) {
         auto val = std::clamp(value, (float)MIDI_PITCH_BEND_MIN_VALUE, (float)MIDI_PITCH_BEND_MAX_VALUE);
-        return (val - MIDI_PITCH_BEND_MIN_VALUE) / (MIDI_PITCH_BEND_MAX_VALUE - MIDI_PITCH_BEND_MIN_VALUE);        
+        return (val - MIDI_PITCH_BEND_MIN_VALUE) * MIDI_PITCH_BEND_SCALE;
     }
 
     float aftertouch_to_normalised_float(float value) {
         // Note: Chanpress == Aftertouch
-        auto val = std::clamp(value, (float)MIDI_CHANPRESS_MIN_VALUE, (float)MIDI_CHANPRESS_MAX_VALUE);
-        return (val - MIDI_CHANPRESS_MIN_VALUE) / (MIDI_CHANPRESS_MAX_VALUE - MIDI_CHANPRESS_MIN_VALUE);        
+        return midi_7bit_to_normalised_float(value);
     }    
 
     float midi_cc_to_normalised_float(float value) {
-        auto val = std::clamp(value, (float)MIDI_CC_MIN_VALUE, (float)MIDI_CC_MAX_VALUE);
-        return (val - MIDI_CC_MIN_VALUE) / (MIDI_CC_MAX_VALUE - MIDI_CC_MIN_VALUE);       
+        return midi_7bit_to_normalised_float(value);
     }
 
     // Convert FROM a normalised float
     float from_normalised_float(MoniqueModule module, int param_id, float value) {
         // Clamp the passed normalised float to min/max
         value = std::clamp(value, 0.0f, 1.0f);
-   
-        // Conversion based on the module
-        switch (module) {
-            case MoniqueModule::DAW:
-                // Call the MONIQUE synth params conversion function
-                return Monique::from_normalised_float(param_id, value);
-
-            case MoniqueModule::SYSTEM: {
-                switch (param_id) {
-                    case SystemParamId::TEMPO_BPM_PARAM_ID: {
-                        // Convert the normalised float to a value between the min and max bpm
-                        // Quantise the value to 0.1 if less than 100 BPM, and 0.5 if above
-                        auto val = std::pow(1.9, 3 + (3.106 * value)) + (176.5 * value) + 13.16;
-                        return val >= 100.0f ?
-                            std::round(val * 2.0f) / 2.0f :
-                            std::round(val * 10.0f) / 10.0f;
-                    }
-
-                    case SystemParamId::SEQ_ARP_MIDI_CHANNEL_PARAM_ID:
-                    case SystemParamId::KBD_MIDI_CHANNEL_PARAM_ID: {
-                        // Convert the normalised float to a MIDI channel value
-                        auto val = value * 17;
-                        return std::clamp(val, 0.0f, 16.0f); 
-                    }
-
-                    case SystemParamId::SUSTAIN_POLARITY_PARAM_ID: {
-                        // Convert the normalised float to a Sustain Polarity
-                        auto val = value * SustainPolarity::NUM_SUSTAIN_POLARITIES;
-                        return std::clamp(val, static_cast<float>(SustainPolarity::POSITIVE), static_cast<float>(SustainPolarity::NEGATIVE));                   
-                    }
-
-                    case SystemParamId::MIDI_ECHO_FILTER_PARAM_ID: {
-                        // Convert the normalised float to a MIDI Echo Filter value
-                        auto val = value * MidiEchoFilter::NUM_ECHO_FILTERS;
-                        return std::clamp(val, static_cast<float>(MidiEchoFilter::NO_FILTER), static_cast<float>(MidiEchoFilter::FILTER_ALL));                   
-                    }
 
-                    case SystemParamId::AT_SENSITIVITY_PARAM_ID: {
-                        // Convert the normalised float to an AT Sensitivity value
-                        auto val = value * 16.0f;
-                        return std::clamp(val, 0.0f, 15.0f);                   
-                    }
-
-                    default:
-                        break;
-                }
-                break;
-            }
-
-            case MoniqueModule::SEQ: {
-                switch (param_id) {
-                    case SeqParamId::MODE_PARAM_ID: {
-                        // Convert the normalised float to a Seq mode
-                        auto val = value * (float)SeqMode::NUM_MODES;
-                        return std::clamp(val, static_cast<float>(SeqMode::STEP), static_cast<float>(SeqMode::PHRASE_LOOPER));                   
-                    }
-
-                    case SeqParamId::NUM_STEPS_PARAM_ID: {
-                        // Convert the normalised float to Sequencer number of steps
-                        auto val = value * STEP_SEQ_MAX_STEPS + 1.0f;
-                        return std::clamp(val, 1.0f, (float)STEP_SEQ_MAX_STEPS);                   
-                    }
-
-                    case SeqParamId::TEMPO_NOTE_VALUE_PARAM_ID: {
-                        // Convert the normalised float to a Tempo note value
-                        auto val = value * common::TempoNoteValue::NUM_TEMPO_NOTE_VALUES;
-                        return std::clamp(val, static_cast<float>(common::TempoNoteValue::QUARTER), static_cast<float>(common::TempoNoteValue::THIRTYSECOND_TRIPLETS));                   
-                    }
-
-                    case SeqParamId::PHRASE_QUANTISATION_PARAM_ID: {
-                        // Convert the normalised float to a Phrase Quantiastion value
-                        auto val = value * PhraseQuantisation::NUM_PHRASE_QUANTISATION_VALUES;
-                        return std::clamp(val, static_cast<float>(PhraseQuantisation::NONE), static_cast<float>(PhraseQuantisation::THIRTYSECOND_TRIPLETS));                   
-                    }
+        // Call the MONIQUE synth params conversion function for DAW params
+        if (module == MoniqueModule::DAW) {
+            return Monique::from_normalised_float(param_id, value);
+        }
 
-                    case SeqParamId::PHRASE_BEATS_PER_BAR_PARAM_ID: {
-                        // Convert the normalised float to a Phrase Beats per Bar value
-                        auto val = value * (float)PhraseBeatsPerBar::NUM_BEATS_PER_BAR_VALUES;
-                        return std::clamp(val, static_cast<float>(PhraseBeatsPerBar::NONE), static_cast<float>(PhraseBeatsPerBar::FIVE));                         
-                    }                                  
-                }
-                break;
+        // Get the conversion for this param - if it has none the value is returned
+        // as is
+        auto c = get_conversion(module, param_id);
+        if (c) {
+            if (c->type == ConversionType::LINEAR) {
+                return std::clamp((value * c->from_scale) + c->from_offset, c->min, c->max);
             }
 
-            case MoniqueModule::ARP: {
-                switch (param_id) {
-                    case ArpParamId::ARP_DIR_MODE_PARAM_ID: {
-                        // Convert the normalised float to a DIR mode
-                        auto val = value * ArpDirMode::NUM_DIR_MODES;
-                        return std::clamp(val, static_cast<float>(ArpDirMode::UP), static_cast<float>(ArpDirMode::ASSIGNED));                   
-                    }
-
-                    case ArpParamId::ARP_TEMPO_NOTE_VALUE_PARAM_ID: {
-                        // Convert the normalised float to a Tempo note value
-                        auto val = value * common::TempoNoteValue::NUM_TEMPO_NOTE_VALUES;
-                        return std::clamp(val, static_cast<float>(common::TempoNoteValue::QUARTER), static_cast<float>(common::TempoNoteValue::THIRTYSECOND_TRIPLETS));                   
-                    }                    
-                }
-                break;
-            }
-        
-            default:
-                break;
+            // Convert the normalised float to a value between the min and max bpm
+            // Quantise the value to 0.1 if less than 100 BPM, and 0.5 if above
+            // Note: Calculated in double precision, as single precision can round the
+            // quantised value differently
+            auto val = std::pow(1.9, 3 + (3.106 * value)) + (176.5 * value) + 13.16;
+            return val >= 100.0f ?
+                std::round(val * 2.0f) / 2.0f :
+                std::round(val * 10.0f) / 10.0f;
         }
         return value; 
     }
@@ -8,6 +8,13 @@
  */
 #include <iostream>
 #include <fstream>
+#include <atomic>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <condition_variable>
+#include <cstring>
+#include <thread>
 #include <linux/i2c.h>
 #include <linux/i2c-dev.h>
 #include <sys/ioctl.h>
@@ -17,6 +24,7 @@ extern "C" {
 }
 #include "ui_common.h"
 #include "logger.h"
+#include "thread_config.h"
 #include "ain.h"
 
 // ADCs I2C bus
@@ -47,11 +55,14 @@ constexpr uint8_t RIGHT_ADC_INPUT_SELECTION_FOR_RIGHT_PGA_2_REG = 57;
 constexpr uint8_t LEFT_ANALOG_PGA_SETTINGS_REG                  = 59;
 constexpr uint8_t RIGHT_ANALOG_PGA_SETTINGS_REG                 = 60;
 constexpr char VC_CMD_READ_AIN0_FORMAT[]                        = "pmicrd 1d";
-constexpr char VC_RESP_READ_AIN0_FORMAT[]                       = "[1d] = %x";
+constexpr char VC_RESP_READ_AIN0_FORMAT[]                       = "[1d] = ";
 constexpr char VC_CMD_READ_AIN1_FORMAT_CM4_REV0[]               = "pmicrd 1c";
-constexpr char VC_RESP_READ_AIN1_FORMAT_CM4_REV0[]              = "[1c] = %x";
+constexpr char VC_RESP_READ_AIN1_FORMAT_CM4_REV0[]              = "[1c] = ";
 constexpr char VC_CMD_READ_AIN1_FORMAT_CM4_REV1_PLUS[]          = "pmicrd 12";
-constexpr char VC_RESP_READ_AIN1_FORMAT_CM4_REV1_PLUS[]         = "[12] = %x";
+constexpr char VC_RESP_READ_AIN1_FORMAT_CM4_REV1_PLUS[]         = "[12] = ";
+// Note: Each sample is a VideoCore mailbox (gencmd) call, so the sample period is
+// kept at the previous 30ms analog pedal poll time to not add mailbox traffic
+constexpr auto AIN_SAMPLE_PERIOD                                = std::chrono::milliseconds(30);
 constexpr float AIN1_SCALING_FACTOR_CM4_REV0                    = (255.0f / 254.0);
 constexpr float AIN1_SCALING_FACTOR_CM4_REV1_PLUS               = (255.0f / 124.0);
 
@@ -66,8 +77,18 @@ bool _ain_init = false;
 const char *_vc_cmd_read_ain1_format;
 const char *_vc_resp_read_ain1_format;
 float (*_normalise_ain1_value)(int val);
+char _vc_resp_buffer[GENCMDSERVICE_MSGFIFO_SIZE];
+std::thread *_sampler_thread = nullptr;
+std::atomic<bool> _run_sampler = false;
+std::atomic<uint64_t> _ain1_sample = 0;
+std::mutex _sample_mutex;
+std::condition_variable _sample_cv;
 
 // Private functions
+bool _read_pmic_reg(const char *cmd, const char *resp_prefix, int& value);
+void _process_sampler();
+void _store_sample(std::atomic<uint64_t>& sample, float normalised_value);
+bool _load_sample(const std::atomic<uint64_t>& sample, ain::AinSample& ain_sample);
 float _normalise_ain1_value_cm4_rev0(int val);
 float _normalise_ain1_value_cm4_rev1_plus(int val);
 void _config_adcs();
@@ -187,6 +208,9 @@ void ain::init()
 //----------------------------------------------------------------------------
 void ain::deinit()
 {
+    // Stop sampling, if running
+    stop_sampling();
+
     // If initialised
     if (_ain_init) {
         // Stop the VC gencmd
@@ -202,35 +226,14 @@ void ain::deinit()
 //----------------------------------------------------------------------------
 bool ain::read_ain0(float& normalised_value)
 {
-    // If initialised
-    if (_ain_init) {    
-        char buffer[GENCMDSERVICE_MSGFIFO_SIZE];
-
-        // Get the mutex
-        std::lock_guard<std::mutex> lock(_mutex);
-        
-        // Request to read the expression pedal value
-        auto ret = ::vc_gencmd_send("%s", VC_CMD_READ_AIN0_FORMAT);
-        if (ret == 0) {
-            // Get the response
-            ret = ::vc_gencmd_read_response(buffer, sizeof( buffer));
-            if (ret == 0) {
-                // Get the pedal value
-                int value;
-                if (std::sscanf(buffer, VC_RESP_READ_AIN0_FORMAT, &value) == 1) {
-                    // Clamp the value and convert to a normalised float
-                    value = std::clamp(value, 0, UINT8_MAX);
-                    normalised_value = value / (float)UINT8_MAX;
-                    return true;                   
-                }
-            }
-            else {
-                DEBUG_MSG("read_ain0 (vc_gencmd_read_response) failed: " << ret); 
-            }            
-        }
-        else {
-            DEBUG_MSG("read_ain0 (vc_gencmd_send) failed: " << ret); 
-        }
+    int value;
+
+    // Read the expression pedal value
+    if (_read_pmic_reg(VC_CMD_READ_AIN0_FORMAT, VC_RESP_READ_AIN0_FORMAT, value)) {
+        // Clamp the value and convert to a normalised float
+        value = std::clamp(value, 0, UINT8_MAX);
+        normalised_value = value / (float)UINT8_MAX;
+        return true;
     }
     return false;
 }
@@ -240,38 +243,166 @@ bool ain::read_ain0(float& normalised_value)
 //----------------------------------------------------------------------------
 bool ain::read_ain1(float& normalised_value)
 {
-    // If initialised
-    if (_ain_init) {     
-        char buffer[GENCMDSERVICE_MSGFIFO_SIZE];
+    int value;
 
+    // Read the expression pedal value
+    if (_read_pmic_reg(_vc_cmd_read_ain1_format, _vc_resp_read_ain1_format, value)) {
+        // Normalise the pedal value
+        normalised_value = _normalise_ain1_value(value);
+        return true;
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------------
+// start_sampling
+//----------------------------------------------------------------------------
+bool ain::start_sampling()
+{
+    // The analog inputs can only be sampled if initialised
+    if (!_ain_init) {
+        return false;
+    }
+
+    // Start the sampler thread, if not already running
+    if (!_sampler_thread) {
+        _run_sampler = true;
+        _sampler_thread = new std::thread(_process_sampler);
+        ThreadConfig::Apply(_sampler_thread->native_handle(), "ain_sampler");
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// stop_sampling
+//----------------------------------------------------------------------------
+void ain::stop_sampling()
+{
+    // Stop the sampler thread, if running
+    if (_sampler_thread) {
+        _run_sampler = false;
+        if (_sampler_thread->joinable()) {
+            _sampler_thread->join();
+        }
+        delete _sampler_thread;
+        _sampler_thread = nullptr;
+    }
+}
+
+//----------------------------------------------------------------------------
+// wait_ain1
+//----------------------------------------------------------------------------
+bool ain::wait_ain1(AinSample& sample, uint32_t seq, std::chrono::milliseconds timeout)
+{
+    // Wait for an AIN1 sample newer than the sample with this sequence number, or
+    // the timeout
+    // Note: If a newer sample has already been stored this returns immediately, so
+    // a sample stored while the caller was processing the previous one is not missed
+    std::unique_lock<std::mutex> lock(_sample_mutex);
+    return _sample_cv.wait_for(lock, timeout, [&sample, seq]() {
+        return _load_sample(_ain1_sample, sample) && (sample.seq != seq);
+    });
+}
+
+//----------------------------------------------------------------------------
+// _read_pmic_reg
+//----------------------------------------------------------------------------
+bool _read_pmic_reg(const char *cmd, const char *resp_prefix, int& value)
+{
+    // If initialised
+    if (_ain_init) {
         // Get the mutex
         std::lock_guard<std::mutex> lock(_mutex);
-        
-        // Request to read the expression pedal value
-        auto ret = ::vc_gencmd_send("%s", _vc_cmd_read_ain1_format);
+
+        // Request to read the PMIC register
+        auto ret = ::vc_gencmd_send("%s", cmd);
         if (ret == 0) {
             // Get the response
-            ret = ::vc_gencmd_read_response(buffer, sizeof( buffer));
+            ret = ::vc_gencmd_read_response(_vc_resp_buffer, sizeof(_vc_resp_buffer));
             if (ret == 0) {
-                // Get the pedal value
-                int value;
-                if (std::sscanf(buffer, _vc_resp_read_ain1_format, &value) == 1) {
-                    // Normalise the pedal value
-                    normalised_value = _normalise_ain1_value(value);
-                    return true;                   
+                // Check the response is for this register, and get the (hex) value
+                // Note: As per scanf %x, whitespace around the value and a 0x prefix
+                // are allowed
+                auto prefix_len = std::strlen(resp_prefix);
+                if (std::strncmp(_vc_resp_buffer, resp_prefix, prefix_len) == 0) {
+                    const char *first = _vc_resp_buffer + prefix_len;
+                    const char *last = first + ::strnlen(first, sizeof(_vc_resp_buffer) - prefix_len);
+                    while ((first < last) && std::isspace(static_cast<unsigned char>(*first))) {
+                        first++;
+                    }
+                    while ((last > first) && std::isspace(static_cast<unsigned char>(*(last - 1)))) {
+                        last--;
+                    }
+                    if (((last - first) > 2) && (first[0] == '0') && ((first[1] == 'x') || (first[1] == 'X'))) {
+                        first += 2;
+                    }
+                    auto [ptr, ec] = std::from_chars(first, last, value, 16);
+                    return (ec == std::errc()) && (ptr == last);
                 }
             }
             else {
-                DEBUG_MSG("read_ain1 (vc_gencmd_read_response) failed: " << ret); 
-            }            
+                DEBUG_MSG("_read_pmic_reg (vc_gencmd_read_response) failed: " << ret);
+            }
         }
         else {
-            DEBUG_MSG("read_ain1 (vc_gencmd_send) failed: " << ret); 
+            DEBUG_MSG("_read_pmic_reg (vc_gencmd_send) failed: " << ret);
         }
     }
     return false;
 }
 
+//----------------------------------------------------------------------------
+// _process_sampler
+//----------------------------------------------------------------------------
+void _process_sampler()
+{
+    auto sample_time = std::chrono::steady_clock::now();
+    float value;
+
+    // Read AIN1 each sample period, until stopped, and wake any consumer waiting
+    // for the sample
+    // Note: AIN0 is not sampled, as only AIN1 (the Expression pedal) is used
+    while (_run_sampler) {
+        if (ain::read_ain1(value)) {
+            {
+                std::lock_guard<std::mutex> lock(_sample_mutex);
+                _store_sample(_ain1_sample, value);
+            }
+            _sample_cv.notify_all();
+        }
+        sample_time += AIN_SAMPLE_PERIOD;
+        std::this_thread::sleep_until(sample_time);
+    }
+}
+
+//----------------------------------------------------------------------------
+// _store_sample
+//----------------------------------------------------------------------------
+void _store_sample(std::atomic<uint64_t>& sample, float normalised_value)
+{
+    // Pack the next sequence number and the value into a single word, so that the
+    // sample can be read lock-free
+    // Note: Only the sampler thread stores samples
+    uint32_t seq = static_cast<uint32_t>(sample.load(std::memory_order_relaxed) >> 32) + 1;
+    if (seq == 0) {
+        seq = 1;
+    }
+    sample.store((static_cast<uint64_t>(seq) << 32) | std::bit_cast<uint32_t>(normalised_value), std::memory_order_release);
+}
+
+//----------------------------------------------------------------------------
+// _load_sample
+//----------------------------------------------------------------------------
+bool _load_sample(const std::atomic<uint64_t>& sample, ain::AinSample& ain_sample)
+{
+    // Unpack the sequence number and value - the sequence number is zero if no
+    // sample has been read yet
+    uint64_t packed = sample.load(std::memory_order_acquire);
+    ain_sample.seq = static_cast<uint32_t>(packed >> 32);
+    ain_sample.normalised_value = std::bit_cast<float>(static_cast<uint32_t>(packed));
+    return ain_sample.seq != 0;
+}
+
 //----------------------------------------------------------------------------
 // _normalise_ain1_value_cm4_rev0
 //----------------------------------------------------------------------------
@@ -9,13 +9,32 @@
 #ifndef _AIN_H
 #define _AIN_H
 
+#include <chrono>
+#include <cstdint>
+
 namespace ain
 {
+    // Analog Input Sample
+    // The sequence number increments with each new sample, and is zero if no
+    // sample has been read yet
+    struct AinSample
+    {
+        float normalised_value;
+        uint32_t seq;
+    };
+
     // Inteface functions
     void init();
     void deinit();
     bool read_ain0(float& normalised_value);
     bool read_ain1(float& normalised_value);
+
+    // Continuous sampling functions
+    // Note: When sampling, a background thread reads AIN1 (the Expression pedal)
+    // each sample period, and a consumer waits for each new sample
+    bool start_sampling();
+    void stop_sampling();
+    bool wait_ain1(AinSample& sample, uint32_t seq, std::chrono::milliseconds timeout);
 }
 
 #endif  // _AIN_H
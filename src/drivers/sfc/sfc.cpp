@@ -22,11 +22,19 @@
 #include "sfc.h"
 #include "utils.h"
 #include "logger.h"
+#include "metrics.h"
 
 // The *default* is for the MC read packet size to be used
 // Comment this out to perform MC reads without a max packet size
 //#define I2C_MC_READ_USE_PACKET_SIZE     1
 
+// The *default* is for the knob positions in a panel frame to be set with a robust
+// write per knob
+// Uncomment this to set them with a single multi-address I2C transfer instead
+// Note: The multi-address (repeated start) transfer has not yet been verified on
+// the hardware, so is disabled by default
+//#define I2C_PANEL_FRAME_USE_BATCHED_TRANSFER     1
+
 // Surface Control types
 constexpr char KNOB_TYPE_STRING[]         = "knob";
 constexpr char SWITCH_TYPE_STRING[]       = "switch";
@@ -134,6 +142,11 @@ constexpr uint I2C_READ_RETRY_COUNT         = 5;
 constexpr uint I2C_ROBUST_WRITE_RETRY_COUNT = 5;
 constexpr uint I2C_WRITE_RETRY_COUNT        = 5;
 
+// Panel frame constants
+constexpr uint PANEL_FRAME_VERIFY_RETRY_COUNT = 2;
+constexpr auto PANEL_FRAME_DEADLINE           = std::chrono::milliseconds(50);
+static_assert(NUM_PHYSICAL_KNOBS <= I2C_RDWR_IOCTL_MAX_MSGS, "A panel frame must fit in a single I2C transfer");
+
 // Private data
 int _dev_handle;
 bool _pc_active;
@@ -144,6 +157,15 @@ std::string _mc_haptic_mode[NUM_PHYSICAL_KNOBS];
 uint8_t *_led_states;
 std::mutex _controller_mutex;
 int _selected_controller_addr;
+Metric _i2c_read_errors("sfc_i2c_errors_total{op=\"read\"}", MetricType::COUNTER);
+Metric _i2c_write_errors("sfc_i2c_errors_total{op=\"write\"}", MetricType::COUNTER);
+Metric _i2c_robust_write_errors("sfc_i2c_errors_total{op=\"robust_write\"}", MetricType::COUNTER);
+Metric _i2c_read_retries("sfc_i2c_retries_total{op=\"read\"}", MetricType::COUNTER);
+Metric _i2c_write_retries("sfc_i2c_retries_total{op=\"write\"}", MetricType::COUNTER);
+Metric _i2c_robust_write_retries("sfc_i2c_retries_total{op=\"robust_write\"}", MetricType::COUNTER);
+Metric _i2c_transfer_errors("sfc_i2c_errors_total{op=\"transfer\"}", MetricType::COUNTER);
+Metric _panel_frame_fallbacks("sfc_panel_frame_fallbacks_total", MetricType::COUNTER);
+MetricTiming _panel_frame_timing("sfc_panel_frame");
 
 // Private functuions
 void _init_controllers();
@@ -164,6 +186,7 @@ int _mc_set_haptic_mode(uint8_t mc_num, const sfc::HapticMode& haptic_mode);
 int _mc_request_knob_state(uint8_t mc_num);
 int _mc_read_knob_state(uint8_t mc_num, sfc::KnobState *states);
 int _mc_set_position(uint8_t mc_num, uint16_t position, bool robust);
+int _mc_set_positions(const sfc::PanelFrame& frame, bool *verified);
 int _pc_read_switch_states(uint8_t *switch_states);
 int _pc_set_led_states(uint8_t *led_states);
 int _select_mc_default();
@@ -179,6 +202,7 @@ inline int _i2c_mc_write(const void *buf, size_t buf_len);
 int _i2c_read(void *buf, size_t buf_len, size_t packet_len);
 int _i2c_robust_write(const void *buf, size_t buf_len, size_t packet_len, bool readback, uint8_t readback_value);
 int _i2c_write(const void *buf, size_t buf_len, size_t packet_len);
+int _i2c_transfer(i2c_msg *msgs, uint num_msgs);
 
 //----------------------------------------------------------------------------
 // init
@@ -786,6 +810,94 @@ int sfc::set_knob_position(unsigned int knob_num, uint16_t position, bool robust
     return 0;   
 }
 
+//----------------------------------------------------------------------------
+// apply_panel_frame
+//----------------------------------------------------------------------------
+int sfc::apply_panel_frame(const sfc::PanelFrame& frame, sfc::PanelFrame& remaining)
+{
+    bool verified[NUM_PHYSICAL_KNOBS] = {};
+    int ret = 0;
+
+    // Return an error if not open
+    if (_dev_handle == -1)
+    {
+        // Operation not permitted unless open first
+        return -EPERM;
+    }
+
+    // Get the controller mutex for the whole frame, so that the frame is not
+    // interleaved with other bus traffic
+    auto start = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(_controller_mutex);
+
+    // Set the haptic mode of each knob first, so that each knob then moves to its
+    // target position in its new haptic mode
+    // Note: The haptic mode is only written if it has changed. The haptic mode
+    // writes are made within the frame deadline - if the deadline is reached, the
+    // haptic mode and position of the remaining knobs are returned in the remaining
+    // frame to be applied later, so that no knob moves in the wrong haptic mode
+    sfc::PanelFrame positions = frame;
+    for (uint i=0; i<NUM_PHYSICAL_KNOBS; i++)
+    {
+        // Is this Motor Controller active and a haptic mode specified?
+        if (_mc_active[i] && frame.knob_haptic_mode[i])
+        {
+            if ((std::chrono::steady_clock::now() - start) >= PANEL_FRAME_DEADLINE)
+            {
+                // Deadline reached, apply this knob in a later frame
+                remaining.set_knob_haptic_mode(i, *frame.knob_haptic_mode[i]);
+                if (frame.knob_position_set[i])
+                {
+                    remaining.set_knob_position(i, frame.knob_position[i]);
+                }
+                positions.knob_position_set[i] = false;
+                continue;
+            }
+            int res = _mc_set_haptic_mode(i, *frame.knob_haptic_mode[i]);
+            if (res < 0)
+            {
+                // Set Motor Controller haptic mode failed
+                DEBUG_MSG("Motor Controller " << i << " set haptic mode: FAILED");
+                ret = res;
+            }
+        }
+    }
+
+#ifdef I2C_PANEL_FRAME_USE_BATCHED_TRANSFER
+    // Set the position of all knobs back to back, and verify each knob has
+    // processed its position
+    (void)_mc_set_positions(positions, verified);
+#endif
+
+    // Set the position of any knob that has not been verified with a robust
+    // write, until the frame deadline is reached
+    for (uint i=0; i<NUM_PHYSICAL_KNOBS; i++)
+    {
+        // Is this Motor Controller active and its position not verified?
+        if (_mc_active[i] && positions.knob_position_set[i] && !verified[i])
+        {
+#ifdef I2C_PANEL_FRAME_USE_BATCHED_TRANSFER
+            _panel_frame_fallbacks.inc();
+#endif
+            if ((std::chrono::steady_clock::now() - start) >= PANEL_FRAME_DEADLINE)
+            {
+                // Deadline reached, apply this knob in a later frame
+                remaining.set_knob_position(i, frame.knob_position[i]);
+                continue;
+            }
+            int res = _mc_set_position(i, frame.knob_position[i], true);
+            if (res < 0)
+            {
+                // Set Motor Controller position failed
+                DEBUG_MSG("Motor Controller " << i << " set position: FAILED");
+                ret = res;
+            }
+        }
+    }
+    _panel_frame_timing.record(std::chrono::steady_clock::now() - start);
+    return ret;
+}
+
 //----------------------------------------------------------------------------
 // control_type_from_string
 //----------------------------------------------------------------------------
@@ -1585,6 +1697,91 @@ int _mc_set_position(uint8_t mc_num, uint16_t position, bool robust)
     return ret;
 }
 
+//----------------------------------------------------------------------------
+// _mc_set_positions
+//----------------------------------------------------------------------------
+int _mc_set_positions(const sfc::PanelFrame& frame, bool *verified)
+{
+    uint8_t cmds[NUM_PHYSICAL_KNOBS][3];
+    uint8_t resps[NUM_PHYSICAL_KNOBS] = {};
+    i2c_msg msgs[NUM_PHYSICAL_KNOBS];
+    uint8_t mc_nums[NUM_PHYSICAL_KNOBS];
+    uint num_msgs = 0;
+
+    // Setup the position command for each active Motor Controller in the frame,
+    // in Motor Controller order
+    for (uint i=0; i<NUM_PHYSICAL_KNOBS; i++)
+    {
+        if (_mc_active[i] && frame.knob_position_set[i])
+        {
+            // Set the motor position
+            cmds[num_msgs][0] = McRegMap::MOTION_MODE_POSITION;
+            *(uint16_t *)&cmds[num_msgs][sizeof(uint8_t)] = frame.knob_position[i];
+            msgs[num_msgs].addr = MC_BASE_I2C_SLAVE_ADDR + i;
+            msgs[num_msgs].flags = 0;
+            msgs[num_msgs].len = sizeof(cmds[num_msgs]);
+            msgs[num_msgs].buf = cmds[num_msgs];
+            mc_nums[num_msgs++] = i;
+        }
+    }
+    if (num_msgs == 0)
+    {
+        // Nothing to set
+        return 0;
+    }
+
+    // Write all the position commands in a single transfer
+    int ret = _i2c_transfer(msgs, num_msgs);
+    if (ret < 0)
+    {
+        // The position of each knob will be set with a robust write instead
+        return ret;
+    }
+
+    // Read-back each Motor Controller to verify its position was processed, retrying
+    // those not yet verified
+    // The Motor Controller always returns data as part of its protocol
+    // For efficiency, just check the first byte returned is as expected
+    for (uint retry=0; retry<PANEL_FRAME_VERIFY_RETRY_COUNT; retry++)
+    {
+        uint num_reads = 0;
+        for (uint i=0; i<num_msgs; i++)
+        {
+            if (!verified[mc_nums[i]])
+            {
+                msgs[num_reads].addr = MC_BASE_I2C_SLAVE_ADDR + mc_nums[i];
+                msgs[num_reads].flags = I2C_M_RD;
+                msgs[num_reads].len = sizeof(uint8_t);
+                msgs[num_reads].buf = &resps[i];
+                num_reads++;
+            }
+        }
+        if (num_reads == 0)
+        {
+            // All positions verified
+            break;
+        }
+        if (retry > 0)
+        {
+            // Sleep for 1ms before trying again
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ret = _i2c_transfer(msgs, num_reads);
+        if (ret < 0)
+        {
+            break;
+        }
+        for (uint i=0; i<num_msgs; i++)
+        {
+            if (resps[i] == cmds[i][sizeof(uint8_t)])
+            {
+                verified[mc_nums[i]] = true;
+            }
+        }
+    }
+    return ret;
+}
+
 //----------------------------------------------------------------------------
 // _pc_read_switch_states
 //----------------------------------------------------------------------------
@@ -1774,6 +1971,11 @@ int _i2c_read(void *buf, size_t buf_len, size_t packet_len)
                     // with the device, and we can stop trying the read               
                     break;
                 }          
+
+                // Count the retry, if any
+                if (retry_count) {
+                    _i2c_read_retries.inc();
+                }
             }
         }
 
@@ -1791,6 +1993,11 @@ int _i2c_read(void *buf, size_t buf_len, size_t packet_len)
             }
         }
     }
+
+    // Count the error, if any
+    if (ret != 0) {
+        _i2c_read_errors.inc();
+    }
     return ret;
 }
 
@@ -1851,13 +2058,19 @@ int _i2c_robust_write(const void *buf, size_t buf_len, size_t packet_len, bool r
             break;
         }
 
+        // Count the retry, if any
+        if (retry_count) {
+            _i2c_robust_write_retries.inc();
+        }
+
         // Sleep for 1ms before trying again (if possible)
         std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
 
     // If the robust write failed, add an entry to the Monique log
     if (ret != 0) {
-        // Log the error
+        // Count and log the error
+        _i2c_robust_write_errors.inc();
         MONIQUE_LOG_ERROR(MoniqueModule::SFC_CONTROL, 
                           "I2C robust write failed, address {}, command: {:02d}, ret: {}", _selected_controller_addr, (int)*(uint8_t *)buf, ret); 
     }  
@@ -1905,6 +2118,11 @@ int _i2c_write(const void *buf, size_t buf_len, size_t packet_len)
                     // with the device, and we can stop trying the write             
                     break;
                 }
+
+                // Count the retry, if any
+                if (retry_count) {
+                    _i2c_write_retries.inc();
+                }
             }
         }
 
@@ -1917,5 +2135,30 @@ int _i2c_write(const void *buf, size_t buf_len, size_t packet_len)
             len = buf_len > packet_len ? packet_len : buf_len;
         }        
     }
+
+    // Count the error, if any
+    if (ret != 0) {
+        _i2c_write_errors.inc();
+    }
     return ret; 
 }
+
+//----------------------------------------------------------------------------
+// _i2c_transfer
+//----------------------------------------------------------------------------
+int _i2c_transfer(i2c_msg *msgs, uint num_msgs)
+{
+    i2c_rdwr_ioctl_data data = { msgs, num_msgs };
+
+    // Perform the I2C messages as a single combined transfer
+    // Note: There are no retries, if any message fails the transfer is stopped
+    // and the caller must recover
+    int ret = ioctl(_dev_handle, I2C_RDWR, &data);
+    if (ret < 0) {
+        // Count the error
+        ret = -errno;
+        _i2c_transfer_errors.inc();
+        return ret;
+    }
+    return ((uint)ret == num_msgs) ? 0 : -EIO;
+}
@@ -99,6 +99,110 @@ namespace sfc
         }
     };
 
+    // Panel frame
+    // The target haptic mode and position of each knob, which are applied to the
+    // panel together
+    struct PanelFrame
+    {
+        const HapticMode *knob_haptic_mode[NUM_PHYSICAL_KNOBS];
+        bool knob_position_set[NUM_PHYSICAL_KNOBS];
+        uint16_t knob_position[NUM_PHYSICAL_KNOBS];
+
+        // Constructor
+        PanelFrame()
+        {
+            for (uint i=0; i<NUM_PHYSICAL_KNOBS; i++)
+            {
+                knob_haptic_mode[i] = nullptr;
+                knob_position_set[i] = false;
+                knob_position[i] = 0;
+            }
+        }
+
+        // Public functions
+        void set_knob_haptic_mode(uint num, const HapticMode& haptic_mode)
+        {
+            // Set the knob haptic mode, if the knob number is valid
+            if (num < NUM_PHYSICAL_KNOBS)
+            {
+                knob_haptic_mode[num] = &haptic_mode;
+            }
+        }
+
+        void set_knob_position(uint num, uint16_t position)
+        {
+            // Set the knob position, if the knob number is valid
+            if (num < NUM_PHYSICAL_KNOBS)
+            {
+                knob_position_set[num] = true;
+                knob_position[num] = position;
+            }
+        }
+
+        void clear_knob_haptic_mode(uint num)
+        {
+            // Clear the knob haptic mode, if the knob number is valid
+            if (num < NUM_PHYSICAL_KNOBS)
+            {
+                knob_haptic_mode[num] = nullptr;
+            }
+        }
+
+        void clear_knob_position(uint num)
+        {
+            // Clear the knob position, if the knob number is valid
+            if (num < NUM_PHYSICAL_KNOBS)
+            {
+                knob_position_set[num] = false;
+            }
+        }
+
+        void merge(const PanelFrame& frame)
+        {
+            // Set the haptic mode and position of each knob set in the passed frame
+            for (uint i=0; i<NUM_PHYSICAL_KNOBS; i++)
+            {
+                if (frame.knob_haptic_mode[i])
+                {
+                    knob_haptic_mode[i] = frame.knob_haptic_mode[i];
+                }
+                if (frame.knob_position_set[i])
+                {
+                    set_knob_position(i, frame.knob_position[i]);
+                }
+            }
+        }
+
+        void remove(const PanelFrame& frame)
+        {
+            // Clear the haptic mode and position of each knob set in the passed frame
+            for (uint i=0; i<NUM_PHYSICAL_KNOBS; i++)
+            {
+                if (frame.knob_haptic_mode[i])
+                {
+                    clear_knob_haptic_mode(i);
+                }
+                if (frame.knob_position_set[i])
+                {
+                    clear_knob_position(i);
+                }
+            }
+        }
+
+        bool empty() const
+        {
+            // The frame is empty if no knob haptic mode or position is set
+            for (uint i=0; i<NUM_PHYSICAL_KNOBS; i++)
+            {
+                if (knob_haptic_mode[i] || knob_position_set[i])
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
     // Public functions
     int init();
     void reinit();
@@ -111,6 +215,7 @@ namespace sfc
     int read_switch_states(bool *states);
     int set_knob_haptic_mode(unsigned int num, const HapticMode& haptic_mode);
     int set_knob_position(unsigned int num, uint16_t position, bool robust=true);
+    int apply_panel_frame(const PanelFrame& frame, PanelFrame& remaining);
     int set_switch_led_state(unsigned int num, bool led_on);
     void set_all_switch_led_states(bool leds_on);
     int commit_led_states();
@@ -0,0 +1,95 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  ain_filter.cpp
+ * @brief Analog Input Filter implementation.
+ *-----------------------------------------------------------------------------
+ */
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include "ain_filter.h"
+
+//----------------------------------------------------------------------------
+// AinFilter
+//----------------------------------------------------------------------------
+AinFilter::AinFilter(const AinFilterConfig& config) : _config(config)
+{
+    // Initialise class data
+    _samples.resize(std::max(config.oversample, 1u));
+    reset();
+}
+
+//----------------------------------------------------------------------------
+// ~AinFilter
+//----------------------------------------------------------------------------
+AinFilter::~AinFilter()
+{
+    // Nothing specific to do
+}
+
+//----------------------------------------------------------------------------
+// reset
+//----------------------------------------------------------------------------
+void AinFilter::reset()
+{
+    // Clear the samples and filter state, so that the next sample is published
+    // as is
+    std::fill(_samples.begin(), _samples.end(), 0.0f);
+    _sample_index = 0;
+    _num_samples = 0;
+    _filtered_value = 0.0f;
+    _published_value = 0.0f;
+    _published = false;
+}
+
+//----------------------------------------------------------------------------
+// process
+//----------------------------------------------------------------------------
+bool AinFilter::process(float sample, std::chrono::steady_clock::time_point time, float& value)
+{
+    // Add the sample to the oversampling window, and get the average
+    // Note: The window is only a few samples, so it is summed each time rather than
+    // kept as a running total, which would build up rounding drift over a long uptime
+    _samples[_sample_index] = sample;
+    _sample_index = (_sample_index + 1) % _samples.size();
+    _num_samples = std::min(_num_samples + 1, (uint)_samples.size());
+    float average = std::accumulate(_samples.begin(), _samples.end(), 0.0f) / _num_samples;
+
+    // Smooth the average - the faster the input is moving, the less it is smoothed
+    if (!_published) {
+        _filtered_value = average;
+    }
+    else {
+        float delta = average - _filtered_value;
+        float speed = (_config.fast_delta > 0.0f) ? std::min(std::fabs(delta) / _config.fast_delta, 1.0f) : 1.0f;
+        _filtered_value += delta * (_config.smoothing_min + ((_config.smoothing_max - _config.smoothing_min) * speed));
+    }
+
+    // Snap the value to the ends of the range when it is within the dead-band of
+    // them, so that the full range can always be reached
+    float new_value = _filtered_value;
+    if (new_value <= _config.dead_band) {
+        new_value = 0.0f;
+    }
+    else if (new_value >= (1.0f - _config.dead_band)) {
+        new_value = 1.0f;
+    }
+
+    // Publish the value if it has moved outside the dead-band of the last published
+    // value (or onto an end of the range), and the minimum publish interval has
+    // passed
+    if (_published) {
+        if ((new_value == _published_value) ||
+            ((std::fabs(new_value - _published_value) < _config.dead_band) && (new_value != 0.0f) && (new_value != 1.0f)) ||
+            ((time - _publish_time) < _config.min_publish_interval)) {
+            return false;
+        }
+    }
+    _published_value = new_value;
+    _published = true;
+    _publish_time = time;
+    value = new_value;
+    return true;
+}
@@ -0,0 +1,57 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  ain_filter.h
+ * @brief Analog Input Filter class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _AIN_FILTER_H
+#define _AIN_FILTER_H
+
+#include <chrono>
+#include <vector>
+
+// Analog Input Filter Config
+struct AinFilterConfig
+{
+    uint oversample;                                    // Number of raw samples averaged
+    float smoothing_min;                                // Smoothing coefficient when the input is still (0.0 - 1.0)
+    float smoothing_max;                                // Smoothing coefficient when the input moves fast (0.0 - 1.0)
+    float fast_delta;                                   // Change per sample at which the input is moving fast
+    float dead_band;                                    // Minimum change from the last published value
+    std::chrono::milliseconds min_publish_interval;     // Minimum time between published values
+};
+
+// Analog Input Filter class
+// Filters the normalised samples of a noisy analog input (e.g. the Expression
+// pedal) so that only real changes are published. The samples are averaged,
+// smoothed (with less smoothing as the input moves faster, so that fast moves
+// stay responsive), and only published once they move outside a dead-band
+// around the last published value, at a limited rate
+class AinFilter
+{
+public:
+    // Constructor
+    AinFilter(const AinFilterConfig& config);
+
+    // Destructor
+    ~AinFilter();
+
+    // Public functions
+    void reset();
+    bool process(float sample, std::chrono::steady_clock::time_point time, float& value);
+
+private:
+    // Private data
+    AinFilterConfig _config;
+    std::vector<float> _samples;
+    uint _sample_index;
+    uint _num_samples;
+    float _filtered_value;
+    float _published_value;
+    bool _published;
+    std::chrono::steady_clock::time_point _publish_time;
+};
+
+#endif  // _AIN_FILTER_H
@@ -8,6 +8,7 @@
  */
 
 #include "event.h"
+#include "event_trace.h"
 
 //----------------------------------------------------------------------------
 // BaseEvent
@@ -17,6 +18,9 @@ BaseEvent::BaseEvent(MoniqueModule module, EventType type)
     // Initialise class data
     _module = module;
     _type = type;
+
+    // The event is part of the event chain current in this thread, if any
+    _trace_id = EventTrace::CurrentId();
 }
 
 //----------------------------------------------------------------------------
@@ -45,6 +49,15 @@ EventType BaseEvent::type() const
     return _type; 
 }
 
+//----------------------------------------------------------------------------
+// trace_id
+//----------------------------------------------------------------------------
+uint64_t BaseEvent::trace_id() const
+{
+    // Return the event trace ID
+    return _trace_id;
+}
+
 //----------------------------------------------------------------------------
 // MidiEvent
 //----------------------------------------------------------------------------
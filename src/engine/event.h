@@ -33,7 +33,8 @@ enum class SfcFuncType
 	RESET_MULTIFN_SWITCHES,
 	SET_MULTIFN_SWITCH,	
 	SET_CONTROL_HAPTIC_MODE,
-	SET_CONTROLS_STATE
+	SET_CONTROLS_STATE,
+	APPLY_PANEL_FRAME
 };
 
 // Surface Control Function
@@ -46,7 +47,7 @@ public:
 	SfcControlParam *param;
 	uint switch_value;
 	std::string haptic_mode;
-	std::string controls_state;
+	uint controls_state_id;
 	uint num;
 	bool reset_associated_switches;
 
@@ -58,7 +59,7 @@ public:
 		this->param = nullptr;
 		this->switch_value = OFF;
 		this->haptic_mode = "";
-		this->controls_state = "";
+		this->controls_state_id = CONTROL_STATE_ID_NONE;
 		this->num = 0;
 		this->reset_associated_switches = true;
 	}
@@ -78,11 +79,13 @@ public:
 	// Public functions
 	MoniqueModule module() const;
 	EventType type() const;
+	uint64_t trace_id() const;
 
 private:
 	// Private data
     MoniqueModule _module;
     EventType _type;
+    uint64_t _trace_id;
 };
 
 // MIDI Event class
@@ -10,9 +10,21 @@
 #include "event_router.h"
 #include "event.h"
 #include "base_manager.h"
+#include "event_trace.h"
+#include "metrics.h"
 #include <iostream>
 #include <unistd.h>
 
+// Static variables
+// Note: Indexed by the Event Type
+static Metric _events_posted[] = {
+    {"events_posted_total{type=\"midi\"}", MetricType::COUNTER},
+    {"events_posted_total{type=\"param_changed\"}", MetricType::COUNTER},
+    {"events_posted_total{type=\"system_func\"}", MetricType::COUNTER},
+    {"events_posted_total{type=\"reload_presets\"}", MetricType::COUNTER},
+    {"events_posted_total{type=\"sfc_func\"}", MetricType::COUNTER}
+};
+
 
 //----------------------------------------------------------------------------
 // EventRouter
@@ -81,6 +93,10 @@ void EventRouter::register_event_listener(EventListener *listener)
 //----------------------------------------------------------------------------
 void EventRouter::post_midi_event(const MidiEvent *event)
 {
+    // Trace and count the routing of this event
+    EventTraceScope trace_scope("EventRouter", "post_midi_event", event->trace_id());
+    _events_posted[static_cast<uint>(event->type())].inc();
+
     // Go through all of the registered MIDI listeners, and check if they
     // are registered for this event
     for(auto el : _midi_event_listeners)
@@ -102,6 +118,10 @@ void EventRouter::post_midi_event(const MidiEvent *event)
 //----------------------------------------------------------------------------
 void EventRouter::post_param_changed_event(const ParamChangedEvent *event)
 {
+    // Trace and count the routing of this event
+    EventTraceScope trace_scope("EventRouter", "post_param_changed_event", event->trace_id());
+    _events_posted[static_cast<uint>(event->type())].inc();
+
     // Go through all of the registered Param Changed listeners, and check if they
     // are registered for this event
     for(auto el : _param_changed_event_listeners)
@@ -123,6 +143,10 @@ void EventRouter::post_param_changed_event(const ParamChangedEvent *event)
 //----------------------------------------------------------------------------
 void EventRouter::post_system_func_event(const SystemFuncEvent *event)
 {
+    // Trace and count the routing of this event
+    EventTraceScope trace_scope("EventRouter", "post_system_func_event", event->trace_id());
+    _events_posted[static_cast<uint>(event->type())].inc();
+
     // Go through all of the registered System Func listeners, and check if they
     // are registered for this event
     for(auto el : _system_func_event_listeners)
@@ -144,6 +168,10 @@ void EventRouter::post_system_func_event(const SystemFuncEvent *event)
 //----------------------------------------------------------------------------
 void EventRouter::post_reload_presets_event(const ReloadPresetsEvent *event)
 {
+    // Trace and count the routing of this event
+    EventTraceScope trace_scope("EventRouter", "post_reload_presets_event", event->trace_id());
+    _events_posted[static_cast<uint>(event->type())].inc();
+
     // Go through all of the registered Reload Presets listeners, and check if they
     // are registered for this event
     for(auto el : _reload_presets_event_listeners)
@@ -166,6 +194,10 @@ void EventRouter::post_reload_presets_event(const ReloadPresetsEvent *event)
 //----------------------------------------------------------------------------
 void EventRouter::post_sfc_func_event(const SfcFuncEvent *event)
 {
+    // Trace and count the routing of this event
+    EventTraceScope trace_scope("EventRouter", "post_sfc_func_event", event->trace_id());
+    _events_posted[static_cast<uint>(event->type())].inc();
+
     // Go through all of the registered Surface Control Function listeners, and check if they
     // are registered for this event
     for(auto el : _sfc_func_event_listeners)
@@ -0,0 +1,416 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  event_trace.cpp
+ * @brief Event Trace implementation.
+ *-----------------------------------------------------------------------------
+ */
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <ctime>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "ui_common.h"
+#include "event_trace.h"
+#include "metrics.h"
+
+// Constants
+constexpr char EVENT_TRACE_FILENAME[]           = "/tmp/delia_ui_trace.json";
+constexpr uint EVENT_TRACE_MAX_THREADS          = 32;
+constexpr uint EVENT_TRACE_RING_SIZE            = 2048;
+constexpr uint EVENT_TRACE_THREAD_NAME_LEN      = 16;
+constexpr auto EVENT_TRACE_THREAD_POLL_TIME     = std::chrono::milliseconds(100);
+
+// Event Trace Record
+struct EventTraceRecord
+{
+    const char *cat;
+    const char *name;
+    uint64_t id;
+    uint64_t start_ns;
+    uint64_t end_ns;
+};
+
+// Event Trace Ring State
+enum class EventTraceRingState
+{
+    FREE,
+    CLAIMED,
+    IN_USE,
+    RELEASED
+};
+
+// Event Trace Ring
+// Single producer (the owning thread) flight recorder ring - the oldest record
+// is always overwritten. When the owning thread exits the ring is released, and
+// its records are kept (and dumped) until the ring is reused by a new thread
+struct EventTraceRing
+{
+    EventTraceRecord records[EVENT_TRACE_RING_SIZE];
+    std::atomic<uint64_t> write_pos = 0;
+    std::atomic<EventTraceRingState> state = EventTraceRingState::FREE;
+    pid_t tid;
+    char thread_name[EVENT_TRACE_THREAD_NAME_LEN];
+};
+
+// Thread Event Trace
+// Per-thread ring - the ring is released when the thread exits, so that it can
+// be reused
+struct ThreadEventTrace
+{
+    EventTraceRing *ring = nullptr;
+    bool ring_unavailable = false;
+    ~ThreadEventTrace() { if (ring) ring->state.store(EventTraceRingState::RELEASED, std::memory_order_release); }
+};
+
+// Event Trace Slice
+// A record copied from a ring for the dump
+struct EventTraceSlice
+{
+    EventTraceRecord record;
+    uint ring_index;
+};
+
+// Static variables
+// Note: The rings are statically allocated and never freed, so registering a
+// thread never allocates or blocks - if all the rings are in use by running
+// threads, a new thread is not traced
+static EventTraceRing _rings[EVENT_TRACE_MAX_THREADS];
+static Metric _refused_threads("event_trace_refused_threads_total", MetricType::COUNTER);
+static std::atomic<bool> _running = false;
+static std::atomic<bool> _dumping = false;
+static std::atomic<bool> _dump_requested = false;
+static std::atomic<uint64_t> _next_id = 1;
+static std::thread *_dump_thread = nullptr;
+static thread_local ThreadEventTrace _thread_trace;
+static thread_local uint64_t _current_id = 0;
+
+//----------------------------------------------------------------------------
+// _get_thread_ring
+//----------------------------------------------------------------------------
+static EventTraceRing *_get_thread_ring()
+{
+    // Register a ring for this thread if needed
+    // Note: This is only done once for each thread
+    if (!_thread_trace.ring && !_thread_trace.ring_unavailable) {
+        // Claim a ring that has never been used, or failing that one released by a thread
+        // that has exited - its records are overwritten
+        for (auto claim_state : {EventTraceRingState::FREE, EventTraceRingState::RELEASED}) {
+            for (auto& ring : _rings) {
+                auto state = claim_state;
+                if (ring.state.compare_exchange_strong(state, EventTraceRingState::CLAIMED, std::memory_order_acquire)) {
+                    ring.write_pos.store(0, std::memory_order_relaxed);
+                    ring.tid = ::syscall(SYS_gettid);
+                    if (::pthread_getname_np(::pthread_self(), ring.thread_name, sizeof(ring.thread_name)) != 0) {
+                        std::snprintf(ring.thread_name, sizeof(ring.thread_name), "%d", ring.tid);
+                    }
+                    ring.state.store(EventTraceRingState::IN_USE, std::memory_order_release);
+                    _thread_trace.ring = &ring;
+                    return _thread_trace.ring;
+                }
+            }
+        }
+
+        // All the rings are in use, so this thread is not traced
+        _thread_trace.ring_unavailable = true;
+        _refused_threads.inc();
+    }
+    return _thread_trace.ring;
+}
+
+//----------------------------------------------------------------------------
+// _ring_dumpable
+//----------------------------------------------------------------------------
+static bool _ring_dumpable(const EventTraceRing& ring)
+{
+    // Rings in use, or released but not yet reused, are dumped
+    auto state = ring.state.load(std::memory_order_acquire);
+    return (state == EventTraceRingState::IN_USE) || (state == EventTraceRingState::RELEASED);
+}
+
+//----------------------------------------------------------------------------
+// _write_json_string
+//----------------------------------------------------------------------------
+static void _write_json_string(std::FILE *fp, const char *str)
+{
+    // Write the string, skipping any characters that would need escaping
+    std::fputc('"', fp);
+    for (const char *c=str; *c; c++) {
+        if ((*c >= ' ') && (*c != '"') && (*c != '\\')) {
+            std::fputc(*c, fp);
+        }
+    }
+    std::fputc('"', fp);
+}
+
+//----------------------------------------------------------------------------
+// _write_flow_event
+//----------------------------------------------------------------------------
+static void _write_flow_event(std::FILE *fp, const char *ph, const EventTraceSlice& slice, pid_t pid)
+{
+    // Write a flow event bound to the specified slice
+    std::fprintf(fp, ",\n{\"name\":\"event\",\"cat\":\"flow\",\"ph\":\"%s\",\"id\":%" PRIu64 ",\"ts\":%.3f,\"pid\":%d,\"tid\":%d%s}",
+                 ph, slice.record.id, slice.record.start_ns / 1000.0, pid, _rings[slice.ring_index].tid,
+                 (ph[0] == 's') ? "" : ",\"bp\":\"e\"");
+}
+
+//----------------------------------------------------------------------------
+// _dump
+//----------------------------------------------------------------------------
+static void _dump()
+{
+    std::vector<EventTraceSlice> slices;
+    uint num_rings = EVENT_TRACE_MAX_THREADS;
+
+    // Pause recording while the rings are copied
+    // Note: Pausing is only best-effort, as a thread that checked just before the
+    // pause can still be writing a record - each ring copy is checked below
+    _dumping = true;
+    slices.reserve(num_rings * EVENT_TRACE_RING_SIZE);
+    for (uint i=0; i<num_rings; i++) {
+        auto& ring = _rings[i];
+        if (!_ring_dumpable(ring)) {
+            continue;
+        }
+
+        // Copy the records in the ring
+        uint64_t write_pos = ring.write_pos.load(std::memory_order_acquire);
+        uint64_t first_pos = (write_pos > EVENT_TRACE_RING_SIZE) ? (write_pos - EVENT_TRACE_RING_SIZE) : 0;
+        auto first_slice = slices.size();
+        for (uint64_t pos=first_pos; pos<write_pos; pos++) {
+            slices.push_back({ring.records[pos % EVENT_TRACE_RING_SIZE], i});
+        }
+
+        // Re-read the write position (as for a seqlock), and discard the copy of any
+        // record the owning thread may have started to overwrite during the copy
+        // Note: The record at a position is overwritten once the write position
+        // has reached that position plus the ring size
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t new_write_pos = ring.write_pos.load(std::memory_order_relaxed);
+        if (new_write_pos >= (first_pos + EVENT_TRACE_RING_SIZE)) {
+            auto num_overwritten = std::min((new_write_pos - EVENT_TRACE_RING_SIZE + 1 - first_pos), (write_pos - first_pos));
+            slices.erase((slices.begin() + first_slice), (slices.begin() + first_slice + num_overwritten));
+        }
+    }
+    _dumping = false;
+
+    // Open the trace file
+    std::FILE *fp = std::fopen(EVENT_TRACE_FILENAME, "w");
+    if (fp == nullptr) {
+        MSG("Event Trace: Could not open " << EVENT_TRACE_FILENAME);
+        return;
+    }
+    pid_t pid = ::getpid();
+
+    // Write the thread names
+    std::fprintf(fp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    std::fprintf(fp, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"delia_ui\"}}", pid);
+    for (uint i=0; i<num_rings; i++) {
+        if (_ring_dumpable(_rings[i])) {
+            std::fprintf(fp, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":", pid, _rings[i].tid);
+            _write_json_string(fp, _rings[i].thread_name);
+            std::fprintf(fp, "}}");
+        }
+    }
+
+    // Write each slice as a complete event, ordered by start time, and group the
+    // slices in each event chain
+    std::sort(slices.begin(), slices.end(), [](const EventTraceSlice& a, const EventTraceSlice& b) {
+        return a.record.start_ns < b.record.start_ns;
+    });
+    std::unordered_map<uint64_t, std::vector<const EventTraceSlice *>> chains;
+    for (const auto& slice : slices) {
+        std::fprintf(fp, ",\n{\"name\":");
+        _write_json_string(fp, slice.record.name);
+        std::fprintf(fp, ",\"cat\":");
+        _write_json_string(fp, slice.record.cat);
+        std::fprintf(fp, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d,\"args\":{\"id\":%" PRIu64 "}}",
+                     slice.record.start_ns / 1000.0, (slice.record.end_ns - slice.record.start_ns) / 1000.0,
+                     pid, _rings[slice.ring_index].tid, slice.record.id);
+        if (slice.record.id) {
+            chains[slice.record.id].push_back(&slice);
+        }
+    }
+
+    // Link the slices in each event chain with flow events
+    for (const auto& [id, chain] : chains) {
+        if (chain.size() > 1) {
+            for (uint i=0; i<chain.size(); i++) {
+                _write_flow_event(fp, (i == 0) ? "s" : ((i == (chain.size() - 1)) ? "f" : "t"), *chain[i], pid);
+            }
+        }
+    }
+    std::fprintf(fp, "\n]}\n");
+    std::fclose(fp);
+    MSG("Event Trace: " << slices.size() << " slices written to " << EVENT_TRACE_FILENAME);
+}
+
+//----------------------------------------------------------------------------
+// _process_dump
+//----------------------------------------------------------------------------
+static void _process_dump()
+{
+    // Dump the rings whenever requested, until stopped
+    while (_running) {
+        std::this_thread::sleep_for(EVENT_TRACE_THREAD_POLL_TIME);
+        if (_dump_requested.exchange(false)) {
+            _dump();
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Start
+//----------------------------------------------------------------------------
+void EventTrace::Start()
+{
+    // Start recording, and the dump thread
+    if (!_dump_thread) {
+        _running = true;
+        _dump_thread = new std::thread(_process_dump);
+    }
+}
+
+//----------------------------------------------------------------------------
+// Stop
+//----------------------------------------------------------------------------
+void EventTrace::Stop()
+{
+    // Stop recording, and the dump thread
+    if (_dump_thread) {
+        _running = false;
+        if (_dump_thread->joinable()) {
+            _dump_thread->join();
+        }
+        delete _dump_thread;
+        _dump_thread = nullptr;
+    }
+}
+
+//----------------------------------------------------------------------------
+// RequestDump
+// Note: Called from a signal handler, so only sets the request flag
+//----------------------------------------------------------------------------
+void EventTrace::RequestDump()
+{
+    _dump_requested = true;
+}
+
+//----------------------------------------------------------------------------
+// NewId
+//----------------------------------------------------------------------------
+uint64_t EventTrace::NewId()
+{
+    return _next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------
+// CurrentId
+//----------------------------------------------------------------------------
+uint64_t EventTrace::CurrentId()
+{
+    return _current_id;
+}
+
+//----------------------------------------------------------------------------
+// SetCurrentId
+//----------------------------------------------------------------------------
+void EventTrace::SetCurrentId(uint64_t id)
+{
+    _current_id = id;
+}
+
+//----------------------------------------------------------------------------
+// Recording
+//----------------------------------------------------------------------------
+bool EventTrace::Recording()
+{
+    return _running.load(std::memory_order_relaxed) && !_dumping.load(std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------
+// Now
+//----------------------------------------------------------------------------
+uint64_t EventTrace::Now()
+{
+    struct timespec ts;
+    ::clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t(ts.tv_sec) * 1000000000) + ts.tv_nsec;
+}
+
+//----------------------------------------------------------------------------
+// Record
+//----------------------------------------------------------------------------
+void EventTrace::Record(const char *cat, const char *name, uint64_t id, uint64_t start_ns, uint64_t end_ns)
+{
+    // Write the record to this thread's ring, overwriting the oldest
+    auto ring = _get_thread_ring();
+    if (ring) {
+        // Note: The fence orders the record write after the write position already
+        // published, so that the dump can detect a record overwritten as it is copied
+        uint64_t write_pos = ring->write_pos.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        ring->records[write_pos % EVENT_TRACE_RING_SIZE] = {cat, name, id, start_ns, end_ns};
+        ring->write_pos.store(write_pos + 1, std::memory_order_release);
+    }
+}
+
+//----------------------------------------------------------------------------
+// EventTraceContext
+//----------------------------------------------------------------------------
+EventTraceContext::EventTraceContext(uint64_t id)
+{
+    // Make the specified ID current, until this context is destroyed
+    _prev_id = EventTrace::CurrentId();
+    EventTrace::SetCurrentId(id);
+}
+
+//----------------------------------------------------------------------------
+// ~EventTraceContext
+//----------------------------------------------------------------------------
+EventTraceContext::~EventTraceContext()
+{
+    // Restore the previous ID
+    EventTrace::SetCurrentId(_prev_id);
+}
+
+//----------------------------------------------------------------------------
+// EventTraceScope
+//----------------------------------------------------------------------------
+EventTraceScope::EventTraceScope(const char *cat, const char *name) :
+    EventTraceScope(cat, name, EventTrace::CurrentId())
+{
+    // Nothing specific to do
+}
+
+//----------------------------------------------------------------------------
+// EventTraceScope
+//----------------------------------------------------------------------------
+EventTraceScope::EventTraceScope(const char *cat, const char *name, uint64_t id)
+{
+    // Initialise class data
+    // Note: The time is only read if recording, so a scope costs next to nothing
+    // otherwise
+    _cat = cat;
+    _name = name;
+    _id = id;
+    _start_ns = EventTrace::Recording() ? EventTrace::Now() : 0;
+}
+
+//----------------------------------------------------------------------------
+// ~EventTraceScope
+//----------------------------------------------------------------------------
+EventTraceScope::~EventTraceScope()
+{
+    // Record the slice, if recording for the whole scope
+    if (_start_ns && EventTrace::Recording()) {
+        EventTrace::Record(_cat, _name, _id, _start_ns, EventTrace::Now());
+    }
+}
@@ -0,0 +1,72 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  event_trace.h
+ * @brief Event Trace class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _EVENT_TRACE_H
+#define _EVENT_TRACE_H
+
+#include <cstdint>
+
+// Event Trace
+// Records timed slices of the event processing in each thread (surface poll,
+// event routing, manager processing, DAW and GUI sends) into a per-thread
+// in-memory ring, which always holds the most recent slices. Each slice carries
+// the causal ID of the event chain it belongs to - a new ID is created where an
+// event chain starts (e.g. a surface control poll), and is passed on with each
+// event created while it is current. When requested (SIGUSR1), the rings are
+// dumped to a Chrome trace JSON file, which can be opened in Perfetto or
+// chrome://tracing, with each event chain linked by flow arrows
+class EventTrace
+{
+public:
+    // Public functions
+    static void Start();
+    static void Stop();
+    static void RequestDump();
+    static uint64_t NewId();
+    static uint64_t CurrentId();
+    static void SetCurrentId(uint64_t id);
+    static bool Recording();
+    static uint64_t Now();
+    static void Record(const char *cat, const char *name, uint64_t id, uint64_t start_ns, uint64_t end_ns);
+};
+
+// Event Trace Context
+// Sets the current causal ID of this thread, until the context goes out of scope
+class EventTraceContext
+{
+public:
+    // Constructor/destructor
+    EventTraceContext(uint64_t id);
+    ~EventTraceContext();
+
+private:
+    // Private variables
+    uint64_t _prev_id;
+};
+
+// Event Trace Scope
+// Records a slice from construction until the scope goes out of scope
+// Note: The category and name must be string literals, as only the pointers
+// are recorded
+class EventTraceScope
+{
+public:
+    // Constructor/destructor
+    EventTraceScope(const char *cat, const char *name);
+    EventTraceScope(const char *cat, const char *name, uint64_t id);
+    ~EventTraceScope();
+
+private:
+    // Private variables
+    const char *_cat;
+    const char *_name;
+    uint64_t _id;
+    uint64_t _start_ns;
+};
+
+#endif // _EVENT_TRACE_H
@@ -0,0 +1,223 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  executor.cpp
+ * @brief Executor implementation.
+ *-----------------------------------------------------------------------------
+ */
+#include <pthread.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ui_common.h"
+#include "executor.h"
+#include "thread_config.h"
+
+// Executor Priority Config
+struct ExecutorPriorityConfig
+{
+    const char *name;
+    uint num_workers;
+    int nice;
+};
+
+// Constants
+// Note: Indexed by the Executor Priority
+constexpr ExecutorPriorityConfig EXECUTOR_PRIORITY_CONFIG[] = {
+    {"exec_high", 2, -5},
+    {"exec_ipc", 1, -5},
+    {"exec_io", 1, -5},
+    {"exec_normal", 2, 0},
+    {"exec_bg", 1, 10}
+};
+constexpr uint NUM_EXECUTOR_PRIORITIES = sizeof(EXECUTOR_PRIORITY_CONFIG) / sizeof(ExecutorPriorityConfig);
+
+// Executor Queue
+// The tasks posted to a priority, and its worker threads
+struct ExecutorQueue
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::function<void()>> tasks;
+    std::vector<std::thread *> workers;
+};
+
+// Executor Scheduled Task
+struct ExecutorScheduledTask
+{
+    std::chrono::steady_clock::time_point time;
+    uint64_t seq;
+    ExecutorPriority priority;
+    std::function<void()> task;
+
+    // Ordered so that the earliest task (and the first posted, for the same time)
+    // is at the top of the schedule
+    bool operator<(const ExecutorScheduledTask& other) const {
+        return (time > other.time) || ((time == other.time) && (seq > other.seq));
+    }
+};
+
+// Static variables
+static std::atomic<bool> _running = false;
+static ExecutorQueue _queues[NUM_EXECUTOR_PRIORITIES];
+static std::mutex _schedule_mutex;
+static std::condition_variable _schedule_cv;
+static std::priority_queue<ExecutorScheduledTask> _schedule;
+static uint64_t _schedule_seq = 0;
+static std::thread *_schedule_thread = nullptr;
+
+//----------------------------------------------------------------------------
+// _process_worker
+//----------------------------------------------------------------------------
+static void _process_worker(uint priority, uint index)
+{
+    auto& config = EXECUTOR_PRIORITY_CONFIG[priority];
+    auto& queue = _queues[priority];
+
+    // Set the priority of the worker, and apply any thread config for its
+    // executor priority - each worker is named with its index
+    // Note: Raising the priority (a negative nice value) may fail if the app is not
+    // run as root, in which case the worker runs at the normal priority
+    if (::setpriority(PRIO_PROCESS, ::syscall(SYS_gettid), config.nice) != 0) {
+        DEBUG_MSG("Executor: Could not set the priority of " << config.name << "_" << index);
+    }
+    ThreadConfig::Apply(::pthread_self(), config.name, "_" + std::to_string(index));
+
+    // Run the posted tasks until stopped
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lk(queue.mutex);
+            queue.cv.wait(lk, [&queue]() { return !queue.tasks.empty() || !_running; });
+            if (!_running) {
+                break;
+            }
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        task();
+    }
+}
+
+//----------------------------------------------------------------------------
+// _process_schedule
+//----------------------------------------------------------------------------
+static void _process_schedule()
+{
+    std::unique_lock<std::mutex> lk(_schedule_mutex);
+
+    // Post each scheduled task when it is due, until stopped
+    while (_running) {
+        if (_schedule.empty()) {
+            _schedule_cv.wait(lk);
+        }
+        else if (_schedule.top().time > std::chrono::steady_clock::now()) {
+            _schedule_cv.wait_until(lk, _schedule.top().time);
+        }
+        else {
+            auto scheduled = _schedule.top();
+            _schedule.pop();
+            Executor::Post(scheduled.priority, std::move(scheduled.task));
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Start
+//----------------------------------------------------------------------------
+void Executor::Start()
+{
+    // Start the worker threads for each priority, and the schedule thread
+    std::lock_guard<std::mutex> lock(_schedule_mutex);
+    if (!_running) {
+        _running = true;
+        for (uint i=0; i<NUM_EXECUTOR_PRIORITIES; i++) {
+            std::lock_guard<std::mutex> queue_lock(_queues[i].mutex);
+            for (uint j=0; j<EXECUTOR_PRIORITY_CONFIG[i].num_workers; j++) {
+                _queues[i].workers.push_back(new std::thread(_process_worker, i, j));
+            }
+        }
+        _schedule_thread = new std::thread(_process_schedule);
+        ThreadConfig::Apply(_schedule_thread->native_handle(), "exec_schedule");
+    }
+}
+
+//----------------------------------------------------------------------------
+// Stop
+//----------------------------------------------------------------------------
+void Executor::Stop()
+{
+    // Stop the schedule thread
+    {
+        std::lock_guard<std::mutex> lock(_schedule_mutex);
+        if (!_running) {
+            return;
+        }
+        _running = false;
+    }
+    _schedule_cv.notify_all();
+    if (_schedule_thread->joinable()) {
+        _schedule_thread->join();
+    }
+    delete _schedule_thread;
+    _schedule_thread = nullptr;
+
+    // Stop the worker threads - any tasks not yet run are discarded
+    for (auto& queue : _queues) {
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.cv.notify_all();
+        }
+        for (auto worker : queue.workers) {
+            if (worker->joinable()) {
+                worker->join();
+            }
+            delete worker;
+        }
+        queue.workers.clear();
+        queue.tasks.clear();
+    }
+    std::lock_guard<std::mutex> lock(_schedule_mutex);
+    _schedule = {};
+}
+
+//----------------------------------------------------------------------------
+// Post
+//----------------------------------------------------------------------------
+void Executor::Post(ExecutorPriority priority, std::function<void()> task)
+{
+    // Add the task to the queue for this priority, and wake a worker to run it
+    auto& queue = _queues[static_cast<uint>(priority)];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    queue.cv.notify_one();
+}
+
+//----------------------------------------------------------------------------
+// PostAt
+//----------------------------------------------------------------------------
+void Executor::PostAt(ExecutorPriority priority, std::chrono::steady_clock::time_point time, std::function<void()> task)
+{
+    // Add the task to the schedule, and wake the schedule thread if it is now
+    // the next task due
+    bool next_due;
+    {
+        std::lock_guard<std::mutex> lock(_schedule_mutex);
+        _schedule.push({time, _schedule_seq++, priority, std::move(task)});
+        next_due = (_schedule.top().seq == (_schedule_seq - 1));
+    }
+    if (next_due) {
+        _schedule_cv.notify_one();
+    }
+}
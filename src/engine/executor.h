@@ -0,0 +1,46 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  executor.h
+ * @brief Executor class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _EXECUTOR_H
+#define _EXECUTOR_H
+
+#include <chrono>
+#include <functional>
+
+// Executor Priority
+enum class ExecutorPriority
+{
+    HIGH,
+    HIGH_IPC,
+    HIGH_IO,
+    NORMAL,
+    BACKGROUND
+};
+
+// Executor
+// A fixed set of worker threads for each priority, which run the tasks posted to
+// that priority in order. The non real-time work of the app (manager event
+// processing and timers) runs on the executor, rather than on a thread per
+// manager and timer. Tasks that must not run concurrently (e.g. the events of a
+// manager) are serialised by their owner, and a task should not block for long,
+// as it holds a worker of its priority while it runs. High priority tasks that do
+// block on IPC (e.g. the DAW Manager calls to Sushi) are posted to HIGH_IPC, and
+// those that block on device I/O (e.g. the Surface Control Manager I2C transfers)
+// to HIGH_IO - each has its own worker, so that they never hold up the other high
+// priority tasks
+class Executor
+{
+public:
+    // Public functions
+    static void Start();
+    static void Stop();
+    static void Post(ExecutorPriority priority, std::function<void()> task);
+    static void PostAt(ExecutorPriority priority, std::chrono::steady_clock::time_point time, std::function<void()> task);
+};
+
+#endif // _EXECUTOR_H
@@ -11,6 +11,7 @@
 #include "arp_manager.h"
 #include "daw_manager.h"
 #include "utils.h"
+#include "thread_config.h"
 
 // Constants
 constexpr char DIR_MODE_PARAM_NAME[]   = "dirmode";
@@ -24,16 +25,13 @@ constexpr uint MAX_ARP_NOTES		   = 100;
 // ArpManager
 //----------------------------------------------------------------------------
 ArpManager::ArpManager(EventRouter *event_router) : 
-    BaseManager(MoniqueModule::ARP, "ArpManager", event_router)             
+    BaseManager(MoniqueModule::ARP, "ArpManager", event_router, ExecutorPriority::HIGH)             
 {
     // Initialise class data
     _param_changed_listener = 0;
     _reload_presets_listener = 0;
     _tempo_event_thread = 0;
     _fsm_running = true;
-    _tempo_pulse_count = utils::tempo_pulse_count(common::TempoNoteValue::QUARTER);
-    _note_duration_pulse_count = _tempo_pulse_count >> 1;
-    _pulse_count = 0;
     _enable = false;
     _hold = false;
     _dir_mode = ArpDirMode::UP;
@@ -46,6 +44,7 @@ ArpManager::ArpManager(EventRouter *event_router) :
     _step = 0;
     _hold_timeout = true;
     _midi_clk_in = false;
+    _send_time = NOTE_SCHEDULER_SEND_NOW;
 
     // Register the Arp params
     _register_params();
@@ -95,6 +94,7 @@ bool ArpManager::start()
 
 	// Start the tempo event thread
 	_tempo_event_thread = new std::thread(&ArpManager::_process_tempo_event, this);
+	ThreadConfig::Apply(_tempo_event_thread->native_handle(), "arp_tempo");
 
     // Call the base manager
     return BaseManager::start();	
@@ -147,6 +147,15 @@ void ArpManager::process_event(const BaseEvent *event)
 // process_midi_event_direct
 //----------------------------------------------------------------------------
 void ArpManager::process_midi_event_direct(const snd_seq_event_t *event)
+{
+    // Process the event, sending any notes immediately
+    schedule_midi_event_direct(event, NOTE_SCHEDULER_SEND_DIRECT);
+}
+
+//----------------------------------------------------------------------------
+// schedule_midi_event_direct
+//----------------------------------------------------------------------------
+void ArpManager::schedule_midi_event_direct(const snd_seq_event_t *event, std::chrono::steady_clock::time_point time)
 {
     auto data = *event;
 
@@ -155,7 +164,7 @@ void ArpManager::process_midi_event_direct(const snd_seq_event_t *event)
 
     // If the msg is a key pressure event, then just forward it
     if (data.type == snd_seq_event_type::SND_SEQ_EVENT_KEYPRESS) {
-       _send_note(data); 
+       _send_note(data, time); 
        return;
     }
 
@@ -168,7 +177,7 @@ void ArpManager::process_midi_event_direct(const snd_seq_event_t *event)
             (data.type == snd_seq_event_type::SND_SEQ_EVENT_NOTEON))
         {
             // Send the note to the DAW
-            _send_note(data);
+            _send_note(data, time);
 
             // Also add/remove the notes from the arps array, this means that if notes are held before turing on the arp, it will play them
             if ((data.type == snd_seq_event_type::SND_SEQ_EVENT_NOTEON) && (data.data.note.velocity != 0))
@@ -210,7 +219,7 @@ void ArpManager::process_midi_event_direct(const snd_seq_event_t *event)
                     // If it can't be removed (isn't known) then just forward to the DAW
                     // We do this as it could be a note-off from a keypress before the Arpeggiator
                     // was enabled
-                    _send_note(data);
+                    _send_note(data, time);
                 }
 
                 // If there are no more notes left to play
@@ -227,7 +236,7 @@ void ArpManager::process_midi_event_direct(const snd_seq_event_t *event)
                     // If the note isn't known, then just forward to the DAW
                     // We do this as it could be a note-off from a keypress before the Arpeggiator
                     // was enabled
-                    _send_note(data);
+                    _send_note(data, time);
                 }
             }
         }
@@ -356,8 +365,7 @@ void ArpManager::_process_param_value(const Param &param)
 
             case ArpParamId::ARP_TEMPO_NOTE_VALUE_PARAM_ID: {       
                 // Set the tempo pulse count from the updated note value
-                _tempo_pulse_count = utils::tempo_pulse_count(utils::tempo_note_value(param.hr_value()));
-                _note_duration_pulse_count = _tempo_pulse_count >> 1;
+                _pulse_counter.set_tempo_pulse_count(utils::tempo_pulse_count(utils::tempo_note_value(param.hr_value())));
                 break;               
             }
 
@@ -401,13 +409,15 @@ void ArpManager::_process_tempo_event()
         // If the FSM is running
         if (_fsm_running) {
             // Has the FSM been reset or the required number of tempo pulses reached?
-            if (++_pulse_count >= _note_duration_pulse_count) {
-                // Process the FSN
+            if (_pulse_counter.pulse()) {
+                // Process the FSN, scheduling any notes sent for this tempo pulse rather
+                // than sending them immediately
+                _send_time = utils::arp_pulse_time() + NOTE_SCHEDULER_LATENCY;
                 _process_fsm();
+                _send_time = NOTE_SCHEDULER_SEND_NOW;
 
                 // Set the next note duration pulse count to check
-                _note_duration_pulse_count = _tempo_pulse_count - _note_duration_pulse_count;
-                _pulse_count = 0;
+                _pulse_counter.next_duration();
             }
         }
         else {
@@ -432,8 +442,7 @@ void ArpManager::_process_fsm_async_event(bool reset)
         // Should we also reset the pulse count?
         if (reset) {
             // Set the next note duration pulse count to check
-            _note_duration_pulse_count = _tempo_pulse_count - _note_duration_pulse_count;
-            _pulse_count = 0;
+            _pulse_counter.next_duration();
         }
     }
 }
@@ -837,7 +846,7 @@ void ArpManager::_send_arp_note()
 {
     // Get the next Arpeggiator note to play and send it
     _note_on = _get_next_arp_note();
-    _send_note(_note_on);
+    _send_note(_note_on, _send_time);
 }
 
 //----------------------------------------------------------------------------
@@ -850,7 +859,7 @@ void ArpManager::_stop_arp_note()
     snd_seq_event_t note_off = _note_on;
     note_off.type = snd_seq_event_type::SND_SEQ_EVENT_NOTEOFF;
     note_off.data.note.velocity = 0;
-    _send_note(note_off);
+    _send_note(note_off, _send_time);
 }
 
 //----------------------------------------------------------------------------
@@ -865,7 +874,7 @@ void ArpManager::_stop_arp_notes()
             auto note_off = _arp_notes[i];
             note_off.type = snd_seq_event_type::SND_SEQ_EVENT_NOTEOFF;
             note_off.data.note.velocity = 0;
-            _send_note(note_off);
+            _send_note(note_off, _send_time);
         }
     }
 }
@@ -873,15 +882,20 @@ void ArpManager::_stop_arp_notes()
 //----------------------------------------------------------------------------
 // _send_note
 //----------------------------------------------------------------------------
-void ArpManager::_send_note(const snd_seq_event_t &note)
+void ArpManager::_send_note(const snd_seq_event_t &note, std::chrono::steady_clock::time_point time)
 {
     //if (note.type == snd_seq_event_type::SND_SEQ_EVENT_NOTEON)
     //    DEBUG_BASEMGR_MSG("Send note: " << (int)note.data.note.note << ": ON");
     //else
     //    DEBUG_BASEMGR_MSG("Send note: " << (int)note.data.note.note << ": OFF");
 
-    // Send the note directly to the DAW
-    utils::get_manager(MoniqueModule::DAW)->process_midi_event_direct(&note);
+    // Send the note directly to the DAW, scheduled if a send time is specified
+    // Note: Notes generated by the Sequencer or Arpeggiator always have a send time, so
+    // that they are ordered with (and can cancel) the notes already scheduled, notes
+    // from the keyboard or MIDI input do not
+    time == NOTE_SCHEDULER_SEND_DIRECT ?
+        utils::get_manager(MoniqueModule::DAW)->process_midi_event_direct(&note) :
+        utils::get_manager(MoniqueModule::DAW)->schedule_midi_event_direct(&note, time);
 }
 
 //----------------------------------------------------------------------------
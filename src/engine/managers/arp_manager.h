@@ -20,6 +20,8 @@
 #include "timer.h"
 #include "utils.h"
 #include "layer_info.h"
+#include "note_scheduler.h"
+#include "tempo_pulse_counter.h"
 
 // Arpeggiator Param IDs
 enum ArpParamId : int
@@ -66,6 +68,7 @@ public:
     void process();
     void process_event(const BaseEvent *event);
     void process_midi_event_direct(const snd_seq_event_t *event);
+    void schedule_midi_event_direct(const snd_seq_event_t *event, std::chrono::steady_clock::time_point time);
 
 private:
     // Private variables
@@ -73,9 +76,7 @@ private:
     EventListener *_reload_presets_listener;
     std::thread *_tempo_event_thread;
     bool _fsm_running;
-    uint _tempo_pulse_count;
-    uint _pulse_count;
-    uint _note_duration_pulse_count;
+    TempoPulseCounter _pulse_counter;
     std::atomic<bool> _enable;
     std::atomic<bool> _hold;
     std::atomic<ArpDirMode> _dir_mode;
@@ -93,6 +94,7 @@ private:
     bool _hold_timeout;
     bool _hold_reset  = true;
     bool _midi_clk_in;
+    std::chrono::steady_clock::time_point _send_time;
 
     // Private functions
     void _process_param_changed_event(const ParamChange &param_change);
@@ -109,7 +111,7 @@ private:
     void _send_arp_note();
     void _stop_arp_note();
     void _stop_arp_notes();
-    void _send_note(const snd_seq_event_t &note);
+    void _send_note(const snd_seq_event_t &note, std::chrono::steady_clock::time_point time);
     void _register_params();
 };
 
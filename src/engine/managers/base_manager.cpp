@@ -8,36 +8,34 @@
  */
 #include <iostream>
 #include "base_manager.h"
+#include "event_trace.h"
 #include "utils.h"
 
-// Base Message Type
-enum class BaseMsgType
-{
-    POST_EVENT,
-    EXIT_THREAD
-};
+// Constants
+constexpr uint MAX_EVENTS_PER_RUN = 32;
 
 // Base message
 struct BaseManagerMsg
 {
-    BaseManagerMsg(BaseMsgType a, const BaseEvent *b) 
+    BaseManagerMsg(const BaseEvent *e) 
     {
-        base_msg_type = a;
-        event = b;
+        event = e;
     }
-    BaseMsgType base_msg_type;
     const BaseEvent *event;
 };
 
 //----------------------------------------------------------------------------
 // BaseManager
 //----------------------------------------------------------------------------
-BaseManager::BaseManager(MoniqueModule module, const char* thread_name, EventRouter *event_router) : _mgr_thread(0), _THREAD_NAME(thread_name)
+BaseManager::BaseManager(MoniqueModule module, const char* thread_name, EventRouter *event_router, ExecutorPriority priority) :
+    _THREAD_NAME(thread_name),
+    _queue_depth(std::string("manager_queue_depth{manager=\"") + thread_name + "\"}", MetricType::GAUGE)
 {
     // Initialise private data
     _module = module;
     _event_router = event_router;
-    _mgr_thread = 0;
+    _priority = priority;
+    _process_scheduled = false;
 }
 
 //----------------------------------------------------------------------------
@@ -45,7 +43,7 @@ BaseManager::BaseManager(MoniqueModule module, const char* thread_name, EventRou
 //----------------------------------------------------------------------------
 BaseManager::~BaseManager()
 {
-    // Make sure any threads are tidied up
+    // Make sure event processing is stopped
     stop();
 }
 
@@ -54,11 +52,18 @@ BaseManager::~BaseManager()
 //----------------------------------------------------------------------------
 bool BaseManager::start()
 {
-    // If the thread has not been created
-    if (!_mgr_thread)
+    // If not already started
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_running)
     {
-        // Create a non real-time thread
-        _mgr_thread = new std::thread(&BaseManager::process, this);
+        // Run the manager entry point on the executor, followed by any events
+        // posted before it has run
+        _running = true;
+        _process_scheduled = true;
+        Executor::Post(_priority, [this]() {
+            process();
+            _process_msgs();
+        });
     }
     return true;
 }
@@ -84,22 +89,22 @@ const char *BaseManager::name() const
 //----------------------------------------------------------------------------
 void BaseManager::stop()
 {
-    if (!_mgr_thread)
+    // Stop processing events, and wait for any events being processed to finish
+    std::unique_lock<std::mutex> lk(_mutex);
+    if (!_running)
         return;
+    _running = false;
+    _cv.wait(lk, [this]() { return !_process_scheduled; });
 
-    // Create a new BaseManagerMsg
-    BaseManagerMsg* msg = new BaseManagerMsg(BaseMsgType::EXIT_THREAD, nullptr);
-
-    // Put exit thread message into the queue
+    // Delete any events not processed
+    while (!_msg_queue.empty())
     {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _msg_queue.push_back(msg);
-        _cv.notify_one();
+        auto msg = _msg_queue.front();
+        _msg_queue.pop_front();
+        delete msg->event;
+        delete msg;
     }
-    if (_mgr_thread->joinable())
-        _mgr_thread->join();
-    delete _mgr_thread;
-    _mgr_thread = 0;
+    _queue_depth.set(0);
 }
 
 //----------------------------------------------------------------------------
@@ -107,7 +112,7 @@ void BaseManager::stop()
 //----------------------------------------------------------------------------
 void BaseManager::post_msg(const BaseEvent *event)
 {
-    BaseManagerMsg* new_msg = new BaseManagerMsg(BaseMsgType::POST_EVENT, event);
+    BaseManagerMsg* new_msg = new BaseManagerMsg(event);
     bool push_msg = true;
 
     // Firstly get the last event in the queue (if any) and check if it is
@@ -166,10 +171,16 @@ void BaseManager::post_msg(const BaseEvent *event)
         }
     }
 
-    // Add the message if needed and notify the worker thread
+    // Add the message if needed, and schedule the processing of the queued
+    // events on the executor if not already scheduled
     if (push_msg)
         _msg_queue.push_back(new_msg);
-    _cv.notify_one();
+    _queue_depth.set(_msg_queue.size());
+    if (_running && !_process_scheduled)
+    {
+        _process_scheduled = true;
+        Executor::Post(_priority, [this]() { _process_msgs(); });
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -177,59 +188,51 @@ void BaseManager::post_msg(const BaseEvent *event)
 //----------------------------------------------------------------------------
 void BaseManager::process()
 {
-    while (1)
+    // Nothing specific to do - once the entry point has run, events are processed
+    // on the executor as they are posted
+}
+
+//----------------------------------------------------------------------------
+// _process_msgs
+//----------------------------------------------------------------------------
+void BaseManager::_process_msgs()
+{
+    // Process the queued events
+    // Note: Events are only ever processed by one executor worker at a time, as
+    // this is only scheduled when not already scheduled or running
+    for (uint i=0; i<MAX_EVENTS_PER_RUN; i++)
     {
-        BaseManagerMsg* msg = 0;
+        BaseManagerMsg* msg;
         {
-            // Wait for a message to be added to the queue
-            std::unique_lock<std::mutex> lk(_mutex);
-            while (_msg_queue.empty())
-                _cv.wait(lk);
-
-            if (_msg_queue.empty())
-                continue;
-
+            // If there are no more events to process (or the manager has been
+            // stopped), processing is no longer scheduled
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_msg_queue.empty() || !_running)
+            {
+                _process_scheduled = false;
+                _cv.notify_all();
+                return;
+            }
             msg = _msg_queue.front();
             _msg_queue.pop_front();
+            _queue_depth.set(_msg_queue.size());
         }
 
-        // Parse the Base Message Type
-        switch (msg->base_msg_type)
+        // Process the event, as part of the event chain it was created in
         {
-            case BaseMsgType::POST_EVENT:
-            {
-                // Process the event
-                process_event(msg->event);
-
-                // Delete dynamic data passed through message queue
-                if (msg->event)
-                    delete msg->event;
-                delete msg;
-                break;
-            }
-
-            case BaseMsgType::EXIT_THREAD:
-            {
-                if (msg->event)
-                    delete msg->event;
-                delete msg;
-                std::unique_lock<std::mutex> lk(_mutex);
-                while (!_msg_queue.empty())
-                {
-                    msg = _msg_queue.front();
-                    _msg_queue.pop_front();
-                    if (msg->event)
-                        delete msg->event;					
-                    delete msg;
-                }
-                return;
-            }
-
-            default:
-                DEBUG_BASEMGR_MSG("Unknown message");
-                //ASSERT();
+            EventTraceContext trace_context(msg->event->trace_id());
+            EventTraceScope trace_scope(name(), "process_event");
+            process_event(msg->event);
         }
+
+        // Delete dynamic data passed through message queue
+        delete msg->event;
+        delete msg;
     }
+
+    // There are still events to process - re-schedule the processing so that other
+    // tasks of this priority get to run first
+    Executor::Post(_priority, [this]() { _process_msgs(); });
 }
 
 //----------------------------------------------------------------------------
@@ -247,3 +250,12 @@ void BaseManager::process_midi_event_direct([[maybe_unused]] const snd_seq_event
 {
     // Overriden as necessary
 }
+
+//----------------------------------------------------------------------------
+// schedule_midi_event_direct
+//----------------------------------------------------------------------------
+void BaseManager::schedule_midi_event_direct(const snd_seq_event_t *event, [[maybe_unused]] std::chrono::steady_clock::time_point time)
+{
+    // Overriden as necessary, by default process the event immediately
+    process_midi_event_direct(event);
+}
@@ -11,11 +11,14 @@
 
 #include "ui_common.h"
 #include "event.h"
+#include "executor.h"
+#include "metrics.h"
 #include <thread>
 #include <queue>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <chrono>
 
 // Debug message MACRO
 #define BASEMGR_MSG(str)        MSG(this->name() << ": " << str)
@@ -28,16 +31,16 @@ class BaseManager
 {
 public:
     // Constructor
-    BaseManager(MoniqueModule module, const char* thread_name, EventRouter *event_router);
+    BaseManager(MoniqueModule module, const char* thread_name, EventRouter *event_router, ExecutorPriority priority = ExecutorPriority::NORMAL);
 
     // Destructor
     virtual ~BaseManager();
 
-    // Called once to create the thread
-    // @return TRUE if thread is created. FALSE otherwise.
+    // Called once to start processing events on the executor
+    // @return TRUE if started. FALSE otherwise.
     virtual bool start();
 
-    // Called once a program exit to exit the thread
+    // Called once a program exit to stop processing events
     virtual void stop();
 
     // Get the module of this manager
@@ -46,27 +49,35 @@ public:
     // Get the Manager name
     const char *name() const;
 
-    // Add a message to thread queue.
+    // Add a message to the event queue.
     void post_msg(const BaseEvent *event);
 
-    // Entry point for the thread
+    // Entry point, run on the executor before any events are processed
     virtual void process();
     virtual void process_event(const BaseEvent *event);
 
     // Function to process MIDI event direct
     virtual void process_midi_event_direct(const snd_seq_event_t *event);
 
+    // Function to schedule a MIDI event direct, to be sent at the specified time
+    virtual void schedule_midi_event_direct(const snd_seq_event_t *event, std::chrono::steady_clock::time_point time);
+
 protected:
     EventRouter *_event_router;
     
 private:
-    std::thread* _mgr_thread;
     std::deque<BaseManagerMsg*> _msg_queue;
     std::mutex _mutex;
     std::condition_variable _cv;
     std::atomic<bool> _running{false};
     const char *_THREAD_NAME;
     MoniqueModule _module;
+    ExecutorPriority _priority;
+    bool _process_scheduled;
+    Metric _queue_depth;
+
+    // Private functions
+    void _process_msgs();
 };
 
 #endif  // _BASE_MANAGER_H
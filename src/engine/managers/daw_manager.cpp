@@ -10,6 +10,9 @@
 #include <unistd.h>
 #include <regex>
 #include "daw_manager.h"
+#include "event_trace.h"
+#include "metrics.h"
+#include "param_value_store.h"
 #include "sushi_client.h"
 #include "utils.h"
 #include "logger.h"
@@ -30,11 +33,17 @@ constexpr char PATCH_STATE_B_PARAM_SUFFIX[] = ":B";
 constexpr char MOD_CONSTANT_PARAM_PREFX[]   = "Mod_Constant:";
 constexpr char MOD_MATRIX_PARAM_PREFIX[]    = "Mod_";
 
+// Static variables
+static MetricTiming _sushi_set_param_timing("sushi_set_param");
+static MetricTiming _sushi_get_patch_params_timing("sushi_get_patch_params");
+static MetricTiming _local_morph_timing("daw_local_morph");
+static Metric _morph_resync_changes("daw_morph_resync_changes_total", MetricType::COUNTER);
+
 //----------------------------------------------------------------------------
 // DawManager
 //----------------------------------------------------------------------------
 DawManager::DawManager(EventRouter *event_router) : 
-    BaseManager(MoniqueModule::DAW, MANAGER_NAME, event_router)
+    BaseManager(MoniqueModule::DAW, MANAGER_NAME, event_router, ExecutorPriority::HIGH_IPC)
 {
     std::vector<std::pair<int,int>> param_blocklist;
 
@@ -70,6 +79,9 @@ DawManager::DawManager(EventRouter *event_router) :
 //----------------------------------------------------------------------------
 DawManager::~DawManager()
 {
+    // Stop the note scheduler
+    _note_scheduler.stop();
+
     // Clean up the event listeners   
     if (_param_changed_listener)
         delete _param_changed_listener;
@@ -83,6 +95,11 @@ void DawManager::process()
     // Create and add the various event listeners
     _param_changed_listener = new EventListener(MoniqueModule::SYSTEM, EventType::PARAM_CHANGED, this);
     _event_router->register_event_listener(_param_changed_listener);
+
+    // Start the note scheduler, if enabled
+    if (utils::system_config()->get_note_scheduler()) {
+        _note_scheduler.start([this](const snd_seq_event_t &event) { _send_midi_event(event); });
+    }
     
     // Process all events
     BaseManager::process();
@@ -112,7 +129,31 @@ void DawManager::process_event(const BaseEvent *event)
 //----------------------------------------------------------------------------
 void DawManager::process_midi_event_direct(const snd_seq_event_t *event)
 {
-    auto data = *event;
+    // Send the event immediately
+    // Note: Notes sent directly (e.g. from the keyboard) never cancel the Sequencer or
+    // Arpeggiator notes still scheduled, these are only cancelled by a NOTE OFF that is
+    // also scheduled
+    _send_midi_event(*event);
+}
+
+//----------------------------------------------------------------------------
+// schedule_midi_event_direct
+//----------------------------------------------------------------------------
+void DawManager::schedule_midi_event_direct(const snd_seq_event_t *event, std::chrono::steady_clock::time_point time)
+{
+    // Schedule the event to be sent at the specified time, or if the note scheduler
+    // is not enabled send it immediately
+    if (!_note_scheduler.schedule(*event, time)) {
+        _send_midi_event(*event);
+    }
+}
+
+//----------------------------------------------------------------------------
+// _send_midi_event
+//----------------------------------------------------------------------------
+void DawManager::_send_midi_event(const snd_seq_event_t &event)
+{
+    auto data = event;
 
     // If the main track ID was found
     if (_main_track_id != -1) {
@@ -160,9 +201,11 @@ bool DawManager::get_layer_patch_state_params()
     auto param = utils::get_morph_value_param();
     if (param) {
         // Get the patch params
+        auto start = std::chrono::steady_clock::now();
         auto patch_params = _sushi_controller->parameter_controller()->get_parameter_values(param->processor_id(),
                                                         (utils::get_current_layer_info().layer_id() == LayerId::D0 ? 0 : 1),
                                                         (utils::get_current_layer_info().layer_state() == LayerState::STATE_A ? 0 : 1));
+        _sushi_get_patch_params_timing.record(std::chrono::steady_clock::now() - start);
         auto itr = patch_params.second.begin();
 
         // Parse the available DAW params
@@ -186,6 +229,51 @@ bool DawManager::get_layer_patch_state_params()
     return ret;
 }
 
+//----------------------------------------------------------------------------
+// morph_layer_patch_state_params
+//----------------------------------------------------------------------------
+bool DawManager::morph_layer_patch_state_params(bool morph_started)
+{
+    bool ret = false;
+
+    // Get the Morph Value param - morphing interpolates the state params from the
+    // state A to B values held locally, so there is no need to retrieve them
+    // from Sushi
+    auto param = utils::get_morph_value_param();
+    if (param) {
+        auto layer_id = utils::get_current_layer_info().layer_id();
+        auto layer_state = utils::get_current_layer_info().layer_state();
+
+        // If morphing has just started, snapshot the current state values, as these
+        // are overwritten with the morphed values (as done by Sushi)
+        auto start = std::chrono::steady_clock::now();
+        if (morph_started) {
+            ParamValueStore::Snapshot(layer_id, layer_state);
+        }
+
+        // Morph the current state params
+        ret = ParamValueStore::Morph(layer_id, layer_state, param->value());
+        _local_morph_timing.record(std::chrono::steady_clock::now() - start);
+    }
+    return ret;
+}
+
+//----------------------------------------------------------------------------
+// resync_layer_patch_state_params
+//----------------------------------------------------------------------------
+bool DawManager::resync_layer_patch_state_params()
+{
+    // Retrieve the state params from Sushi, so the final morphed values are
+    // exactly those in Sushi
+    // Note: Any param changed by this indicates the local morph differed from
+    // Sushi, so count these
+    bool ret = get_layer_patch_state_params();
+    if (ret) {
+        _morph_resync_changes.inc();
+    }
+    return ret;
+}
+
 //----------------------------------------------------------------------------
 // set_global_params
 //----------------------------------------------------------------------------
@@ -390,6 +478,10 @@ void DawManager::_param_update_notification(int processor_id, int parameter_id,
 //----------------------------------------------------------------------------
 void DawManager::_send_param(uint layer_id_mask, const Param *param)
 {
+    // Trace and time the send to Sushi
+    EventTraceScope trace_scope(MANAGER_NAME, "send_param");
+    auto start = std::chrono::steady_clock::now();
+
     // If this is a state param
     // Note: Assumes that the passed param is a DAW param, and the caller checks
     if ((param->type() == ParamType::GLOBAL) || (param->type() == ParamType::PRESET_COMMON)) {
@@ -411,6 +503,7 @@ void DawManager::_send_param(uint layer_id_mask, const Param *param)
                                                                         static_cast<const LayerParam *>(param)->value(LayerId::D1));
         }
     }
+    _sushi_set_param_timing.record(std::chrono::steady_clock::now() - start);
 }
 
 //----------------------------------------------------------------------------
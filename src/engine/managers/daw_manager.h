@@ -14,6 +14,7 @@
 #include "param.h"
 #include "event_router.h"
 #include "sushi_client.h"
+#include "note_scheduler.h"
 
 // Sushi version
 struct SushiVersion
@@ -36,7 +37,10 @@ public:
     void process();
     void process_event(const BaseEvent *event);
     void process_midi_event_direct(const snd_seq_event_t *event);
+    void schedule_midi_event_direct(const snd_seq_event_t *event, std::chrono::steady_clock::time_point time);
     bool get_layer_patch_state_params();
+    bool morph_layer_patch_state_params(bool morph_started);
+    bool resync_layer_patch_state_params();
     void set_global_params(std::vector<Param *> &params);
     void set_preset_common_params(std::vector<Param *> &params);
     void set_layer_params(std::vector<Param *> &params);
@@ -50,9 +54,11 @@ private:
     std::shared_ptr<sushi_controller::SushiController> _sushi_controller;
     int _main_track_id;
     SushiVersion _sushi_verson;
+    NoteScheduler _note_scheduler;
 
     // Private functions
     void _process_param_changed_event(const ParamChange &data);
+    void _send_midi_event(const snd_seq_event_t &event);
     void _param_update_notification(int processor_id, int parameter_id, float value);
     void _send_param(uint layer_id_mask, const Param *param);
     void _register_params();
@@ -18,6 +18,9 @@
 #include "sfc.h"
 #include "utils.h"
 #include "logger.h"
+#include "metrics.h"
+#include "string_pool.h"
+#include "param_value_store.h"
 
 // Preset versions - update these whenever the presets change
 constexpr char PRESET_VERSION[] = "0.1.0";
@@ -44,6 +47,7 @@ constexpr uint DEFAULT_DEMO_MODE_TIMEOUT                = std::chrono::seconds(3
 
 // Private static data
 rapidjson::Document _basic_preset_json_data;
+MetricTiming _file_save_timing("file_save");
 
 // Private static functions
 bool _open_preset_file(std::string file_path, rapidjson::Document &json_data); 
@@ -105,15 +109,15 @@ std::string FileManager::PresetLayerName(PresetId preset_id, LayerId layer_id)
 // FileManager
 //----------------------------------------------------------------------------
 FileManager::FileManager(EventRouter *event_router) : 
-    BaseManager(MoniqueModule::FILE_MANAGER, MANAGER_NAME, event_router)
+    BaseManager(MoniqueModule::FILE_MANAGER, MANAGER_NAME, event_router, ExecutorPriority::BACKGROUND)
 {
     // Initialise class data
     _param_changed_listener = nullptr;
     _system_func_listener = nullptr;
     _daw_manager = 0;
-    _save_config_file_timer = new Timer(TimerType::ONE_SHOT);
-    _save_global_params_file_timer = new Timer(TimerType::ONE_SHOT);
-    _save_preset_file_timer = new Timer(TimerType::ONE_SHOT);
+    _save_config_file_timer = new Timer(TimerType::ONE_SHOT, ExecutorPriority::BACKGROUND);
+    _save_global_params_file_timer = new Timer(TimerType::ONE_SHOT, ExecutorPriority::BACKGROUND);
+    _save_preset_file_timer = new Timer(TimerType::ONE_SHOT, ExecutorPriority::BACKGROUND);
 
     // Open the param blacklist file and parse it
     _open_and_parse_param_blacklist_file();
@@ -192,6 +196,21 @@ bool FileManager::start()
             MONIQUE_LOG_ERROR(module(), "An error occurred opening global params file: {}", MONIQUE_UDATA_FILE_PATH(GLOBAL_PARAMS_FILE));              
         }
 
+        // The param metadata is now set, so report the memory held by the pooled
+        // metadata, and that held if each param owned its own copy
+        // Note: The references are counted from the params themselves, so only
+        // the metadata each param finally holds is counted
+        auto pool_stats = StringPool::Stats();
+        StringPoolRefs pool_refs = {};
+        for (Param *p : utils::get_all_params()) {
+            p->count_pooled_refs(pool_refs);
+        }
+        auto pooled_bytes = pool_stats.pooled_bytes + pool_refs.ref_bytes;
+        MSG("Param metadata: " << pool_stats.num_strings << " strings, " << pool_stats.num_lists << " lists, " << pool_refs.num_refs << " refs, " <<
+            pooled_bytes << " bytes (" << pool_refs.unpooled_bytes << " bytes unpooled)");
+        MONIQUE_LOG_INFO(module(), "Param metadata: {} strings, {} lists, {} refs, {} bytes ({} bytes unpooled)",
+                         pool_stats.num_strings, pool_stats.num_lists, pool_refs.num_refs, pooled_bytes, pool_refs.unpooled_bytes);
+
         // Open and check the BASIC preset file
         if (!::_open_preset_file(MONIQUE_ROOT_FILE_PATH(BASIC_PRESET_FILE), ::_basic_preset_json_data) ||
             !_check_preset(::_basic_preset_json_data, _basic_preset_doc)) {
@@ -1255,17 +1274,22 @@ bool FileManager::_open_and_parse_param_attributes_file()
                             if (itr->GetObject().HasMember("value_strings") && itr->GetObject()["value_strings"].IsArray()) {
                                 // Parse each value string
                                 auto value_strings = itr->GetObject()["value_strings"].GetArray();
+                                std::vector<std::string> strings;
                                 for (auto& vs : value_strings) {
                                     // If a value string has been specified
                                     if (vs.HasMember("string") && vs["string"].IsString()) {
                                         // Add the Dvalue string
-                                        p->add_value_string(vs["string"].GetString());
+                                        strings.push_back(vs["string"].GetString());
                                     }                                      
                                 }
+
+                                // Add the value strings to the param
+                                p->add_value_strings(strings);
                             }
+                            std::vector<std::string> tags;
                             if (itr->GetObject().HasMember("value_tag") && itr->GetObject()["value_tag"].IsString()) {
                                 // Add the Value Tag
-                                p->add_value_tag(itr->GetObject()["value_tag"].GetString());
+                                tags.push_back(itr->GetObject()["value_tag"].GetString());
                             }                            
                             if (itr->GetObject().HasMember("value_tags") && itr->GetObject()["value_tags"].IsArray()) {
                                 // Parse each Value Tag
@@ -1274,10 +1298,14 @@ bool FileManager::_open_and_parse_param_attributes_file()
                                     // If a Value Tag has been specified
                                     if (vt.HasMember("string") && vt["string"].IsString()) {
                                         // Add the Value Tag
-                                        p->add_value_tag(vt["string"].GetString());
+                                        tags.push_back(vt["string"].GetString());
                                     }                                      
                                 }
-                            }                                                       
+                            }
+                            if (tags.size() > 0) {
+                                // Add the Value Tags to the param
+                                p->add_value_tags(tags);
+                            }
                         }                  
                         if (itr->GetObject().HasMember("display_as_numeric") && itr->GetObject()["display_as_numeric"].IsBool()) {
                             // Indicate the param should be displayed as a numeric param, even if it has values as strings
@@ -1315,19 +1343,19 @@ bool FileManager::_open_and_parse_param_attributes_file()
         auto param = utils::get_param(utils::ParamRef::FX_MACRO_SELECT);
         if (param) {
             // Populate this param with the FX Macro Params
-            uint count = 0;
+            std::vector<std::string> value_strings;
             for (uint pi : Monique::fx_macro_params()) {
                 // Get the DAW param
                 auto dp = utils::get_param(MoniqueModule::DAW, pi);
                 if (dp) {
                     // Add the param name as a value string
-                    param->add_value_string(dp->display_name());
-                    count++;
+                    value_strings.push_back(dp->display_name());
                 }
             }
+            param->add_value_strings(value_strings);
 
             // Set the number of positions for this param
-            param->set_position_param(count);
+            param->set_position_param(value_strings.size());
             param->set_display_enum_list(true);
         }
     }
@@ -1558,9 +1586,7 @@ void FileManager::_open_and_parse_system_colours_file()
             auto param = utils::get_param(MoniqueModule::SYSTEM, SystemParamId::SYSTEM_COLOUR_PARAM_ID);
             if (param) {
                 // Add the display strings and select the current system colour
-                for (std::string s : system_colour_names) {
-                    param->add_value_string(s);
-                }
+                param->add_value_strings(system_colour_names);
                 param->set_position_param(system_colour_names.size());
                 param->set_value_from_position(utils::system_config()->get_system_colour_index(), true);
             }            
@@ -2093,6 +2119,71 @@ void FileManager::_parse_config()
     }
     utils::system_config()->set_system_colour(system_colour);
 
+    // Has the Expression pedal filter config been specified?
+    // Note: This entry is optional, and any setting not specified (or out of range)
+    // keeps its default value
+    if (_config_json_data.HasMember("expression_pedal_filter") && _config_json_data["expression_pedal_filter"].IsObject())
+    {
+        auto filter_json = _config_json_data["expression_pedal_filter"].GetObject();
+        auto filter_config = utils::system_config()->get_expression_pedal_filter_config();
+        if (filter_json.HasMember("oversample") && filter_json["oversample"].IsUint() &&
+            (filter_json["oversample"].GetUint() > 0)) {
+            filter_config.oversample = filter_json["oversample"].GetUint();
+        }
+        if (filter_json.HasMember("smoothing_min") && filter_json["smoothing_min"].IsNumber() &&
+            (filter_json["smoothing_min"].GetFloat() > 0.0f) && (filter_json["smoothing_min"].GetFloat() <= 1.0f)) {
+            filter_config.smoothing_min = filter_json["smoothing_min"].GetFloat();
+        }
+        if (filter_json.HasMember("smoothing_max") && filter_json["smoothing_max"].IsNumber() &&
+            (filter_json["smoothing_max"].GetFloat() > 0.0f) && (filter_json["smoothing_max"].GetFloat() <= 1.0f)) {
+            filter_config.smoothing_max = filter_json["smoothing_max"].GetFloat();
+        }
+        if (filter_json.HasMember("fast_delta") && filter_json["fast_delta"].IsNumber() &&
+            (filter_json["fast_delta"].GetFloat() > 0.0f)) {
+            filter_config.fast_delta = filter_json["fast_delta"].GetFloat();
+        }
+        if (filter_json.HasMember("dead_band") && filter_json["dead_band"].IsNumber() &&
+            (filter_json["dead_band"].GetFloat() >= 0.0f)) {
+            filter_config.dead_band = filter_json["dead_band"].GetFloat();
+        }
+        if (filter_json.HasMember("min_publish_interval_ms") && filter_json["min_publish_interval_ms"].IsUint()) {
+            filter_config.min_publish_interval = std::chrono::milliseconds(filter_json["min_publish_interval_ms"].GetUint());
+        }
+
+        // Make sure the smoothing range is valid
+        if (filter_config.smoothing_min > filter_config.smoothing_max) {
+            filter_config.smoothing_min = filter_config.smoothing_max;
+        }
+        utils::system_config()->set_expression_pedal_filter_config(filter_config);
+    }
+
+    // Has the GUI Message Ring been enabled?
+    // Note: This entry is optional, as the ring requires a GUI app that supports it -
+    // if not specified the GUI messages are sent over the POSIX message queue
+    if (_config_json_data.HasMember("gui_msg_ring") && _config_json_data["gui_msg_ring"].IsBool())
+    {
+        // Enable/disable the GUI Message Ring
+        utils::system_config()->set_gui_msg_ring(_config_json_data["gui_msg_ring"].GetBool());
+    }
+
+    // Has the Note Scheduler been enabled?
+    // Note: This entry is optional - if not specified the Sequencer and Arpeggiator
+    // notes are sent immediately
+    if (_config_json_data.HasMember("note_scheduler") && _config_json_data["note_scheduler"].IsBool())
+    {
+        // Enable/disable the Note Scheduler
+        utils::system_config()->set_note_scheduler(_config_json_data["note_scheduler"].GetBool());
+    }
+
+    // Has the local dance mode morph been enabled?
+    // Note: This entry is optional - if not specified the morphed state params are
+    // retrieved from the DAW on every surface control poll while morphing
+    if (_config_json_data.HasMember("local_morph") && _config_json_data["local_morph"].IsBool())
+    {
+        // Enable/disable the local dance mode morph
+        utils::system_config()->set_local_morph(_config_json_data["local_morph"].GetBool());
+    }
+
     // Does the config file need saving?
     if (save_config_file) {
         _save_config_file();
@@ -2342,6 +2433,10 @@ void FileManager::_parse_param_map()
             }
         }
     }
+
+    // Now all the control states have been added, build the table of the
+    // params with each state
+    utils::build_control_states_table();
 }
 
 //----------------------------------------------------------------------------
@@ -2776,6 +2871,7 @@ void FileManager::_save_preset_file(std::string file_path)
 void FileManager::_save_json_file(std::string file_path, const rapidjson::Document &json_data)
 {
     char write_buffer[131072];
+    auto start = std::chrono::steady_clock::now();
 
     // Open the file for writing
     FILE *fp = ::fopen(file_path.c_str(), "w");
@@ -2794,6 +2890,7 @@ void FileManager::_save_json_file(std::string file_path, const rapidjson::Docume
     (void)json_data.Accept(writer);
     fclose(fp);
     sync();
+    _file_save_timing.record(std::chrono::steady_clock::now() - start);
 }
 
 //----------------------------------------------------------------------------
@@ -2897,6 +2994,8 @@ rapidjson::Value::ValueIterator FileManager::_find_preset_param(LayerId layer_id
 //----------------------------------------------------------------------------
 void FileManager::_update_patch_state_params(LayerState state)
 {
+    std::vector<uint> slots;
+
     // Parse the preset params
     auto params = utils::get_preset_params();
     for (Param *p : params) {        
@@ -2913,12 +3012,7 @@ void FileManager::_update_patch_state_params(LayerState state)
                     (p->data_type() == ParamDataType::FLOAT) ?
                         itr->GetObject()["value"].SetFloat(p->hr_value()) :
                         itr->GetObject()["str_value"].SetString(p->str_value(), _preset_json_data.GetAllocator());
-
-                    // If we are updating a param not in the current state, make sure the param is also updated
-                    if (utils::get_current_layer_info().layer_state() != state) {
-                        // Update the param in the other state
-                        static_cast<LayerStateParam *>(p)->set_state_value(utils::get_current_layer_info().layer_id(), state, p->value());
-                    }
+                    slots.push_back(static_cast<LayerStateParam *>(p)->value_slot());
                     param_missed = false;
                     break;
                 }
@@ -2932,15 +3026,18 @@ void FileManager::_update_patch_state_params(LayerState state)
                     obj.AddMember("value", p->hr_value(), _preset_json_data.GetAllocator()) :
                     obj.AddMember("str_value", p->str_value(), _preset_json_data.GetAllocator());
                 json_data.PushBack(obj, _preset_json_data.GetAllocator());
-
-                // If we are updating a param not in the current state, make sure the param is also updated
-                if (utils::get_current_layer_info().layer_state() != state) {
-                    // Update the param in the other state
-                    static_cast<LayerStateParam *>(p)->set_state_value(utils::get_current_layer_info().layer_id(), state, p->value());
-                }                
+                slots.push_back(static_cast<LayerStateParam *>(p)->value_slot());
             }
         }
     }
+
+    // If we are updating a state other than the current state, copy the current
+    // state values of the params in the patch to that state
+    // Note: This is a single copy of those slots in the value store, any param not in
+    // the patch keeps its value in that state
+    if (utils::get_current_layer_info().layer_state() != state) {
+        ParamValueStore::Copy(utils::get_current_layer_info().layer_id(), utils::get_current_layer_info().layer_state(), state, slots);
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -0,0 +1,113 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  gui_display_state.cpp
+ * @brief GUI Display State implementation.
+ *-----------------------------------------------------------------------------
+ */
+#include <cstring>
+#include "gui_display_state.h"
+
+//----------------------------------------------------------------------------
+// GuiDisplayState
+//----------------------------------------------------------------------------
+GuiDisplayState::GuiDisplayState()
+{
+    // Initialise class data
+    _gui_state = GuiState::INVALID;
+}
+
+//----------------------------------------------------------------------------
+// ~GuiDisplayState
+//----------------------------------------------------------------------------
+GuiDisplayState::~GuiDisplayState()
+{
+    // Nothing specific to do
+}
+
+//----------------------------------------------------------------------------
+// element
+//----------------------------------------------------------------------------
+GuiElement GuiDisplayState::element(const GuiMsg& msg)
+{
+    // The element key is the message type, and for messages that update only
+    // part of an element, which part
+    uint key = static_cast<uint>(msg.type) << 8;
+
+    // Parse the message type
+    switch (msg.type) {
+        case GuiMsgType::SET_SOFT_BUTTONS_STATE:
+            // Each soft button state is updated separately
+            key |= (msg.soft_buttons_state.button1_state != -1) ? 1 : 0;
+            key |= (msg.soft_buttons_state.button2_state != -1) ? 2 : 0;
+            return {GuiElementScope::SCREEN, key};
+
+        case GuiMsgType::SHOW_NORMAL_PARAM_UPDATE:
+        case GuiMsgType::SHOW_ENUM_PARAM_UPDATE_VALUE:
+        case GuiMsgType::SHOW_VCF_CUTOFF_PARAM_UPDATE:
+        case GuiMsgType::SHOW_ADSR_ENV_PARAM_UPDATE:
+        case GuiMsgType::LIST_SELECT_ITEM:
+        case GuiMsgType::EDIT_NAME_SELECT_CHAR:
+        case GuiMsgType::SET_SOFT_BUTTONS_TEXT:
+        case GuiMsgType::SELECT_LAYER_NAME:
+            // Updates to an element on the current screen
+            return {GuiElementScope::SCREEN, key};
+
+        case GuiMsgType::SET_LEFT_STATUS:
+        case GuiMsgType::SET_LAYER_STATUS:
+        case GuiMsgType::SET_TEMPO_STATUS:
+        case GuiMsgType::SET_SYSTEM_COLOUR:
+            // Updates to an element shown on every screen
+            return {GuiElementScope::GLOBAL, key};
+
+        default:
+            // Screen change
+            return {GuiElementScope::NONE, key};
+    }
+}
+
+//----------------------------------------------------------------------------
+// update
+//----------------------------------------------------------------------------
+bool GuiDisplayState::update(const GuiMsg& msg, GuiState gui_state)
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+
+    // A screen capture doesn't change what is shown
+    if (msg.type == GuiMsgType::SCREEN_CAPTURE) {
+        return true;
+    }
+
+    // If this is a screen change, or the GUI state has changed, nothing shown
+    // can be assumed to still be shown
+    // Note: This includes the status bar, as showing a screen may redraw it
+    auto element = GuiDisplayState::element(msg);
+    if ((element.scope == GuiElementScope::NONE) || (gui_state != _gui_state)) {
+        _elements.clear();
+        _gui_state = gui_state;
+        if (element.scope == GuiElementScope::NONE) {
+            return true;
+        }
+    }
+
+    // If the element is already showing this update, it doesn't need to be sent
+    auto itr = _elements.find(element.key);
+    if ((itr != _elements.end()) && (std::memcmp(&itr->second, &msg, sizeof(GuiMsg)) == 0)) {
+        return false;
+    }
+    _elements[element.key] = msg;
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// invalidate
+//----------------------------------------------------------------------------
+void GuiDisplayState::invalidate()
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+
+    // Nothing shown can be assumed to still be shown, so the next update to
+    // each element is always sent
+    _elements.clear();
+}
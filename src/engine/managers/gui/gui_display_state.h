@@ -0,0 +1,59 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  gui_display_state.h
+ * @brief GUI Display State class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _GUI_DISPLAY_STATE_H
+#define _GUI_DISPLAY_STATE_H
+
+#include <map>
+#include <mutex>
+#include "gui_msg.h"
+#include "gui_state.h"
+
+// GUI Element Scope
+enum class GuiElementScope
+{
+    NONE,
+    SCREEN,
+    GLOBAL
+};
+
+// GUI Element
+struct GuiElement
+{
+    GuiElementScope scope;
+    uint key;
+};
+
+// GUI Display State class
+// Retains what the GUI is currently showing, so that only the GUI messages that
+// change it need to be sent. Each message either shows a new screen, or updates
+// an element on the current screen (param value, list selection, soft buttons)
+// or on every screen (status bar). An element update is only sent if it differs
+// from what that element is currently showing
+class GuiDisplayState
+{
+public:
+    // Constructor
+    GuiDisplayState();
+
+    // Destructor
+    ~GuiDisplayState();
+
+    // Public functions
+    static GuiElement element(const GuiMsg& msg);
+    bool update(const GuiMsg& msg, GuiState gui_state);
+    void invalidate();
+
+private:
+    // Private variables
+    std::mutex _mutex;
+    GuiState _gui_state;
+    std::map<uint, GuiMsg> _elements;
+};
+
+#endif  // _GUI_DISPLAY_STATE_H
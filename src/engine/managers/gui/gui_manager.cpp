@@ -31,8 +31,6 @@
 #include "data_conversion.h"
 
 // Constants
-constexpr char GUI_MSG_QUEUE_NAME[]            = "/delia_msg_queue";
-constexpr uint GUI_MSG_QUEUE_SIZE              = 50;
 constexpr uint GUI_PARAM_CHANGE_SEND_POLL_TIME = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::milliseconds(17)).count();
 constexpr uint PARAM_CHANGED_SHOWN_THRESHOLD   = std::chrono::milliseconds(50).count();
 constexpr uint MAX_MOD_MATRIX_SRC              = 20;
@@ -69,30 +67,16 @@ const char *_knob_names[] = {
 GuiManager::GuiManager(EventRouter *event_router) : 
     BaseManager(MoniqueModule::GUI, "GuiManager", event_router)
 {
-    mq_attr attr;
-
-    // Open the GUI Message Queue
-    std::memset(&attr, 0, sizeof(attr));
-    attr.mq_maxmsg = GUI_MSG_QUEUE_SIZE;
-    attr.mq_msgsize = sizeof(GuiMsg);
-    _gui_mq_desc = ::mq_open(GUI_MSG_QUEUE_NAME, (O_CREAT|O_WRONLY|O_NONBLOCK),
-                             (S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH),
-                             &attr);
-    if (_gui_mq_desc == (mqd_t)-1)
-    {
-        // Error opening the GUI Message Queue
-        MSG("ERROR: Could not open the GUI Message Queue: " << errno);
-    }
-
     // Initialise class data
+    _gui_msg_dropped = 0;
     _sw_manager = nullptr;
     _param_changed_listener = 0;
     _system_func_listener = 0;
     _reload_presets_listener = 0;
     _midi_event_listener = 0;
-    _gui_param_change_send_timer = new Timer(TimerType::PERIODIC);
-    _param_change_timer = new Timer(TimerType::ONE_SHOT);
-    _demo_mode_timer = new Timer(TimerType::ONE_SHOT);
+    _gui_param_change_send_timer = new Timer(TimerType::PERIODIC, ExecutorPriority::NORMAL);
+    _param_change_timer = new Timer(TimerType::ONE_SHOT, ExecutorPriority::NORMAL);
+    _demo_mode_timer = new Timer(TimerType::ONE_SHOT, ExecutorPriority::NORMAL);
     _gui_state = GuiState::INVALID;
     _msd_event_thread = nullptr;
     _run_msd_event_thread = false;
@@ -195,13 +179,10 @@ GuiManager::~GuiManager()
         _msd_event_thread = 0;       
     }
 
-    // Is the GUI Message Queue open?
-    if (_gui_mq_desc != (mqd_t)-1)
-    {
-        // Close the GUI Message Queue - don't unlink, this is done by the GUI app
-        ::mq_close(_gui_mq_desc);
-        _gui_mq_desc = (mqd_t)-1;
-    }
+    // Close the GUI Message Transport
+    _gui_msg_queue.set_transport(nullptr);
+    _gui_msg_mqueue.close();
+    _gui_msg_ring.close();
 
     // Clean up the event listeners
     if (_param_changed_listener)
@@ -222,6 +203,33 @@ bool GuiManager::start()
     // Get the Software Manager
     _sw_manager = static_cast<SwManager *>(utils::get_manager(MoniqueModule::SOFTWARE));
 
+    // Open the GUI Message Transport
+    // Note: The GUI Message Ring is only used if enabled in the config, as it requires
+    // a GUI app that supports it - otherwise the POSIX message queue is used
+    if (utils::system_config()->get_gui_msg_ring())
+    {
+        // Create the GUI Message Ring
+        if (_gui_msg_ring.create())
+        {
+            _gui_msg_queue.set_transport(&_gui_msg_ring);
+        }
+        else
+        {
+            // Error creating the GUI Message Ring, fall back to the GUI Message Queue
+            MSG("ERROR: Could not create the GUI Message Ring: " << errno);
+        }
+    }
+    if (!_gui_msg_ring.is_open())
+    {
+        // Open the GUI Message Queue
+        if (!_gui_msg_mqueue.open())
+        {
+            // Error opening the GUI Message Queue
+            MSG("ERROR: Could not open the GUI Message Queue: " << errno);
+        }
+        _gui_msg_queue.set_transport(&_gui_msg_mqueue);
+    }
+
 	// Start the GUI param change  send timer periodic thread
 	_gui_param_change_send_timer->start(GUI_PARAM_CHANGE_SEND_POLL_TIME, std::bind(&GuiManager::_gui_param_change_send_callback, this));
 
@@ -229,25 +237,34 @@ bool GuiManager::start()
     _process_reload_presets(nullptr);
 
     // Get the Mod Matrix param source and destination names
-    uint index = 0;
     auto params = utils::get_mod_matrix_params();
     for (LayerStateParam *p : params) {
         // Is this source name already in the list of names?
-        if (std::find(_mod_matrix_src_names.begin(), _mod_matrix_src_names.end(), p->mod_src_name()) == _mod_matrix_src_names.end()) {
-            if (index < MAX_MOD_MATRIX_SRC) {
+        if (_mod_matrix_src_indexes.count(p->mod_src_name()) == 0) {
+            if (_mod_matrix_src_names.size() < MAX_MOD_MATRIX_SRC) {
                 // Add the Mod Matrix source name
+                _mod_matrix_src_indexes[p->mod_src_name()] = _mod_matrix_src_names.size();
                 _mod_matrix_src_names.push_back(p->mod_src_name());
-                index++;
             }
         }
 
         // Is this destination name already in the list of names?
-        if (std::find(_mod_matrix_dst_names.begin(), _mod_matrix_dst_names.end(), p->mod_dst_name()) == _mod_matrix_dst_names.end()) {
+        if (_mod_matrix_dst_indexes.count(p->mod_dst_name()) == 0) {
             // Add the Mod Matrix destination name
+            _mod_matrix_dst_indexes[p->mod_dst_name()] = _mod_matrix_dst_names.size();
             _mod_matrix_dst_names.push_back(p->mod_dst_name());
         }
     }
 
+    // Get the Mod Matrix param for each source and destination, so they don't need
+    // to be looked up by path when navigating the Mod Matrix
+    _mod_matrix_params.resize(_mod_matrix_src_names.size());
+    for (uint src=0; src<_mod_matrix_src_names.size(); src++) {
+        for (uint dst=0; dst<_mod_matrix_dst_names.size(); dst++) {
+            _mod_matrix_params[src].push_back(utils::get_param(_mod_matrix_param_path(src, dst)));
+        }
+    }
+
     // All ok, call the base manager
     return BaseManager::start();
 }
@@ -1236,7 +1253,7 @@ void GuiManager::_process_mod(const SystemFunc& sys_func)
         auto param = utils::get_param(MoniqueModule::SYSTEM, SystemParamId::CUTOFF_LINK_PARAM_ID);
         if (param) {
             // Set the linked param state
-            auto lp = utils::get_param(_mod_matrix_param_path(_selected_mod_matrix_src_index, (uint)Monique::ModMatrixDst::FILTER_CUTOFF_HP));
+            auto lp = _mod_matrix_param(_selected_mod_matrix_src_index, (uint)Monique::ModMatrixDst::FILTER_CUTOFF_HP);
             lp->enable_linked_param(param->value() ? true : false);
         }
     }
@@ -1600,7 +1617,7 @@ void GuiManager::_process_vcf_cutoff_link(const SystemFunc& sys_func)
         // the Mod Matrix state)
         sys_func.linked_param->enable_linked_param(sys_func.value ? true : false);
         if (_gui_state == GuiState::MOD_MATRIX) {
-            auto lp = utils::get_param(_mod_matrix_param_path(_selected_mod_matrix_src_index, (uint)Monique::ModMatrixDst::FILTER_CUTOFF_HP));
+            auto lp = _mod_matrix_param(_selected_mod_matrix_src_index, (uint)Monique::ModMatrixDst::FILTER_CUTOFF_HP);
             lp->enable_linked_param(sys_func.value ? true : false);
         }
 
@@ -2341,7 +2358,7 @@ void GuiManager::_process_mod_matrix_multifn_switch(uint switch_index)
         auto param = utils::get_param(MoniqueModule::SYSTEM, SystemParamId::CUTOFF_LINK_PARAM_ID);
         if (param) {
             // Set the linked param state
-            auto lp = utils::get_param(_mod_matrix_param_path(_selected_mod_matrix_src_index, (uint)Monique::ModMatrixDst::FILTER_CUTOFF_HP));
+            auto lp = _mod_matrix_param(_selected_mod_matrix_src_index, (uint)Monique::ModMatrixDst::FILTER_CUTOFF_HP);
             lp->enable_linked_param(param->value() ? true : false);
         }
 
@@ -9,16 +9,20 @@
 #ifndef _GUI_MANAGER_H
 #define _GUI_MANAGER_H
 
-#include <mqueue.h>
 #include <fstream>
 #include <map>
+#include <unordered_set>
 #include "base_manager.h"
 #include "daw_manager.h"
 #include "sw_manager.h"
 #include "event.h"
 #include "event_router.h"
 #include "param.h"
+#include "gui_display_state.h"
 #include "gui_msg.h"
+#include "gui_msg_mqueue.h"
+#include "gui_msg_queue.h"
+#include "gui_msg_ring.h"
 #include "gui_state.h"
 #include "timer.h"
 #include "utils.h"
@@ -57,9 +61,14 @@ private:
     Timer *_gui_param_change_send_timer;
     Timer *_param_change_timer;
     Timer *_demo_mode_timer;
-    mqd_t _gui_mq_desc;
+    GuiMsgMqueue _gui_msg_mqueue;
+    GuiMsgRing _gui_msg_ring;
+    GuiMsgQueue _gui_msg_queue;
+    uint64_t _gui_msg_dropped;
     std::mutex _gui_mutex;      
+    std::mutex _gui_msg_mutex;
     GuiState _gui_state;
+    GuiDisplayState _gui_display_state;
     std::thread *_msd_event_thread;
     bool _run_msd_event_thread;
     int _selected_bank_index;
@@ -84,6 +93,9 @@ private:
     std::chrono::_V2::steady_clock::time_point _param_shown_start_time{};
     std::vector<std::string> _mod_matrix_src_names;
     std::vector<std::string> _mod_matrix_dst_names;
+    std::map<std::string, uint> _mod_matrix_src_indexes;
+    std::map<std::string, uint> _mod_matrix_dst_indexes;
+    std::vector<std::vector<Param *>> _mod_matrix_params;
     bool _new_mod_matrix_param_list;
     int _selected_mod_matrix_src_index;
     SystemMenuState _system_menu_state;
@@ -312,6 +324,7 @@ private:
     void _set_mod_matrix_state(Monique::ModMatrixSrc state);
     bool _is_main_mod_matrix_param(Param *param);
     std::string _mod_matrix_param_path(uint _src_index, uint _dst_index);
+    Param *_mod_matrix_param(uint src_index, uint dst_index);
     bool _mod_matrix_param_enabled(const Param *param);
     std::string _get_edit_name_from_index(uint index);
     int _index_from_list_items(uint key);
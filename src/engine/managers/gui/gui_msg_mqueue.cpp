@@ -0,0 +1,88 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  gui_msg_mqueue.cpp
+ * @brief GUI Message Queue (POSIX) transport implementation.
+ *-----------------------------------------------------------------------------
+ */
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "gui_msg_mqueue.h"
+#include "ui_common.h"
+
+//----------------------------------------------------------------------------
+// GuiMsgMqueue
+//----------------------------------------------------------------------------
+GuiMsgMqueue::GuiMsgMqueue()
+{
+    // Initialise class data
+    _mq_desc = (mqd_t)-1;
+}
+
+//----------------------------------------------------------------------------
+// ~GuiMsgMqueue
+//----------------------------------------------------------------------------
+GuiMsgMqueue::~GuiMsgMqueue()
+{
+    // Close the message queue if open
+    close();
+}
+
+//----------------------------------------------------------------------------
+// open
+//----------------------------------------------------------------------------
+bool GuiMsgMqueue::open()
+{
+    mq_attr attr;
+
+    // Open the GUI Message Queue
+    std::memset(&attr, 0, sizeof(attr));
+    attr.mq_maxmsg = GUI_MSG_MQUEUE_SIZE;
+    attr.mq_msgsize = sizeof(GuiMsg);
+    _mq_desc = ::mq_open(GUI_MSG_MQUEUE_NAME, (O_CREAT|O_WRONLY|O_NONBLOCK),
+                         (S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH),
+                         &attr);
+    return _mq_desc != (mqd_t)-1;
+}
+
+//----------------------------------------------------------------------------
+// close
+//----------------------------------------------------------------------------
+void GuiMsgMqueue::close()
+{
+    // Is the GUI Message Queue open?
+    if (_mq_desc != (mqd_t)-1) {
+        // Close the GUI Message Queue - don't unlink, this is done by the GUI app
+        ::mq_close(_mq_desc);
+        _mq_desc = (mqd_t)-1;
+    }
+}
+
+//----------------------------------------------------------------------------
+// is_open
+//----------------------------------------------------------------------------
+bool GuiMsgMqueue::is_open() const
+{
+    return _mq_desc != (mqd_t)-1;
+}
+
+//----------------------------------------------------------------------------
+// send
+//----------------------------------------------------------------------------
+bool GuiMsgMqueue::send(const GuiMsg& msg)
+{
+    // Write the message to the GUI Message Queue
+    if (::mq_send(_mq_desc, (const char *)&msg, sizeof(msg), 0) == -1) {
+        // If the queue is full, the message can be sent later
+        if (errno == EAGAIN) {
+            return false;
+        }
+
+        // Any other error cannot be recovered by sending again, so the message
+        // is discarded
+        MSG("ERROR: Sending GUI Message: " << errno);
+    }
+    return true;
+}
@@ -0,0 +1,42 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  gui_msg_mqueue.h
+ * @brief GUI Message Queue (POSIX) transport class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _GUI_MSG_MQUEUE_H
+#define _GUI_MSG_MQUEUE_H
+
+#include <mqueue.h>
+#include "gui_msg_transport.h"
+
+// Constants
+constexpr char GUI_MSG_MQUEUE_NAME[] = "/delia_msg_queue";
+constexpr uint GUI_MSG_MQUEUE_SIZE   = 50;
+
+// GUI Message Mqueue class
+// Sends the GUI messages over the POSIX message queue read by the GUI app. This
+// is the default transport, as it is the one all GUI app versions support
+class GuiMsgMqueue : public GuiMsgTransport
+{
+public:
+    // Constructor
+    GuiMsgMqueue();
+
+    // Destructor
+    ~GuiMsgMqueue();
+
+    // Public functions
+    bool open();
+    void close();
+    bool is_open() const;
+    bool send(const GuiMsg& msg);
+
+private:
+    // Private variables
+    mqd_t _mq_desc;
+};
+
+#endif  // _GUI_MSG_MQUEUE_H
@@ -0,0 +1,206 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  gui_msg_queue.cpp
+ * @brief GUI Message Queue implementation.
+ *-----------------------------------------------------------------------------
+ */
+#include <algorithm>
+#include "gui_msg_queue.h"
+
+// Constants
+constexpr uint GUI_MSG_QUEUE_MAX_STAGED = 1024;
+
+//----------------------------------------------------------------------------
+// GuiMsgQueue
+//----------------------------------------------------------------------------
+GuiMsgQueue::GuiMsgQueue()
+{
+    // Initialise class data
+    _transport = nullptr;
+    _stats = {};
+}
+
+//----------------------------------------------------------------------------
+// ~GuiMsgQueue
+//----------------------------------------------------------------------------
+GuiMsgQueue::~GuiMsgQueue()
+{
+    // Nothing specific to do
+}
+
+//----------------------------------------------------------------------------
+// set_transport
+//----------------------------------------------------------------------------
+void GuiMsgQueue::set_transport(GuiMsgTransport *transport)
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+
+    // Set the transport the staged messages are sent to
+    _transport = transport;
+}
+
+//----------------------------------------------------------------------------
+// post
+//----------------------------------------------------------------------------
+void GuiMsgQueue::post(const GuiMsg& msg)
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+
+    // If the GUI Message Transport is not open, there is nothing to send to
+    if (!_transport || !_transport->is_open()) {
+        return;
+    }
+    _stats.posted++;
+
+    // Is this an update to a screen element?
+    auto element = GuiDisplayState::element(msg);
+    if (element.scope != GuiElementScope::NONE) {
+        // If there is an update to this element that has not been sent yet, replace it
+        auto itr = _pending_elements.find(element.key);
+        if (itr != _pending_elements.end()) {
+            itr->second->msg = msg;
+            _stats.coalesced++;
+        }
+        else {
+            // Stage the update
+            _staged.push_back({msg, element, false});
+            _pending_elements[element.key] = std::prev(_staged.end());
+        }
+    }
+    else {
+        // This is a screen change (or screen capture) - the new screen replaces the
+        // screen changes and current screen element updates that have not been sent yet
+        if (msg.type != GuiMsgType::SCREEN_CAPTURE) {
+            _supersede_staged_msgs();
+        }
+
+        // Stage the screen change
+        _staged.push_back({msg, element, false});
+    }
+
+    // If the queue has overflowed, drop the oldest screen capture
+    // Note: Only screen captures can build up in the queue, everything else staged is
+    // replaced by a later update or screen change
+    if (_staged.size() > GUI_MSG_QUEUE_MAX_STAGED) {
+        auto itr = std::find_if(_staged.begin(), _staged.end(), [](const StagedMsg& m) { return m.msg.type == GuiMsgType::SCREEN_CAPTURE; });
+        if (itr != _staged.end()) {
+            _erase_staged_msg(itr);
+            _stats.dropped++;
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// flush
+//----------------------------------------------------------------------------
+bool GuiMsgQueue::flush()
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+
+    // Send the screen changes first
+    // Note: Any element update staged before a screen change is for an element
+    // shown on every screen (the others have been superseded), so it can be sent
+    // after the screen change
+    bool sent = true;
+    for (auto itr = _staged.begin(); sent && (itr != _staged.end());) {
+        auto next = std::next(itr);
+        if (itr->element.scope == GuiElementScope::NONE) {
+            sent = _send_staged_msg(itr);
+        }
+        itr = next;
+    }
+
+    // Send the element updates in order, until the transport is full
+    while (sent && !_staged.empty()) {
+        sent = _send_staged_msg(_staged.begin());
+    }
+
+    // If the transport is full, keep the remaining messages to send later
+    if (!sent) {
+        _defer_staged_msgs();
+    }
+
+    // Return if there are still messages to send
+    return !_staged.empty();
+}
+
+//----------------------------------------------------------------------------
+// stats
+//----------------------------------------------------------------------------
+GuiMsgQueueStats GuiMsgQueue::stats()
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    return _stats;
+}
+
+//----------------------------------------------------------------------------
+// _send_staged_msg
+//----------------------------------------------------------------------------
+bool GuiMsgQueue::_send_staged_msg(std::list<StagedMsg>::iterator itr)
+{
+    // Send the message, and if sent remove it from the queue
+    if (!_transport || !_transport->is_open() || !_transport->send(itr->msg)) {
+        return false;
+    }
+    _erase_staged_msg(itr);
+    _stats.sent++;
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// _defer_staged_msgs
+//----------------------------------------------------------------------------
+void GuiMsgQueue::_defer_staged_msgs()
+{
+    // Count each staged message the first time its send is deferred
+    // Note: Messages are staged at the back of the queue, and every staged message
+    // is deferred when the transport is full, so the messages not yet deferred are
+    // always at the back of the queue
+    for (auto itr = _staged.rbegin(); (itr != _staged.rend()) && !itr->deferred; ++itr) {
+        itr->deferred = true;
+        _stats.deferred++;
+    }
+}
+
+//----------------------------------------------------------------------------
+// _supersede_staged_msgs
+//----------------------------------------------------------------------------
+void GuiMsgQueue::_supersede_staged_msgs()
+{
+    bool screen_captured = false;
+
+    // Remove the staged current screen element updates, and the staged screen changes
+    // since the last screen capture - the new screen replaces them
+    // Note: Screen changes before a screen capture are kept, so that the capture shows
+    // the screen it was requested for. Element updates shown on every screen are kept,
+    // and can still be replaced by a later update
+    for (auto itr = _staged.end(); itr != _staged.begin();) {
+        auto prev = std::prev(itr);
+        if ((prev->element.scope == GuiElementScope::SCREEN) ||
+            ((prev->element.scope == GuiElementScope::NONE) && (prev->msg.type != GuiMsgType::SCREEN_CAPTURE) && !screen_captured)) {
+            _erase_staged_msg(prev);
+            _stats.coalesced++;
+        }
+        else {
+            screen_captured |= (prev->msg.type == GuiMsgType::SCREEN_CAPTURE);
+            itr = prev;
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// _erase_staged_msg
+//----------------------------------------------------------------------------
+void GuiMsgQueue::_erase_staged_msg(std::list<StagedMsg>::iterator itr)
+{
+    // If this is a pending element update, it can no longer be replaced
+    if (itr->element.scope != GuiElementScope::NONE) {
+        auto pending = _pending_elements.find(itr->element.key);
+        if ((pending != _pending_elements.end()) && (pending->second == itr)) {
+            _pending_elements.erase(pending);
+        }
+    }
+    _staged.erase(itr);
+}
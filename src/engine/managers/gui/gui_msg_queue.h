@@ -0,0 +1,76 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  gui_msg_queue.h
+ * @brief GUI Message Queue class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _GUI_MSG_QUEUE_H
+#define _GUI_MSG_QUEUE_H
+
+#include <list>
+#include <map>
+#include <mutex>
+#include "gui_display_state.h"
+#include "gui_msg.h"
+#include "gui_msg_transport.h"
+
+// GUI Message Queue Stats
+struct GuiMsgQueueStats
+{
+    uint64_t posted;
+    uint64_t sent;
+    uint64_t coalesced;
+    uint64_t dropped;
+    uint64_t deferred;
+};
+
+// GUI Message Queue class
+// Stages the GUI messages before they are sent to the GUI Message Transport. Updates
+// to a screen element (see GuiDisplayState) replace any update to the same element
+// that has not been sent yet, and messages that cannot be sent because the transport
+// is full are kept and sent later, so the latest state is always delivered. A screen
+// change replaces any screen change and current screen element updates that have not
+// been sent yet, as the GUI only needs to show the latest screen. Screen changes are
+// sent ahead of any element updates staged before them. As a result the queue only
+// grows with screen captures, and if it overflows the oldest screen capture is dropped
+class GuiMsgQueue
+{
+public:
+    // Constructor
+    GuiMsgQueue();
+
+    // Destructor
+    ~GuiMsgQueue();
+
+    // Public functions
+    void set_transport(GuiMsgTransport *transport);
+    void post(const GuiMsg& msg);
+    bool flush();
+    GuiMsgQueueStats stats();
+
+private:
+    // Staged Message
+    struct StagedMsg
+    {
+        GuiMsg msg;
+        GuiElement element;
+        bool deferred;
+    };
+
+    // Private variables
+    std::mutex _mutex;
+    GuiMsgTransport *_transport;
+    std::list<StagedMsg> _staged;
+    std::map<uint, std::list<StagedMsg>::iterator> _pending_elements;
+    GuiMsgQueueStats _stats;
+
+    // Private functions
+    bool _send_staged_msg(std::list<StagedMsg>::iterator itr);
+    void _defer_staged_msgs();
+    void _supersede_staged_msgs();
+    void _erase_staged_msg(std::list<StagedMsg>::iterator itr);
+};
+
+#endif  // _GUI_MSG_QUEUE_H
@@ -0,0 +1,270 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  gui_msg_ring.cpp
+ * @brief GUI Message Ring implementation.
+ *-----------------------------------------------------------------------------
+ */
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "gui_msg_ring.h"
+#include "ui_common.h"
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "GUI Message Ring requires lock-free 64-bit atomics");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "GUI Message Ring requires lock-free 32-bit atomics");
+
+//----------------------------------------------------------------------------
+// GuiMsgRing
+//----------------------------------------------------------------------------
+GuiMsgRing::GuiMsgRing()
+{
+    // Initialise class data
+    _shm = nullptr;
+    _created = false;
+    _next_seq = 0;
+}
+
+//----------------------------------------------------------------------------
+// ~GuiMsgRing
+//----------------------------------------------------------------------------
+GuiMsgRing::~GuiMsgRing()
+{
+    // Close the ring if open
+    close();
+}
+
+//----------------------------------------------------------------------------
+// create
+//----------------------------------------------------------------------------
+bool GuiMsgRing::create()
+{
+    // Create (or open) the GUI Message Ring shared memory
+    // Note: Only the owner and group (the GUI app) can access the ring
+    int fd = ::shm_open(GUI_MSG_RING_NAME, (O_CREAT|O_RDWR),
+                        (S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP));
+    if (fd == -1) {
+        return false;
+    }
+    if (::ftruncate(fd, sizeof(GuiMsgRingShm)) == -1) {
+        ::close(fd);
+        ::shm_unlink(GUI_MSG_RING_NAME);
+        return false;
+    }
+    if (!_map(fd)) {
+        ::shm_unlink(GUI_MSG_RING_NAME);
+        return false;
+    }
+    _created = true;
+
+    // Initialise the ring - any messages left from a previous run are discarded
+    _shm->magic = 0;
+    _shm->version = GUI_MSG_RING_VERSION;
+    _shm->size = GUI_MSG_RING_SIZE;
+    _shm->msg_size = sizeof(GuiMsg);
+    _shm->write_pos.store(0);
+    _shm->read_pos.store(0);
+    _shm->reader_waiting.store(0);
+    _shm->dropped.store(0);
+    _next_seq = 0;
+    std::atomic_thread_fence(std::memory_order_release);
+    _shm->magic = GUI_MSG_RING_MAGIC;
+
+    // Wake the reader in case it was waiting on a previous run of the ring
+    _wake_reader();
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// open
+//----------------------------------------------------------------------------
+bool GuiMsgRing::open()
+{
+    // Open the existing GUI Message Ring shared memory
+    int fd = ::shm_open(GUI_MSG_RING_NAME, O_RDWR, 0);
+    if (fd == -1) {
+        return false;
+    }
+    if (!_map(fd)) {
+        return false;
+    }
+
+    // Check the ring has been initialised with a matching layout
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if ((_shm->magic != GUI_MSG_RING_MAGIC) || (_shm->version != GUI_MSG_RING_VERSION) ||
+        (_shm->size != GUI_MSG_RING_SIZE) || (_shm->msg_size != sizeof(GuiMsg))) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// close
+//----------------------------------------------------------------------------
+void GuiMsgRing::close()
+{
+    // Unmap the shared memory
+    if (_shm) {
+        ::munmap(_shm, sizeof(GuiMsgRingShm));
+        _shm = nullptr;
+    }
+
+    // If the ring was created here, unlink it - the GUI app keeps its mapping
+    // (if any) until it closes the ring
+    if (_created) {
+        ::shm_unlink(GUI_MSG_RING_NAME);
+        _created = false;
+    }
+}
+
+//----------------------------------------------------------------------------
+// is_open
+//----------------------------------------------------------------------------
+bool GuiMsgRing::is_open() const
+{
+    return _shm != nullptr;
+}
+
+//----------------------------------------------------------------------------
+// post
+//----------------------------------------------------------------------------
+bool GuiMsgRing::post(const GuiMsg& msg)
+{
+    // Get the post mutex - the ring has a single producer, so posts from multiple
+    // threads must be serialised
+    std::lock_guard<std::mutex> lock(_post_mutex);
+
+    // Each message is given a sequence number, even if dropped
+    uint64_t seq = _next_seq++;
+    if (!_shm) {
+        return false;
+    }
+
+    // If the ring is full, drop the message
+    uint64_t write_pos = _shm->write_pos.load(std::memory_order_relaxed);
+    if ((write_pos - _shm->read_pos.load(std::memory_order_acquire)) >= GUI_MSG_RING_SIZE) {
+        _shm->dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Write the message to its slot and publish it
+    auto& slot = _shm->slots[write_pos % GUI_MSG_RING_SIZE];
+    slot.seq = seq;
+    std::memcpy(&slot.msg, &msg, sizeof(GuiMsg));
+    _shm->write_pos.store(write_pos + 1);
+
+    // Only wake the reader if it is waiting
+    if (_shm->reader_waiting.load()) {
+        _wake_reader();
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// send
+//----------------------------------------------------------------------------
+bool GuiMsgRing::send(const GuiMsg& msg)
+{
+    // If the ring is full, don't post (and drop) the message, so that it can be
+    // sent later
+    if (full()) {
+        return false;
+    }
+    post(msg);
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// read
+//----------------------------------------------------------------------------
+bool GuiMsgRing::read(GuiMsg& msg, uint64_t& seq)
+{
+    // Note: Only called by the single consumer
+
+    // Is there a message to read?
+    if (!_shm) {
+        return false;
+    }
+    uint64_t read_pos = _shm->read_pos.load(std::memory_order_relaxed);
+    if (read_pos == _shm->write_pos.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    // Read the message from its slot and release the slot
+    auto& slot = _shm->slots[read_pos % GUI_MSG_RING_SIZE];
+    seq = slot.seq;
+    std::memcpy(&msg, &slot.msg, sizeof(GuiMsg));
+    _shm->read_pos.store(read_pos + 1, std::memory_order_release);
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// wait
+//----------------------------------------------------------------------------
+bool GuiMsgRing::wait(uint timeout_ms)
+{
+    // Note: Only called by the single consumer
+    if (!_shm) {
+        return false;
+    }
+
+    // Indicate the reader is waiting, and check again for messages before
+    // waiting on the doorbell - so that a message posted in between is not missed
+    _shm->reader_waiting.store(1);
+    uint32_t doorbell = _shm->doorbell.load();
+    if (_shm->read_pos.load() == _shm->write_pos.load()) {
+        struct timespec timeout = {(time_t)(timeout_ms / 1000), (long)((timeout_ms % 1000) * 1000000)};
+        ::syscall(SYS_futex, &_shm->doorbell, FUTEX_WAIT, doorbell, &timeout, nullptr, 0);
+    }
+    _shm->reader_waiting.store(0);
+    return _shm->read_pos.load() != _shm->write_pos.load();
+}
+
+//----------------------------------------------------------------------------
+// full
+//----------------------------------------------------------------------------
+bool GuiMsgRing::full() const
+{
+    // Check if a posted message would be dropped because the ring is full
+    return _shm && ((_shm->write_pos.load(std::memory_order_relaxed) - _shm->read_pos.load(std::memory_order_acquire)) >= GUI_MSG_RING_SIZE);
+}
+
+//----------------------------------------------------------------------------
+// dropped
+//----------------------------------------------------------------------------
+uint64_t GuiMsgRing::dropped() const
+{
+    return _shm ? _shm->dropped.load(std::memory_order_relaxed) : 0;
+}
+
+//----------------------------------------------------------------------------
+// _map
+//----------------------------------------------------------------------------
+bool GuiMsgRing::_map(int fd)
+{
+    // Map the shared memory, the file descriptor is no longer needed once mapped
+    void *shm = ::mmap(nullptr, sizeof(GuiMsgRingShm), (PROT_READ|PROT_WRITE), MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (shm == MAP_FAILED) {
+        return false;
+    }
+    _shm = static_cast<GuiMsgRingShm *>(shm);
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// _wake_reader
+//----------------------------------------------------------------------------
+void GuiMsgRing::_wake_reader()
+{
+    // Ring the doorbell and wake the reader
+    _shm->doorbell.fetch_add(1);
+    ::syscall(SYS_futex, &_shm->doorbell, FUTEX_WAKE, 1, nullptr, nullptr, 0);
+}
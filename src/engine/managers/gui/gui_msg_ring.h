@@ -0,0 +1,91 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  gui_msg_ring.h
+ * @brief GUI Message Ring class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _GUI_MSG_RING_H
+#define _GUI_MSG_RING_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include "gui_msg.h"
+#include "gui_msg_transport.h"
+
+// Constants
+constexpr char GUI_MSG_RING_NAME[]      = "/delia_gui_msg_ring";
+constexpr uint32_t GUI_MSG_RING_MAGIC   = 0x444D5247;
+constexpr uint32_t GUI_MSG_RING_VERSION = 1;
+constexpr uint GUI_MSG_RING_SIZE        = 256;
+
+// GUI Message Ring Slot
+struct GuiMsgRingSlot
+{
+    uint64_t seq;
+    GuiMsg msg;
+};
+
+// GUI Message Ring shared memory layout
+// Note: This layout is shared with the GUI app, the version must be incremented
+// if it is changed
+struct GuiMsgRingShm
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+    uint32_t msg_size;
+    alignas(64) std::atomic<uint64_t> write_pos;
+    alignas(64) std::atomic<uint64_t> read_pos;
+    alignas(64) std::atomic<uint32_t> doorbell;
+    std::atomic<uint32_t> reader_waiting;
+    std::atomic<uint64_t> dropped;
+    GuiMsgRingSlot slots[GUI_MSG_RING_SIZE];
+};
+
+// GUI Message Ring class
+// Single producer (UI app), single consumer (GUI app) ring of GUI messages in
+// shared memory. Posts from multiple UI app threads are serialised by the post
+// mutex, so the UI app acts as the single producer. Each message is given a
+// sequence number, including messages dropped because the ring is full, so the
+// reader can detect gaps. The reader is only woken (via a futex) if it is
+// waiting, so many messages can be read per wakeup
+// Note: The ring is only used if enabled in the config file, as it requires a
+// GUI app that reads from it (GuiMsgRing::open/wait/read) - otherwise the GUI
+// messages are sent over the POSIX message queue (GuiMsgMqueue)
+class GuiMsgRing : public GuiMsgTransport
+{
+public:
+    // Constructor
+    GuiMsgRing();
+
+    // Destructor
+    ~GuiMsgRing();
+
+    // Public functions
+    bool create();
+    bool open();
+    void close();
+    bool is_open() const;
+    bool full() const;
+    bool post(const GuiMsg& msg);
+    bool send(const GuiMsg& msg);
+    bool read(GuiMsg& msg, uint64_t& seq);
+    bool wait(uint timeout_ms);
+    uint64_t dropped() const;
+
+private:
+    // Private variables
+    GuiMsgRingShm *_shm;
+    bool _created;
+    std::mutex _post_mutex;
+    uint64_t _next_seq;
+
+    // Private functions
+    bool _map(int fd);
+    void _wake_reader();
+};
+
+#endif  // _GUI_MSG_RING_H
@@ -0,0 +1,28 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  gui_msg_transport.h
+ * @brief GUI Message Transport class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _GUI_MSG_TRANSPORT_H
+#define _GUI_MSG_TRANSPORT_H
+
+#include "gui_msg.h"
+
+// GUI Message Transport class (virtual)
+// Sends the GUI messages to the GUI app. If a message cannot be sent because the
+// transport is full it is not sent, and the caller can send it again later
+class GuiMsgTransport
+{
+public:
+    // Destructor
+    virtual ~GuiMsgTransport() = default;
+
+    // Public functions
+    virtual bool is_open() const = 0;
+    virtual bool send(const GuiMsg& msg) = 0;
+};
+
+#endif  // _GUI_MSG_TRANSPORT_H
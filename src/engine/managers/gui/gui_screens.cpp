@@ -114,13 +114,12 @@ void GuiManager::_show_mod_matrix_src_screen()
     Param *param = nullptr;
 
     // Get the first mod matrix source dest entry
-    std::string param_path = !_showing_additional_mod_dst_params ?
-                                    _mod_matrix_param_path(_selected_mod_matrix_src_index, 
-                                                           (_selected_mod_matrix_src_index == (int)Monique::ModMatrixSrc::OSC_1 ? 
-                                                                (uint)Monique::ModMatrixDst::OSC_2_PITCH :
-                                                                (uint)Monique::ModMatrixDst::OSC_1_PITCH)) :
-                                    _mod_matrix_param_path(_selected_mod_matrix_src_index, (uint)Monique::ModMatrixDst::PAN);
-    param = utils::get_param(param_path);
+    param = !_showing_additional_mod_dst_params ?
+                _mod_matrix_param(_selected_mod_matrix_src_index, 
+                                  (_selected_mod_matrix_src_index == (int)Monique::ModMatrixSrc::OSC_1 ? 
+                                        (uint)Monique::ModMatrixDst::OSC_2_PITCH :
+                                        (uint)Monique::ModMatrixDst::OSC_1_PITCH)) :
+                _mod_matrix_param(_selected_mod_matrix_src_index, (uint)Monique::ModMatrixDst::PAN);
     if (param) {
         // This param will become the root param - get the index
         // of this param in the param list
@@ -760,7 +759,7 @@ void GuiManager::_show_mod_matrix_param()
     uint num_items = 0;
     msg.show_normal_param.selected_item = 0;
     bool found = false;
-    auto params_list_cpy = _params_list;
+    std::unordered_set<const Param *> prev_params_list(_params_list.begin(), _params_list.end());
     _params_list.clear();
     for (auto p : _param_shown_root->param_list()) {
         // If we are showing a new list
@@ -790,28 +789,25 @@ void GuiManager::_show_mod_matrix_param()
         else {
             // Not showing a new list, so we need to process the previous list first
             bool shown = false;
-            for (const Param *sp : params_list_cpy) {
-                // If the param is in the previous list
-                if (p == sp) {
-                    // Indicate this param is shown and add it to the display list
-                    // If the value is disabled but we always show it, show it disabled in the list
-                    shown = true;
-                    _strcpy_to_gui_msg(msg.show_normal_param.list_items[num_items], p->display_name());
-                    msg.show_normal_param.list_item_enabled[num_items] = _mod_matrix_param_enabled(p);
-                    _params_list.push_back(p); 
-                                        
-                    // If this param is the param to show
-                    if (p == _param_shown) {
-                        // Indicate it is found and set the selected item - always show the selected
-                        // item as enabled
-                        found = true;
-                        msg.show_normal_param.list_item_enabled[num_items] = true;
-                        msg.show_normal_param.selected_item = num_items;
-                    }
-                    num_items++;
-                    break;
+            // If the param is in the previous list
+            if (prev_params_list.count(p) > 0) {
+                // Indicate this param is shown and add it to the display list
+                // If the value is disabled but we always show it, show it disabled in the list
+                shown = true;
+                _strcpy_to_gui_msg(msg.show_normal_param.list_items[num_items], p->display_name());
+                msg.show_normal_param.list_item_enabled[num_items] = _mod_matrix_param_enabled(p);
+                _params_list.push_back(p); 
+                                    
+                // If this param is the param to show
+                if (p == _param_shown) {
+                    // Indicate it is found and set the selected item - always show the selected
+                    // item as enabled
+                    found = true;
+                    msg.show_normal_param.list_item_enabled[num_items] = true;
+                    msg.show_normal_param.selected_item = num_items;
                 }
-            }           
+                num_items++;
+            }
             // If this param did not already exist in the previous list
             if (!shown) {
                 // If this is the param to show
@@ -1583,10 +1579,10 @@ void GuiManager::_show_calibrate_screen(CalMode mode)
     auto ret = static_cast<SwManager *>(utils::get_manager(MoniqueModule::SOFTWARE))->run_calibration_script(mode);
     MSG(cal_type_str + " script: " << ((ret == 0) ? "COMPLETE" : "FAILED"));
     if (ret == 0) {
-        MONIQUE_LOG_INFO(module(), cal_type_str + " script: COMPLETE");
+        MONIQUE_LOG_INFO(module(), "{} script: COMPLETE", cal_type_str);
     }
     else {
-        MONIQUE_LOG_ERROR(module(), cal_type_str + " script: FAILED");
+        MONIQUE_LOG_ERROR(module(), "{} script: FAILED", cal_type_str);
     }
 
     // Show a confirmation popup
@@ -23,6 +23,8 @@
 #include <sys/reboot.h>
 #include "gui_manager.h"
 #include "seq_manager.h"
+#include "event_trace.h"
+#include "metrics.h"
 #include "logger.h"
 #include "utils.h"
 
@@ -30,6 +32,13 @@
 constexpr uint PARAM_SHORT_CHANGE_TIMER_TIMEOUT = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::milliseconds(3000)).count();
 constexpr uint PARAM_MORPH_CHANGE_TIMER_TIMEOUT = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::milliseconds(6000)).count();
 
+// Static variables
+static Metric _gui_msgs_posted("gui_msgs_total{stage=\"posted\"}", MetricType::COUNTER);
+static Metric _gui_msgs_sent("gui_msgs_total{stage=\"sent\"}", MetricType::COUNTER);
+static Metric _gui_msgs_coalesced("gui_msgs_total{stage=\"coalesced\"}", MetricType::COUNTER);
+static Metric _gui_msgs_dropped("gui_msgs_total{stage=\"dropped\"}", MetricType::COUNTER);
+static Metric _gui_msgs_deferred("gui_msgs_total{stage=\"deferred\"}", MetricType::COUNTER);
+
 //----------------------------------------------------------------------------
 // _reset_gui_state_and_show_home_screen
 //----------------------------------------------------------------------------
@@ -369,15 +378,22 @@ void GuiManager::_post_update_selected_list_item(uint selected_item)
 //----------------------------------------------------------------------------
 void GuiManager::_post_gui_msg(const GuiMsg &msg)
 {
-    // If the GUI Message Queue is valid
-    if (_gui_mq_desc != (mqd_t)-1)
-    {
-        // Write the message to the GUI Message Queue
-        if (::mq_send(_gui_mq_desc, (char *)&msg, sizeof(msg), 0) == -1)
-        {
-            // An error occured
-            MSG("ERROR: Sending GUI Message: " << errno);
-        }
+    // Trace the send to the GUI
+    EventTraceScope trace_scope(name(), "post_gui_msg");
+
+    // Get the GUI message mutex
+    // Note: Messages are posted from the manager and timer threads, not all of which
+    // hold the GUI mutex, so the display state update and the post must be done under
+    // this mutex to keep the display state in the order the messages are staged
+    std::lock_guard<std::mutex> msg_guard(_gui_msg_mutex);
+
+    // Only send the message if it changes what the GUI is currently showing
+    if (_gui_display_state.update(msg, _gui_state)) {
+        // Stage the message and send it to the GUI Message Transport
+        // Note: Updates to the same screen element are coalesced, and any messages that
+        // cannot be sent because the transport is full are sent from the param change callback
+        _gui_msg_queue.post(msg);
+        _gui_msg_queue.flush();
     }
 }
 
@@ -402,7 +418,30 @@ void GuiManager::_gui_param_change_send_callback()
             _show_param_update(true);
         }
         _param_change_available = false;
-    }  
+    }
+
+    // Send any GUI messages still staged
+    _gui_msg_queue.flush();
+
+    // Update the GUI message metrics
+    auto stats = _gui_msg_queue.stats();
+    _gui_msgs_posted.set(stats.posted);
+    _gui_msgs_sent.set(stats.sent);
+    _gui_msgs_coalesced.set(stats.coalesced);
+    _gui_msgs_dropped.set(stats.dropped);
+    _gui_msgs_deferred.set(stats.deferred);
+
+    // Log if any GUI messages have been dropped since last checked
+    if (stats.dropped > _gui_msg_dropped) {
+        MONIQUE_LOG_WARNING(module(), "GUI messages dropped: {} (posted {}, sent {}, coalesced {}, deferred {})",
+                            stats.dropped, stats.posted, stats.sent, stats.coalesced, stats.deferred);
+        _gui_msg_dropped = stats.dropped;
+
+        // The GUI may not be showing what was last sent, so make sure the next update
+        // to each element is sent
+        std::lock_guard<std::mutex> msg_guard(_gui_msg_mutex);
+        _gui_display_state.invalidate();
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -418,21 +457,9 @@ int GuiManager::_get_root_param_list_index(const Param *param)
 //----------------------------------------------------------------------------
 int GuiManager::_get_param_list_index(const Param *root_param, const Param *param)
 {
-    int ret = -1;
-
-    // If the root param has actually been specified
-    if (root_param) {
-        // Check if the param in the root param list
-        uint index = 0;
-        for (const Param *p : root_param->param_list()) {
-            if (p->cmp_path(param->path())) {
-                ret = index;
-                break;
-            }
-            index++;
-        }
-    }
-    return ret;
+    // If the root param has actually been specified, return the index of the param
+    // in the root param list
+    return root_param ? root_param->param_list_index(param) : -1;
 }
 
 //----------------------------------------------------------------------------
@@ -1021,11 +1048,10 @@ bool GuiManager::_is_main_mod_matrix_param(Param *param)
     int index = -1;
 
     // Get the first mod matrix source dest entry
-    std::string param_path = _mod_matrix_param_path(_selected_mod_matrix_src_index, 
-                                                    (_selected_mod_matrix_src_index == (int)Monique::ModMatrixSrc::OSC_1 ? 
-                                                        (uint)Monique::ModMatrixDst::OSC_2_PITCH :
-                                                        (uint)Monique::ModMatrixDst::OSC_1_PITCH));
-    auto rp = utils::get_param(param_path);
+    auto rp = _mod_matrix_param(_selected_mod_matrix_src_index, 
+                                (_selected_mod_matrix_src_index == (int)Monique::ModMatrixSrc::OSC_1 ? 
+                                    (uint)Monique::ModMatrixDst::OSC_2_PITCH :
+                                    (uint)Monique::ModMatrixDst::OSC_1_PITCH));
     if (rp) {
         // This param will become the root param - get the index
         // of this param in the param list
@@ -1045,6 +1071,18 @@ std::string GuiManager::_mod_matrix_param_path(uint _src_index, uint _dst_index)
                               std::regex{" "}, "_");
 }
 
+//----------------------------------------------------------------------------
+// _mod_matrix_param
+//----------------------------------------------------------------------------
+Param *GuiManager::_mod_matrix_param(uint src_index, uint dst_index)
+{
+    // Return the Mod Matrix param for this source and destination, if any
+    if ((src_index < _mod_matrix_params.size()) && (dst_index < _mod_matrix_params[src_index].size())) {
+        return _mod_matrix_params[src_index][dst_index];
+    }
+    return nullptr;
+}
+
 //----------------------------------------------------------------------------
 // _mod_matrix_param_enabled
 //----------------------------------------------------------------------------
@@ -20,6 +20,8 @@
 #include "arp_manager.h"
 #include "data_conversion.h"
 #include "logger.h"
+#include "metrics.h"
+#include "thread_config.h"
 #include "utils.h"
 
 // Constants
@@ -45,6 +47,14 @@ constexpr uint MIDI_EVENT_QUEUE_RESERVE_SIZE = 200;
 constexpr uint MAX_TEMPO_DURATION            = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::milliseconds(60000/5)).count();
 constexpr uint KBD_BASE_NOTE                 = 36;
 
+// Static variables
+// Note: Indexed by the MIDI event source
+static Metric _midi_rx_events[] = {
+    {"midi_rx_events_total{source=\"internal\"}", MetricType::COUNTER},
+    {"midi_rx_events_total{source=\"ext_usb\"}", MetricType::COUNTER},
+    {"midi_rx_events_total{source=\"ext_serial\"}", MetricType::COUNTER}
+};
+
 // Static functions
 static void *_process_midi_devices(void* data);
 static void *_process_midi_event(void* data);
@@ -93,7 +103,7 @@ bool MidiDeviceManager::IsMidiChanpressParamPath(std::string param_name)
 // MidiDeviceManager
 //----------------------------------------------------------------------------
 MidiDeviceManager::MidiDeviceManager(EventRouter *event_router) : 
-    BaseManager(MoniqueModule::MIDI_DEVICE, "MidiDeviceManager", event_router)
+    BaseManager(MoniqueModule::MIDI_DEVICE, "MidiDeviceManager", event_router, ExecutorPriority::HIGH)
 {
     // Initialise class data
     _sfc_param_changed_listener = nullptr;
@@ -113,7 +123,7 @@ MidiDeviceManager::MidiDeviceManager(EventRouter *event_router) :
     _midi_event_queue_thread = 0;
     _run_midi_event_queue_thread = true;    
     _bank_select_index = -1;
-    _midi_clk_timer = new Timer(TimerType::PERIODIC);
+    _midi_clk_timer = new Timer(TimerType::PERIODIC, "midi_clock");
     _midi_clock_count = 0;
     _tempo_filter_state = 0;
     _tempo_param = nullptr;
@@ -208,14 +218,18 @@ bool MidiDeviceManager::start()
     }
 
     // Create a normal thread to poll for MIDI devices
-    if (_seq_handle)
+    if (_seq_handle) {
         _midi_devices_thread = new std::thread(_process_midi_devices, this);
+        ThreadConfig::Apply(_midi_devices_thread->native_handle(), "midi_devices");
+    }
 
     // Create a normal thread to listen for MIDI events
     _midi_event_thread = new std::thread(_process_midi_event, this);
+    ThreadConfig::Apply(_midi_event_thread->native_handle(), "midi_event");
 
     // Create a normal thread to listen for MIDI queue events
     _midi_event_queue_thread = new std::thread(_process_midi_queue_event, this);
+    ThreadConfig::Apply(_midi_event_queue_thread->native_handle(), "midi_queue");
 
     // Start the MIDI clock timer thread
     _midi_clk_timer->start((US_PER_MINUTE / (_tempo_param->hr_value() * PPQN)), std::bind(&MidiDeviceManager::_midi_clk_timer_callback, this));
@@ -670,6 +684,7 @@ void MidiDeviceManager::process_midi_event()
                             // process the message, which will be processed on the next poll
                             if (ev.type != SND_SEQ_EVENT_NONE) {
                                 bool push_msg = true;
+                                _midi_rx_events[MidiEventSource::INTERNAL].inc();
 
                                 // Is this a high priority MIDI event?
                                 // We process these immediately, and not via the MIDI event queue
@@ -726,6 +741,7 @@ void MidiDeviceManager::process_midi_event()
                 // Process all sequencer (USB) MIDI events (if any)
                 while (snd_seq_event_input(_seq_handle, &ev) > 0) {
                     bool push_msg = true;
+                    _midi_rx_events[MidiEventSource::EXT_USB].inc();
 
                     // Is this a high priority MIDI event?
                     // We process these immediately, and not via the MIDI event queue
@@ -783,6 +799,7 @@ void MidiDeviceManager::process_midi_event()
                             // process the message, which will be processed on the next poll
                             if (ev.type != SND_SEQ_EVENT_NONE) {
                                 bool push_msg;
+                                _midi_rx_events[MidiEventSource::EXT_SERIAL].inc();
 
                                 // Optimise MIDI messages in the external serial events queue
                                 push_msg = _optimise_midi_message(ext_serial_midi_events, ev);
@@ -16,13 +16,27 @@
 #include "ain.h"
 #include "utils.h"
 #include "logger.h"
+#include "metrics.h"
+#include "thread_config.h"
+#include "ain_filter.h"
+#include "event_trace.h"
 
 // Constants
 constexpr char GPIO_DEV_NAME[]           = "/dev/gpiochip0";
 constexpr uint SUSTAIN_PEDAL_GPIO        = 26;
 constexpr auto GPIO_POLL_TIMEOUT_MS      = 500;
-constexpr auto ANALOG_PEDAL_POLL_TIME_MS = std::chrono::milliseconds(30);
+// Note: The analog pedal thread waits for each new AIN1 sample from the AIN sampler
+// (it does not itself read the ADC) - the timeout only allows the thread to be stopped
+constexpr auto ANALOG_PEDAL_TIMEOUT_MS   = std::chrono::milliseconds(100);
 constexpr uint SEND_SUSTAIN_DEBOUNCE_MS  = std::chrono::milliseconds(10).count();
+constexpr uint SUSTAIN_PEDAL_DEBOUNCE_US = std::chrono::microseconds(10000).count();
+constexpr char SUSTAIN_PEDAL_CONSUMER[]  = "delia_ui_sustain";
+
+// Static variables
+static Metric _expression_pedal_raw_updates("pedal_expression_updates_total{stage=\"raw\"}", MetricType::COUNTER);
+static Metric _expression_pedal_published_updates("pedal_expression_updates_total{stage=\"published\"}", MetricType::COUNTER);
+static Metric _expression_pedal_skipped_samples("pedal_expression_skipped_samples_total", MetricType::COUNTER);
+static MetricTiming _sustain_pedal_latency("pedal_sustain_latency");
 
 // Static functions
 static void *_process_digtial_pedal_event(void* data);
@@ -32,7 +46,7 @@ static void *_process_analog_pedal_event(void* data);
 // PedalsManager
 //----------------------------------------------------------------------------
 PedalsManager::PedalsManager(EventRouter *event_router) : 
-    BaseManager(MoniqueModule::PEDALS, "PedalsManager", event_router)
+    BaseManager(MoniqueModule::PEDALS, "PedalsManager", event_router, ExecutorPriority::HIGH)
 {
     // Initialise class data
     _gui_param_changed_listener = nullptr;
@@ -43,7 +57,7 @@ PedalsManager::PedalsManager(EventRouter *event_router) :
     _run_digtial_pedal_thread = true;
     _run_analog_pedal_thread = true;
     _sustain = 0.0;
-    _send_sustain_timer = new Timer(TimerType::ONE_SHOT);
+    _send_sustain_timer = new Timer(TimerType::ONE_SHOT, ExecutorPriority::HIGH);
 }
 
 //----------------------------------------------------------------------------
@@ -113,10 +127,12 @@ bool PedalsManager::start()
     }
 
     // Create a normal thread to listen for digital (Sustain) pedal events
-    _digital_pedal_thread = new std::thread(_process_digtial_pedal_event, this);    
+    _digital_pedal_thread = new std::thread(_process_digtial_pedal_event, this);
+    ThreadConfig::Apply(_digital_pedal_thread->native_handle(), "pedal_digital");
 
     // Create a normal thread to listen for analog (Expression) pedal events
-    _analog_pedal_thread = new std::thread(_process_analog_pedal_event, this);    
+    _analog_pedal_thread = new std::thread(_process_analog_pedal_event, this);
+    ThreadConfig::Apply(_analog_pedal_thread->native_handle(), "pedal_analog");
 
     // Call the base manager
     return BaseManager::start();		
@@ -198,6 +214,90 @@ void PedalsManager::process_event(const BaseEvent * event)
 // process_digtial_pedal_event
 //----------------------------------------------------------------------------
 void PedalsManager::process_digtial_pedal_event()
+{
+    // Process the Sustain pedal events using the GPIO v2 uAPI (with kernel debounce)
+    // if available, otherwise fall back to the v1 uAPI
+    if (!_process_digital_pedal_v2_events()) {
+        _process_digital_pedal_v1_events();
+    }
+}
+
+//----------------------------------------------------------------------------
+// _process_digital_pedal_v2_events
+//----------------------------------------------------------------------------
+bool PedalsManager::_process_digital_pedal_v2_events()
+{
+#ifdef GPIO_V2_GET_LINE_IOCTL
+    struct pollfd pfd;
+    struct gpio_v2_line_request sustain_line_req = {};
+    struct gpio_v2_line_event event_data;
+
+    // Request the Sustain pedal line, with events on both edges, debounced by the
+    // kernel
+    // Note: The event timestamps use the monotonic clock (the default)
+    sustain_line_req.offsets[0] = SUSTAIN_PEDAL_GPIO;
+    sustain_line_req.num_lines = 1;
+    std::strncpy(sustain_line_req.consumer, SUSTAIN_PEDAL_CONSUMER, sizeof(sustain_line_req.consumer) - 1);
+    sustain_line_req.config.flags = GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_EDGE_RISING | GPIO_V2_LINE_FLAG_EDGE_FALLING;
+    sustain_line_req.config.num_attrs = 1;
+    sustain_line_req.config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_DEBOUNCE;
+    sustain_line_req.config.attrs[0].attr.debounce_period_us = SUSTAIN_PEDAL_DEBOUNCE_US;
+    sustain_line_req.config.attrs[0].mask = 1;
+    if (::ioctl(_gpio_chip_handle, GPIO_V2_GET_LINE_IOCTL, &sustain_line_req) < 0) {
+        // The GPIO v2 uAPI is not supported by this kernel
+        DEBUG_BASEMGR_MSG("Could not request the GPIO v2 line, using the v1 uAPI: " << errno);
+        return false;
+    }
+
+    // Set the GPIO poll descriptor
+    pfd.fd = sustain_line_req.fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    // Do forever (until the thread is exited)
+    while (_run_digtial_pedal_thread) {
+        // Wait for a GPIO event, or a timeout
+        if ((poll(&pfd, 1, GPIO_POLL_TIMEOUT_MS) > 0) && ((pfd.revents & POLLIN) == POLLIN)) {
+            // Read the event
+            auto ret = ::read(sustain_line_req.fd, &event_data, sizeof(event_data));
+            if (ret == sizeof(event_data)) {
+                // Get the value as a rising edge (0) or falling edge (1), and the
+                // Sustain value
+                float value = event_data.id == GPIO_V2_LINE_EVENT_RISING_EDGE ? 0.0 : 1.0;
+                float sustain = (_sustain_polarity == SustainPolarity::POSITIVE ?
+                                    value :
+                                    (value == 0.0 ? 1.0 : 0.0));
+
+                // The edge has already been debounced by the kernel, so send the
+                // Sustain now if it has changed
+                if (sustain != _sustain) {
+                    EventTraceContext trace_context(EventTrace::NewId());
+                    _sustain = sustain;
+                    _send_sustain();
+
+                    // Record the latency from the (kernel timestamped) edge to the
+                    // Sustain being sent
+                    auto now_ns = EventTrace::Now();
+                    _sustain_pedal_latency.record(std::chrono::nanoseconds(now_ns - event_data.timestamp_ns));
+                    if (EventTrace::Recording()) {
+                        EventTrace::Record(name(), "sustain_edge", EventTrace::CurrentId(), event_data.timestamp_ns, now_ns);
+                    }
+                }
+            }
+        }
+    }
+    ::close(sustain_line_req.fd);
+    return true;
+#else
+    // The GPIO v2 uAPI is not available in the kernel headers
+    return false;
+#endif
+}
+
+//----------------------------------------------------------------------------
+// _process_digital_pedal_v1_events
+//----------------------------------------------------------------------------
+void PedalsManager::_process_digital_pedal_v1_events()
 {
     struct pollfd pfd;
     struct gpioevent_request sustain_event_req;
@@ -250,15 +350,29 @@ void PedalsManager::process_digtial_pedal_event()
 //----------------------------------------------------------------------------
 void PedalsManager::process_analog_pedal_event()
 {
+    // Get the Expression pedal filter config (loaded from the config file)
+    AinFilter filter(utils::system_config()->get_expression_pedal_filter_config());
+    ain::AinSample sample;
+    uint32_t sample_seq = 0;
     float value;
 
     // Do forever (until the thread is exited)
     while (_run_analog_pedal_thread) {
-        // Wait the poll time
-        std::this_thread::sleep_for(ANALOG_PEDAL_POLL_TIME_MS);
+        // Wait for the next AIN1 sample
+        if (!ain::wait_ain1(sample, sample_seq, ANALOG_PEDAL_TIMEOUT_MS)) {
+            continue;
+        }
+
+        // Count any samples stored while the previous sample was being processed - only
+        // the latest sample is kept, so these are skipped
+        if (sample_seq && ((sample.seq - sample_seq) > 1)) {
+            _expression_pedal_skipped_samples.inc(sample.seq - sample_seq - 1);
+        }
+        sample_seq = sample.seq;
+        _expression_pedal_raw_updates.inc();
 
-        // Read the value from AIN1
-        if (ain::read_ain1(value)) {
+        // Filter the value, and only process it if it should be published
+        if (filter.process(sample.normalised_value, std::chrono::steady_clock::now(), value)) {
             // Get the Expression param and check if the value has changed
             auto param = get_param(utils::ParamRef::MIDI_EXPRESSION);
             if (param && (param->value() != value)) {
@@ -274,6 +388,7 @@ void PedalsManager::process_analog_pedal_event()
                     param_change.layer_id_mask = layer_id_mask;
                     param_change.display = false;
                     _event_router->post_param_changed_event(new ParamChangedEvent(param_change));
+                    _expression_pedal_published_updates.inc();
                 }
             }
         }    
@@ -47,6 +47,8 @@ private:
     uint _kdb_midi_channel;
 
     // Private functions
+    bool _process_digital_pedal_v2_events();
+    void _process_digital_pedal_v1_events();
     void _process_param_changed_event(const ParamChange &param_change);
     void _send_sustain();
     uint _get_layer_id_mask(unsigned char channel);
@@ -11,6 +11,8 @@
 #include "seq_manager.h"
 #include "daw_manager.h"
 #include "utils.h"
+#include "thread_config.h"
+#include "phrase_seq_chunk.h"
 
 // Constants
 constexpr char MODE_PARAM_NAME[]                   = "mode";
@@ -34,18 +36,22 @@ constexpr unsigned char TIE_STEP                   = 0x40;
 constexpr unsigned char TIE_END_STEP               = 0x20;
 constexpr unsigned char REST_STEP                  = 0x10;
 constexpr unsigned char STEP_ATTR_MASK             = (TIE_START_STEP+TIE_STEP+TIE_END_STEP+REST_STEP);
-constexpr uint PHRASE_LOOPER_MAX_EVENTS            = 2000;
-constexpr uint CHUNK_MAX_NOTES                     = 10;
-constexpr uint MAX_CHUNKS                          = ((PHRASE_LOOPER_MAX_EVENTS) / CHUNK_MAX_NOTES) + 1;
+constexpr uint PHRASE_LOOPER_MAX_EVENTS            = 20000;
+constexpr uint MAX_CHUNKS                          = ((PHRASE_LOOPER_MAX_EVENTS) / phrase_seq_chunk::CHUNK_MAX_EVENTS) + 1;
+constexpr uint PREV_MAX_CHUNKS                     = (2000 / 10) + 1;
 constexpr unsigned char MAX_MIDI_NOTE              = 108;
-constexpr uint MIDI_MAX_NOTE                       = 127;
-constexpr uint END_OF_PHRASE_INDICATOR             = 0xFE;
+constexpr auto PHRASE_SEQ_SAVE_DEBOUNCE            = std::chrono::milliseconds(250);
+
+// Note: There must be at least as many chunk params as there were with the previous
+// 10 event chunks, so that a phrase saved with those chunks can still be loaded
+static_assert(MAX_CHUNKS >= PREV_MAX_CHUNKS);
 
 //----------------------------------------------------------------------------
 // SeqManager
 //----------------------------------------------------------------------------
 SeqManager::SeqManager(EventRouter *event_router) : 
-    BaseManager(MoniqueModule::SEQ, "SeqManager", event_router)
+    BaseManager(MoniqueModule::SEQ, "SeqManager", event_router, ExecutorPriority::HIGH),
+    _phrase_seq(PHRASE_LOOPER_MAX_EVENTS, [this](PhraseSeqEvent& event, const PhraseSeqEvent *note_on_event) { _quantise_phrase_seq_event(event, note_on_event); })
 {
     // Initialise class data
     _param_changed_listener = 0;
@@ -65,9 +71,8 @@ SeqManager::SeqManager(EventRouter *event_router) :
     _step_seq_state = StepSeqState::IDLE;
     _looper_seq_state = LooperSeqState::IDLE;
     _tempo_note_value = common::TempoNoteValue::QUARTER;
-    _tempo_pulse_count = utils::tempo_pulse_count(_tempo_note_value);
-    _note_duration_pulse_count = _tempo_pulse_count >> 1;
-    _phrase_qnt_pulse_count = _tempo_pulse_count * PPQN_CLOCK_PULSES_PER_MIDI_CLOCK;
+    _pulse_counter.set_tempo_pulse_count(utils::tempo_pulse_count(_tempo_note_value));
+    _phrase_qnt_pulse_count = _pulse_counter.tempo_pulse_count() * PPQN_CLOCK_PULSES_PER_MIDI_CLOCK;
     _num_steps = 0;
     _num_active_steps = 0;
     _num_selected_steps = 0;
@@ -78,18 +83,21 @@ SeqManager::SeqManager(EventRouter *event_router) :
     _preset_base_note = 0xFF;
     _step_note_index = 0;
     _reset_seq_steps();
-    _phrase_seq_events_itr = _phrase_seq_events.begin();
     _ticks = 0;
     _end_of_phrase_ticks = 0;
     _clock_pulse_count = 0;
     _overdub = false;
-    _overdub_started = false;
     _phrase_metronome_accent_pulse_count = 0;
     _phrase_metronome_accent_pulses = 0;
     _midi_clk_in_param = nullptr;
+    _save_phrase_seq_running = true;
     _save_phrase_seq = false;
+    _save_phrase_seq_full = false;
+    _phrase_seq_full_save = true;
+    _phrase_seq_saved_size = 0;
     _round_to_bar = false;
     _round_bar_count = 4;
+    _send_time = NOTE_SCHEDULER_SEND_NOW;
     
     // Register the Sequencer params
     _register_params();
@@ -120,8 +128,14 @@ SeqManager::~SeqManager()
 	}
 
     // Stop the save phrase sequence thread
+    // Note: Any pending save is completed before the thread exits
+	{
+		std::lock_guard<std::mutex> lk(_save_phrase_seq_mutex);
+		_save_phrase_seq_running = false;
+	}
+	_save_phrase_seq_cv.notify_one();
     if (_save_phrase_seq_thread) {
-		// Wait for the tempo event thread to finish and delete it
+		// Wait for the save phrase sequence thread to finish and delete it
 		if (_save_phrase_seq_thread->joinable())
 			_save_phrase_seq_thread->join();
 		delete _save_phrase_seq_thread;
@@ -150,9 +164,11 @@ bool SeqManager::start()
 
 	// Start the tempo event thread
 	_tempo_event_thread = new std::thread(&SeqManager::_process_tempo_event, this);
+	ThreadConfig::Apply(_tempo_event_thread->native_handle(), "seq_tempo");
 
 	// Start the save phrase sequence thread
 	_save_phrase_seq_thread = new std::thread(&SeqManager::_process_save_phrase_seq_event, this);
+	ThreadConfig::Apply(_save_phrase_seq_thread->native_handle(), "seq_save");
 
     // Call the base manager
     return BaseManager::start();			
@@ -317,7 +333,7 @@ void SeqManager::process_midi_event_direct(const snd_seq_event_t *event)
             }
 
             // Forward the MIDI event note
-            _send_note(seq_event);
+            _forward_note(seq_event);
         }
         // Is the Sequencer on and has steps?
         else if (_run && _num_steps)
@@ -378,7 +394,7 @@ void SeqManager::process_midi_event_direct(const snd_seq_event_t *event)
             }
                     
             // Forward the MIDI event note
-            _send_note(seq_event);
+            _forward_note(seq_event);
         }
     }
     else {
@@ -387,10 +403,10 @@ void SeqManager::process_midi_event_direct(const snd_seq_event_t *event)
             // If this is a note event
             if ((seq_event.type == snd_seq_event_type::SND_SEQ_EVENT_NOTEON) || (seq_event.type == snd_seq_event_type::SND_SEQ_EVENT_NOTEOFF)) {  
                 // Make sure we can add this event
-                if (_phrase_seq_events.size() < PHRASE_LOOPER_MAX_EVENTS) {
+                if (!_phrase_seq.full()) {
                     // If we are creating the initial phrase AND this is the first note, reset the tick
                     // count for the start of the phrase
-                    if (!_overdub && _phrase_seq_events.empty()) {
+                    if (!_overdub && _phrase_seq.empty()) {
                         _ticks = 1;
                     }
 
@@ -400,31 +416,22 @@ void SeqManager::process_midi_event_direct(const snd_seq_event_t *event)
 
                     // Create the note event
                     auto ev = PhraseSeqEvent();
+                    ev.type = PhraseSeqEventType::NOTE;
                     ev.note_event = *event;
                     ev.ticks = ticks;
                     ev.qnt_ticks = ticks;
 
-                    // Add/insert the note event to the sequence
-                    std::vector<PhraseSeqEvent>::iterator itr;
-                    if (_overdub) { 
-                        _phrase_seq_events_itr = _phrase_seq_events.insert(_phrase_seq_events_itr, ev);
-                        itr = _phrase_seq_events_itr;
-                        _overdub_started = true;
-                    }
-                    else {
-                        _phrase_seq_events.push_back(ev);
-                        itr = _phrase_seq_events.end() - 1;
-                    }
+                    // Quantise the note event and add it to the sequence timeline
+                    // Note: When overdubbing, the event is played at its position in the timeline, or
+                    // from the next phrase loop if that position has already been played
+                    _add_phrase_seq_note_event(ev);
                     DEBUG_MSG("Added note: " << (uint)event->data.note.note  << " : " << ev.ticks);  
-
-                    // Quantise the note event
-                    _quantise_note_event(itr);                  
                 }
             }
         }
 
         // Forward the MIDI event note
-        _send_note(seq_event);        
+        _forward_note(seq_event);        
     }
 }
 
@@ -597,11 +604,11 @@ void SeqManager::_process_param_value(const Param& param, MoniqueModule from_mod
     // Is this the MIDU clock in param?
     if (&param == _midi_clk_in_param) {
         // Adjust the step sequencer tempo and note durations
-        _tempo_pulse_count = utils::tempo_pulse_count(_tempo_note_value);
+        auto tempo_pulse_count = utils::tempo_pulse_count(_tempo_note_value);
         if (param.value() == 0) {
-            _tempo_pulse_count *= PPQN_CLOCK_PULSES_PER_MIDI_CLOCK;
+            tempo_pulse_count *= PPQN_CLOCK_PULSES_PER_MIDI_CLOCK;
         }
-        _note_duration_pulse_count = _tempo_pulse_count >> 1;
+        _pulse_counter.set_tempo_pulse_count(tempo_pulse_count);
         return;       
     }
 
@@ -676,7 +683,7 @@ void SeqManager::_process_param_value(const Param& param, MoniqueModule from_mod
             }
             else {
                 // If the sequencer has notes programmed
-                if (!_phrase_seq_events.empty()) {
+                if (!_phrase_seq.empty()) {
                     // If we have stopped recording
                     if (!_rec) {
                         // If we were not overdubbing, save the initial phrase
@@ -686,13 +693,10 @@ void SeqManager::_process_param_value(const Param& param, MoniqueModule from_mod
                             
                             // Append the end of phrase event
                             _append_end_phrase_event();
-
-                            // Sort the phrase sequence
-                            _sort_phrase_seq();
                         }
 
-                        // Set a flag to save the phrase sequence, done asynchronously                      
-                        _save_phrase_seq = true;
+                        // Request the phrase sequence is saved, done asynchronously
+                        _request_save_phrase_seq();
                     }
 
                     // Run the Sequencer
@@ -745,7 +749,7 @@ void SeqManager::_process_param_value(const Param& param, MoniqueModule from_mod
             }
             else {
                 // If the sequencer has notes programmed
-                if (!_phrase_seq_events.empty()) {         
+                if (!_phrase_seq.empty()) {         
                     // If we're starting RUN and recording, and not overdubbing, we need to save the 
                     // initial Sequence
                     if (_run && _rec && !_overdub) {
@@ -755,11 +759,8 @@ void SeqManager::_process_param_value(const Param& param, MoniqueModule from_mod
                         // Append the end of phrase event
                         _append_end_phrase_event();
 
-                        // Sort the phrase sequence
-                        _sort_phrase_seq();
-
-                        // Set a flag to save the phrase sequence, done asynchronously                       
-                        _save_phrase_seq = true;                   
+                        // Request the phrase sequence is saved, done asynchronously
+                        _request_save_phrase_seq();
                     }
 
                     // If we're stoping RUN and recording, then update the phrase stop record
@@ -767,8 +768,8 @@ void SeqManager::_process_param_value(const Param& param, MoniqueModule from_mod
                         // Check for any held notes
                         _check_for_phrase_held_notes();
                           
-                        // Set a flag to save the phrase sequence, done asynchronously                       
-                        _save_phrase_seq = true; 
+                        // Request the phrase sequence is saved, done asynchronously
+                        _request_save_phrase_seq();
 
                         // Stop recording                                       
                         _rec = false;
@@ -807,11 +808,11 @@ void SeqManager::_process_param_value(const Param& param, MoniqueModule from_mod
         case SeqParamId::TEMPO_NOTE_VALUE_PARAM_ID: {
             // Set the tempo pulse count from the updated note value
             _tempo_note_value = utils::tempo_note_value(param.hr_value());
-            _tempo_pulse_count = utils::tempo_pulse_count(_tempo_note_value);
+            auto tempo_pulse_count = utils::tempo_pulse_count(_tempo_note_value);
             if (_midi_clk_in_param->value() == 0) {
-                _tempo_pulse_count *= PPQN_CLOCK_PULSES_PER_MIDI_CLOCK;
+                tempo_pulse_count *= PPQN_CLOCK_PULSES_PER_MIDI_CLOCK;
             }
-            _note_duration_pulse_count = _tempo_pulse_count >> 1;
+            _pulse_counter.set_tempo_pulse_count(tempo_pulse_count);
             break;                  
         }
 
@@ -829,9 +830,14 @@ void SeqManager::_process_param_value(const Param& param, MoniqueModule from_mod
                 _phrase_qnt_pulse_count = utils::tempo_pulse_count(utils::tempo_note_value(param.hr_value() - 1)) * PPQN_CLOCK_PULSES_PER_MIDI_CLOCK;
 
             // If the phrase looper has events
-            if (_phrase_seq_events.size() > 0) {
+            if (!_phrase_seq.empty()) {
                 // Quantise the current sequence
                 _quantise_seq();
+
+                // If the sequence is playing, continue from the current position
+                if (_looper_seq_state == LooperSeqState::PLAYING) {
+                    _phrase_seq.seek(_ticks + 1);
+                }
             }        
             break;		
         }
@@ -961,8 +967,6 @@ void SeqManager::_process_param_value(const Param& param, MoniqueModule from_mod
 //----------------------------------------------------------------------------
 void SeqManager::_process_tempo_event()
 {
-    uint pulse_count = 0;
-
 	// Do forever until stopped
 	while (true) {
         // Get the mutex lock
@@ -973,18 +977,20 @@ void SeqManager::_process_tempo_event()
 
         // If the FSM is running
         if (_fsm_running) {
+            // Schedule any notes sent for this tempo pulse, rather than sending them immediately
+            _send_time = utils::seq_pulse_time() + NOTE_SCHEDULER_LATENCY;
+
             // Process depending on the Sequencer mode
             if (_seq_mode == SeqMode::STEP) {
                 // Has the FSM been reset or the required number of tempo pulses reached?
-                if (_reset_fsm || (++pulse_count >= _note_duration_pulse_count)) {
+                if (_reset_fsm || _pulse_counter.pulse()) {
                     // Process the FSM
                     bool start_playing = _process_fsm();
 
                     // Set the next note duration pulse count to check
                     // Note: Wait for one MIDI clock before when we start playing - we do this to ensure
                     // the clock is running before sending note-on events                
-                    _note_duration_pulse_count = _tempo_pulse_count - _note_duration_pulse_count;
-                    pulse_count = start_playing ? (_note_duration_pulse_count - 1) : 0;
+                    _pulse_counter.next_duration(start_playing);
                     _reset_fsm = false;
                 }
             }
@@ -1026,6 +1032,7 @@ void SeqManager::_process_tempo_event()
                     _clock_pulse_count = 0;
                 }
             }
+            _send_time = NOTE_SCHEDULER_SEND_NOW;
         }
         else {
             // Quit the tempo event thread
@@ -1039,28 +1046,68 @@ void SeqManager::_process_tempo_event()
 //----------------------------------------------------------------------------
 void SeqManager::_process_save_phrase_seq_event()
 {
+    // The saved sequence is kept in non-quantised order, with the end of phrase event
+    // after any other events with the same ticks
+    auto order = [ ]( const PhraseSeqEvent& a, const PhraseSeqEvent& b) {
+        return (a.ticks < b.ticks) ||
+               ((a.ticks == b.ticks) && (a.type != PhraseSeqEventType::END_OF_PHRASE) && (b.type == PhraseSeqEventType::END_OF_PHRASE));
+    };
+    std::vector<PhraseSeqEvent> seq;
+
 	// Do forever until stopped
-	while (_fsm_running) {
-        // Save the phrase sequence?
-        if (_save_phrase_seq) {
-            // Take a copy of the sequence so we can ensure the sort order is correct
-            // and hold the mutex for as short a time as possible
-            std::vector<PhraseSeqEvent> seq;
-            {
-                std::unique_lock<std::mutex> lk(utils::seq_mutex());
+	while (true) {
+        std::vector<PhraseSeqEvent> events;
+        bool full;
+        {
+            std::unique_lock<std::mutex> lk(_save_phrase_seq_mutex);
+
+            // Wait for a save request
+            _save_phrase_seq_cv.wait(lk, [this]() {return _save_phrase_seq || !_save_phrase_seq_running;});
 
-                // Take a copy of the current sequence
-                seq = _phrase_seq_events;
+            // Debounce the save - wait until no further requests have been made for the
+            // debounce period
+            while (_save_phrase_seq && _save_phrase_seq_running &&
+                   (std::chrono::steady_clock::now() < (_save_phrase_seq_time + PHRASE_SEQ_SAVE_DEBOUNCE))) {
+                _save_phrase_seq_cv.wait_until(lk, _save_phrase_seq_time + PHRASE_SEQ_SAVE_DEBOUNCE);
             }
 
-            // Sort the sequence as non-quantised
-            std::sort(seq.begin(), seq.end(), [ ]( const PhraseSeqEvent& a, const PhraseSeqEvent& b) {return a.ticks < b.ticks;});
+            // Has the save been cancelled?
+            if (!_save_phrase_seq) {
+                if (!_save_phrase_seq_running) {
+                    // Quit the save phrase sequence thread
+                    break;
+                }
+                continue;
+            }
 
-            // Save this Sequence in chunks
-            _save_seq_chunks(seq);
+            // Take the requested events
+            // Note: These are either a snapshot of the whole sequence, or just the events
+            // recorded since the last save request
+            events.swap(_save_phrase_seq_events);
+            full = _save_phrase_seq_full;
             _save_phrase_seq = false;
+            _save_phrase_seq_full = false;
         }
-        std::this_thread::sleep_for(std::chrono::seconds(1)); 
+
+        // Merge the events into the saved sequence, and get the index of the first
+        // event that has changed
+        uint first_changed = 0;
+        std::stable_sort(events.begin(), events.end(), order);
+        if (full) {
+            seq = std::move(events);
+        }
+        else if (!events.empty()) {
+            first_changed = std::upper_bound(seq.begin(), seq.end(), events.front(), order) - seq.begin();
+            uint size = seq.size();
+            seq.insert(seq.end(), events.begin(), events.end());
+            std::inplace_merge(seq.begin() + first_changed, seq.begin() + size, seq.end(), order);
+        }
+        else {
+            continue;
+        }
+
+        // Save this Sequence in chunks
+        _save_seq_chunks(seq, first_changed);
     }
 }
 
@@ -1230,7 +1277,6 @@ bool SeqManager::_process_fsm()
                         _looper_seq_state = LooperSeqState::START_PLAYING;
                     }
                     _overdub = true;
-                    _overdub_started = false;
                 }
                 else {
                     // Starting a new sequence so reset the clock pulse count
@@ -1256,14 +1302,13 @@ bool SeqManager::_process_fsm()
         // Has the RUN mode changed?
         else if (_prev_run != _run) {
             // Start or stop playing the sequence
-            _run && _phrase_seq_events.size() ?
+            _run && !_phrase_seq.empty() ?
                 _looper_seq_state = LooperSeqState::START_PLAYING :
                 _looper_seq_state = LooperSeqState::IDLE;
             
             // If we're also recording AND there are notes, enter overdub mode
-            if (_rec && (_phrase_seq_events.size() > 0)) {
+            if (_rec && !_phrase_seq.empty()) {
                 _overdub = true;
-                _overdub_started = false;
                 _phrase_seq_note_on_events.clear();
             }
         }
@@ -1287,7 +1332,7 @@ bool SeqManager::_process_fsm()
         case LooperSeqState::START_PLAYING:
             // Start playing the notes in the sequencer from the
             // beginning of the existing sequence
-            _phrase_seq_events_itr = _phrase_seq_events.begin();
+            _phrase_seq.seek(0);
             _ticks = 1;
 
             // Change the state to indicate we are now playing a sequence
@@ -1299,36 +1344,25 @@ bool SeqManager::_process_fsm()
             // Play all notes that are less than the current ticks count
             while (true) {
                 // If we have reached the end of the phrase
-                if (_phrase_seq_events_itr == _phrase_seq_events.end()) {
+                if (_phrase_seq.end()) {
                     // Re-start the sequence on the next tick
-                    _phrase_seq_events_itr = _phrase_seq_events.begin();
+                    _phrase_seq.seek(0);
                     _ticks = 0;
-
-                    // If overdub was performed during this phrase loop AND we are quantising, we need to sort the notes for
-                    // the newly added overdub notes
-                    if (_overdub_started && (_phrase_qnt != PhraseQuantisation::NONE)) {
-                        std::sort(_phrase_seq_events.begin(), _phrase_seq_events.end(), [ ]( const PhraseSeqEvent& a, const PhraseSeqEvent& b) {return a.qnt_ticks < b.qnt_ticks;});
-                        _overdub_started = false;
-                    }
                     break;
                 }
 
-                // Should we use the quantised tick events?
-                uint32_t ticks = _phrase_qnt == PhraseQuantisation::NONE ? _phrase_seq_events_itr->ticks : _phrase_seq_events_itr->qnt_ticks;
-
-                // Check if this event should be processed
-                if (ticks <= _ticks) {
-                    // Play this note and move to the next event to check
-                    if (_phrase_seq_events_itr->type == PhraseSeqEventType::NOTE) {
-                        // Play the note
-                        _send_seq_note(_phrase_seq_events_itr->note_event);
-                    }
-                    _phrase_seq_events_itr++;
-                }
-                else {
+                // Get the next event to process, if any
+                // Note: The timeline is ordered by the quantised ticks if quantisation is enabled
+                auto ev = _phrase_seq.next_event(_ticks);
+                if (!ev) {
                     // All notes less than the current ticks count have been played
                     break;
-                }                
+                }
+
+                // Play this note
+                if (ev->type == PhraseSeqEventType::NOTE) {
+                    _send_seq_note(ev->note_event);
+                }
             }
             break;
         }
@@ -1350,7 +1384,7 @@ void SeqManager::_clear_idle_sent_notes()
             auto note_off = _idle_sent_notes[i];
             note_off.type = snd_seq_event_type::SND_SEQ_EVENT_NOTEOFF;
             note_off.data.note.velocity = 0;
-            _send_note(note_off);
+            _forward_note(note_off);
         }
         _idle_sent_notes.clear();
     }
@@ -1489,7 +1523,18 @@ void SeqManager::_send_note(const snd_seq_event_t &note)
     //else
     //    DEBUG_BASEMGR_MSG("Send note: " << (int)note.data.note.note << ": OFF");
 
-    // Send the note directly to the Arpeggiator
+    // Send the note directly to the Arpeggiator, scheduled for the tempo pulse it is
+    // being sent for, or to be sent immediately
+    utils::get_manager(MoniqueModule::ARP)->schedule_midi_event_direct(&note, _send_time);
+}
+
+//----------------------------------------------------------------------------
+// _forward_note
+//----------------------------------------------------------------------------
+void SeqManager::_forward_note(const snd_seq_event_t &note)
+{
+    // Forward the note (received from the keyboard or MIDI input) directly to the
+    // Arpeggiator, so that it is sent immediately and is never scheduled
     utils::get_manager(MoniqueModule::ARP)->process_midi_event_direct(&note);
 }
 
@@ -1640,14 +1685,17 @@ void SeqManager::_reset_seq_steps()
 void SeqManager::_reset_seq_phrase_looper()
 {
     // Reset the phrase looper settings
-    _phrase_seq_events.clear();
+    _phrase_seq.clear();
     _ticks = 0;
     _end_of_phrase_ticks = 0;
     _clock_pulse_count = 0;
     _overdub = false;
-    _overdub_started = false;
     _seq_played_notes.clear();
     _phrase_seq_note_on_events.clear();
+
+    // Cancel any pending save of the previous phrase, the next save must be
+    // the whole phrase
+    _cancel_save_phrase_seq();
 }
 
 //----------------------------------------------------------------------------
@@ -1712,17 +1760,17 @@ void SeqManager::_check_for_phrase_held_notes()
     // If there are any held notes when we stop recording, add NOTE OFF
     // events
     if (!_phrase_seq_note_on_events.empty()) {
-        for (auto it = _phrase_seq_note_on_events.begin(); it != _phrase_seq_note_on_events.end(); ++it) {
+        for (uint index : _phrase_seq_note_on_events) {
             // Add a NOTE OFF event for this note
             auto ev = PhraseSeqEvent();
             ev.type = PhraseSeqEventType::NOTE;
-            ev.note_event = (*it).note_event;
+            ev.note_event = _phrase_seq.event(index).note_event;
             ev.note_event.type = snd_seq_event_type::SND_SEQ_EVENT_NOTEOFF;
             ev.note_event.data.note.velocity = 0;
             ev.ticks = _ticks;
             ev.qnt_ticks = _ticks;
-            _phrase_seq_events.push_back(ev);
-            _quantise_note_off_event(it, _phrase_seq_events.end() - 1);
+            ev.note_on_index = index;
+            _phrase_seq.add_event(ev);
             DEBUG_MSG("Added held NOTE OFF: " << (uint)ev.note_event.data.note.note  << " : " << ev.ticks);     
         }
         _phrase_seq_note_on_events.clear();
@@ -1734,6 +1782,9 @@ void SeqManager::_check_for_phrase_held_notes()
 //----------------------------------------------------------------------------
 void SeqManager::_append_end_phrase_event()
 {
+    // Note: The initial phrase events are recorded in tick order
+    auto& phrase_seq_events = _phrase_seq.events();
+    auto event_index = [&phrase_seq_events](auto itr) { return (uint)(std::distance(itr, phrase_seq_events.rend()) - 1); };
     uint32_t ticks = 0;
 
     // Are we rounding to a bar?
@@ -1742,7 +1793,7 @@ void SeqManager::_append_end_phrase_event()
 
         // From the end of the phrase, find the last NOTE ON event, and round up to the nearest beat
         // This sets the MINIMUM bar length of the phrase
-        for (auto itr=_phrase_seq_events.rbegin(); itr != _phrase_seq_events.rend(); ++itr) {
+        for (auto itr=phrase_seq_events.rbegin(); itr != phrase_seq_events.rend(); ++itr) {
             // If this is a NOTE ON event
             if ((itr->type == PhraseSeqEventType::NOTE) && (itr->note_event.type == snd_seq_event_type::SND_SEQ_EVENT_NOTEON)) {
                 // Calculate the minimum phrase length - rounded UP to the next beat
@@ -1757,7 +1808,7 @@ void SeqManager::_append_end_phrase_event()
         ticks = actual_ticks < min_ticks ? min_ticks : actual_ticks;
 
         // Make sure any NOTE OFF events at the end of the phrase are truncated if needed
-        for (auto itr=_phrase_seq_events.rbegin(); itr != _phrase_seq_events.rend(); ++itr) {
+        for (auto itr=phrase_seq_events.rbegin(); itr != phrase_seq_events.rend(); ++itr) {
             // If this is a NOTE event
             if (itr->type == PhraseSeqEventType::NOTE) {
                 // If this is a NOTE ON, stop searching for NOTE OFF events
@@ -1767,7 +1818,7 @@ void SeqManager::_append_end_phrase_event()
 
                 // If this NOTE OFF exceeds the current end of phrase ticks, truncate it
                 if (itr->ticks > ticks) {
-                    itr->ticks = ticks;
+                    _phrase_seq.set_ticks(event_index(itr), ticks);
                 }
                 else {
                     // NOTE OFF is within the phrase, stop searching
@@ -1778,7 +1829,7 @@ void SeqManager::_append_end_phrase_event()
     }
     else {
         // Get the last event in the phrase, assumed to be a NOTE OFF    
-        auto itr = _phrase_seq_events.end() - 1;
+        auto itr = phrase_seq_events.end() - 1;
 
         // Calculate the ticks in a bar
         uint bar_ticks = _round_bar_count * PPQN;
@@ -1788,7 +1839,7 @@ void SeqManager::_append_end_phrase_event()
         if (itr->ticks % bar_ticks) {
             // From the end of the phrase, find the last NOTE ON event
             // This sets the MINIMUM bar length of the phrase
-            for (auto itr=_phrase_seq_events.rbegin(); itr != _phrase_seq_events.rend(); ++itr) {
+            for (auto itr=phrase_seq_events.rbegin(); itr != phrase_seq_events.rend(); ++itr) {
                 // If this is a NOTE ON event
                 if ((itr->type == PhraseSeqEventType::NOTE) && (itr->note_event.type == snd_seq_event_type::SND_SEQ_EVENT_NOTEON)) {
                     // Calculate the minimum phrase length
@@ -1820,7 +1871,7 @@ void SeqManager::_append_end_phrase_event()
                 // as the actual phrase length
                 // Because of this we need to make sure any NOTE OFF events at the end of the phrase are
                 // truncated to the minimum phrase length
-                for (auto itr=_phrase_seq_events.rbegin(); itr != _phrase_seq_events.rend(); ++itr) {
+                for (auto itr=phrase_seq_events.rbegin(); itr != phrase_seq_events.rend(); ++itr) {
                     // If this is a NOTE event
                     if (itr->type == PhraseSeqEventType::NOTE) {
                         // If this is a NOTE ON, stop searching for NOTE OFF events
@@ -1830,7 +1881,7 @@ void SeqManager::_append_end_phrase_event()
 
                         // If this NOTE OFF exceeds the current end of phrase ticks, truncate it
                         if (itr->ticks > ticks) {
-                            itr->ticks = ticks;
+                            _phrase_seq.set_ticks(event_index(itr), ticks);
                         }
                         else {
                             // NOTE OFF is within the phrase, stop searching
@@ -1851,9 +1902,12 @@ void SeqManager::_append_end_phrase_event()
     ev.type = PhraseSeqEventType::END_OF_PHRASE;
     ev.ticks = ticks;
     ev.qnt_ticks = ticks;
-    _phrase_seq_events.push_back(ev);
+    _phrase_seq.add_event(ev);
     _end_of_phrase_ticks = ticks;
 
+    // The phrase events have been truncated, so the next save must be the whole phrase
+    _phrase_seq_full_save = true;
+
     // Re-quantise the initial phrase
     // We need to do this to make sure any quantised notes that exceed
     // the end of phrase are handled correctly, by wrapping around to the
@@ -1861,249 +1915,220 @@ void SeqManager::_append_end_phrase_event()
     _quantise_seq();
 }
 
-//----------------------------------------------------------------------------
-// _sort_phrase_seq
-//----------------------------------------------------------------------------
-void SeqManager::_sort_phrase_seq()
-{
-    // Sort the sequence depending on whether quantisation is enabled or not
-    _phrase_qnt == PhraseQuantisation::NONE ?
-        std::sort(_phrase_seq_events.begin(), _phrase_seq_events.end(), [ ]( const PhraseSeqEvent& a, const PhraseSeqEvent& b) {return a.ticks < b.ticks;}) :
-        std::sort(_phrase_seq_events.begin(), _phrase_seq_events.end(), [ ]( const PhraseSeqEvent& a, const PhraseSeqEvent& b) {return a.qnt_ticks < b.qnt_ticks;});
-}
-
 //----------------------------------------------------------------------------
 // _load_seq_chunks
 //----------------------------------------------------------------------------
 void SeqManager::_load_seq_chunks()
 {
-    // Parse each Sequencer chunk until an undefined note is found
+    std::vector<PhraseSeqEvent> events;
+
+    // Decode each Sequencer chunk until the end of the phrase
     for (uint i=0; i<MAX_CHUNKS; i++) {
         // Get the Sequencer Chunk param
         auto param = utils::get_param(MoniqueModule::SEQ, SeqParamId::CHUNK_PARAM_ID + i);
         if (param) {
-            // Parse all notes in the chunk
-            auto chunk = param->str_value();
-            for (uint j=0; j<CHUNK_MAX_NOTES; j++) {
-                // Extract the ticks and channel
-                // Check if the channel is set to the end of phrase indicator                
-                auto ticks_str = chunk.substr((j * 7 * 2), 8);
-                auto channel_str = chunk.substr(((j * 7 * 2) + 8), 2);
-                auto ticks = std::stoi(ticks_str, nullptr, 16);
-                auto channel = std::stoi(channel_str, nullptr, 16);
-                if (channel == END_OF_PHRASE_INDICATOR) {
-                    // Add the end of phrase event, and stop processing chunks
-                    auto ev = PhraseSeqEvent();
-                    ev.type = PhraseSeqEventType::END_OF_PHRASE;
-                    ev.ticks = ticks;
-                    ev.qnt_ticks = ticks;
-                    _phrase_seq_events.push_back(ev);
-                    _end_of_phrase_ticks = ticks;
-                    return;                   
+            // Decode all events in the chunk
+            events.clear();
+            bool more_chunks = phrase_seq_chunk::decode(param->str_value(), events);
+            for (auto& ev : events) {
+                // Is this the end of phrase event?
+                if (ev.type == PhraseSeqEventType::END_OF_PHRASE) {
+                    // Add the end of phrase event
+                    _phrase_seq.add_event(ev);
+                    _end_of_phrase_ticks = ev.ticks;
                 }
                 else {
-                    // Extract the note and velocity
-                    auto note_str = chunk.substr(((j * 7 * 2) + 10), 2);
-                    auto vel_str = chunk.substr(((j * 7 * 2) + 12), 2);
-                    auto note = std::stoi(note_str, nullptr, 16);
-                    auto vel = std::stoi(vel_str, nullptr, 16);
-
-                    // If this is a valid note definition
-                    if ((uint)note <= MIDI_MAX_NOTE) {
-                        // Create the sequencer note event
-                        snd_seq_event_t note_event;
-                        note_event.type = vel ? snd_seq_event_type::SND_SEQ_EVENT_NOTEON : snd_seq_event_type::SND_SEQ_EVENT_NOTEOFF;
-                        note_event.data.note.channel = channel;
-                        note_event.data.note.note = note;
-                        note_event.data.note.velocity = vel;
-
-                        // Add it to the Sequencer events
-                        auto ev = PhraseSeqEvent();
-                        ev.type = PhraseSeqEventType::NOTE;
-                        ev.note_event = note_event;
-                        ev.ticks = ticks;
-                        ev.qnt_ticks = ticks;
-                        _phrase_seq_events.push_back(ev);
-                        //DEBUG_MSG("Loaded note: " << (uint)note_event.data.note.note  << " : " << ticks);  
-                    }
-                    else {
-                        // Note is invalid, stop processing chunks
-                        return;
-                    }
+                    // Add it to the Sequencer events
+                    _add_phrase_seq_note_event(ev);
                 }
             }
+            if (!more_chunks) {
+                // The phrase has ended, stop processing chunks
+                break;
+            }
         }
-    }  
+    }
+    _phrase_seq_note_on_events.clear();
 }
 
 //----------------------------------------------------------------------------
-// _save_seq_chunks
+// _request_save_phrase_seq
 //----------------------------------------------------------------------------
-void SeqManager::_save_seq_chunks(const std::vector<PhraseSeqEvent>& seq)
+void SeqManager::_request_save_phrase_seq()
 {
-    std::string chunk_notes = utils::seq_chunk_param_reset_value();
-    char str_event[(7 * 2) + 1];
-    uint chunk_index = 0;
-    uint chunk_note_index = 0;
-
-    // Get the first chunk param
-    auto param = utils::get_param(MoniqueModule::SEQ, SeqParamId::CHUNK_PARAM_ID + chunk_index);
-    if (param) {
-        // Iterate all events
-        for (auto itr=seq.begin(); itr!=seq.end(); ++itr) {
-            // Is this an end of phrase event?
-            if (itr->type == PhraseSeqEventType::END_OF_PHRASE) {
-                // Create the event definition as a string
-                std::sprintf(str_event, "%08X%02XFFFF", itr->ticks, END_OF_PHRASE_INDICATOR);
-
-                // Add it to the current chunk
-                chunk_notes.replace((chunk_note_index * 7 * 2), (7 * 2), str_event);
-
-                // Finished processing chunks, send a param change
-                param->set_str_value(chunk_notes);
-                auto param_change = ParamChange(param, module());
-                param_change.display = false;
-                _event_router->post_param_changed_event(new ParamChangedEvent(param_change));
-                return;                
-            }
-            else {
-                // Create the note definition as a string
-                std::sprintf(str_event, "%08X%02X%02X%02X", itr->ticks, itr->note_event.data.note.channel, itr->note_event.data.note.note, itr->note_event.data.note.velocity);
-
-                // Add it to the current chunk
-                chunk_notes.replace((chunk_note_index * 7 * 2), (7 * 2), str_event);
-                chunk_note_index++;
-
-                // Is the chunk full?
-                if (chunk_note_index >= CHUNK_MAX_NOTES) {
-                    // The chunk is full, send a param change
-                    param->set_str_value(chunk_notes);
-                    auto param_change = ParamChange(param, module());
-                    param_change.display = false;
-                    _event_router->post_param_changed_event(new ParamChangedEvent(param_change));
-
-                    // Increment the chunk index and check if there are chunks free to process
-                    chunk_index++;
-                    if (chunk_index >= MAX_CHUNKS) {
-                        // No more chunks to process so stop processing Sequencer notes
-                        break;
-                    }
+    // Note: Assumes the seq mutex is held
+    auto& events = _phrase_seq.events();
+    std::lock_guard<std::mutex> lk(_save_phrase_seq_mutex);
+
+    // Should the whole phrase be saved?
+    if (_phrase_seq_full_save) {
+        // Take a snapshot of the whole phrase
+        _save_phrase_seq_events.assign(events.begin(), events.end());
+        _save_phrase_seq_full = true;
+        _phrase_seq_full_save = false;
+    }
+    else {
+        // Add the events recorded since the last save request
+        _save_phrase_seq_events.insert(_save_phrase_seq_events.end(), events.begin() + _phrase_seq_saved_size, events.end());
+    }
+    _phrase_seq_saved_size = events.size();
 
-                    // Get the next chunk to process
-                    param = utils::get_param(MoniqueModule::SEQ, SeqParamId::CHUNK_PARAM_ID + chunk_index);
-                    if (!param) {
-                        // Chunk invalid, should never happen
-                        return;
-                    }
+    // Signal the save phrase sequence thread
+    _save_phrase_seq = true;
+    _save_phrase_seq_time = std::chrono::steady_clock::now();
+    _save_phrase_seq_cv.notify_one();
+}
 
-                    // Reset the chunk note index
-                    chunk_note_index = 0;
-                    chunk_notes = utils::seq_chunk_param_reset_value();
-                }
-            }
-        }
+//----------------------------------------------------------------------------
+// _cancel_save_phrase_seq
+//----------------------------------------------------------------------------
+void SeqManager::_cancel_save_phrase_seq()
+{
+    // Note: Assumes the seq mutex is held
+    _phrase_seq_full_save = true;
+    _phrase_seq_saved_size = 0;
+    {
+        std::lock_guard<std::mutex> lk(_save_phrase_seq_mutex);
+        _save_phrase_seq_events.clear();
+        _save_phrase_seq = false;
+        _save_phrase_seq_full = false;
+    }
+    _save_phrase_seq_cv.notify_one();
+}
 
-        // Processed all Sequencer notes - is there a partially processed chunk to send?
-        if (chunk_note_index) {
-            // Send a param change for the final chunk
-            param->set_str_value(chunk_notes);
-            auto param_change = ParamChange(param, module());
-            param_change.display = false;
-            _event_router->post_param_changed_event(new ParamChangedEvent(param_change));            
+//----------------------------------------------------------------------------
+// _save_seq_chunks
+//----------------------------------------------------------------------------
+void SeqManager::_save_seq_chunks(const std::vector<PhraseSeqEvent>& seq, uint first_changed)
+{
+    // The chunks before the first changed event are unchanged, so encode the events
+    // from the start of the chunk containing this event
+    uint first_chunk = first_changed / phrase_seq_chunk::CHUNK_MAX_EVENTS;
+    auto chunks = phrase_seq_chunk::encode(seq, first_chunk, MAX_CHUNKS);
+
+    // Save each encoded chunk
+    for (uint i=0; i<chunks.size(); i++) {
+        auto param = utils::get_param(MoniqueModule::SEQ, SeqParamId::CHUNK_PARAM_ID + first_chunk + i);
+        if (!param) {
+            // Chunk invalid, should never happen
+            return;
         }
+        _save_seq_chunk(param, chunks[i]);
     }
-}    
+}
 
 //----------------------------------------------------------------------------
-// _quantise_seq
+// _save_seq_chunk
 //----------------------------------------------------------------------------
-void SeqManager::_quantise_seq()
+void SeqManager::_save_seq_chunk(Param *param, const std::string& chunk_notes)
 {
-    // Before we quantise the sequence, make sure it is in a non-quantised order
-    std::sort(_phrase_seq_events.begin(), _phrase_seq_events.end(), [ ]( const PhraseSeqEvent& a, const PhraseSeqEvent& b) {return a.ticks < b.ticks;});
-    
-    // Go through the entire phrase sequence, quantising each note to the current note value
-    _phrase_seq_note_on_events.clear();
-     for (auto itr=_phrase_seq_events.begin(); itr!=_phrase_seq_events.end(); ++itr) {
-        // Quantise the note event
-        _quantise_note_event(itr);
-     }
-
-    // Now re-sort the sequence, if needed
-    if (_phrase_qnt != PhraseQuantisation::NONE) {
-        _sort_phrase_seq();
+    // Only send a param change if the chunk contents have changed
+    if (param->str_value() != chunk_notes) {
+        param->set_str_value(chunk_notes);
+        auto param_change = ParamChange(param, module());
+        param_change.display = false;
+        _event_router->post_param_changed_event(new ParamChangedEvent(param_change));
     }
-
-     // Make sure the NOTE ON events vector is cleared
-     _phrase_seq_note_on_events.clear(); 
 }
 
 //----------------------------------------------------------------------------
-// _quantise_note_event
+// _add_phrase_seq_note_event
 //----------------------------------------------------------------------------
-void SeqManager::_quantise_note_event(std::vector<PhraseSeqEvent>::iterator itr)
+void SeqManager::_add_phrase_seq_note_event(PhraseSeqEvent& note_event)
 {
     // Is this a NOTE ON event?
-    if (itr->note_event.type == snd_seq_event_type::SND_SEQ_EVENT_NOTEON) {
-        // Quantise the NOTE ON event
-        _quantise_note_on_event(itr);
+    if (note_event.note_event.type == snd_seq_event_type::SND_SEQ_EVENT_NOTEON) {
+        // Add the NOTE ON event to the timeline, which quantises it
+        auto index = _phrase_seq.add_event(note_event);
 
         // Add to the NOTE ON events vector
-        _phrase_seq_note_on_events.push_back(*itr);
+        _phrase_seq_note_on_events.push_back(index);
     }
     else {
         // Find the equivalent event in the NOTE ON events vector
-        for (auto itr2 = _phrase_seq_note_on_events.begin(); itr2 != _phrase_seq_note_on_events.end(); itr2++) {
+        for (auto itr = _phrase_seq_note_on_events.begin(); itr != _phrase_seq_note_on_events.end(); itr++) {
             // Does this note match the NOTE OFF?
-            if ((itr2->note_event.data.note.note == itr->note_event.data.note.note) &&
-                (itr2->note_event.data.note.channel == itr->note_event.data.note.channel)) {
-                // Quantise the NOTE OFF event
-                _quantise_note_off_event(itr2, itr);
+            auto& note_on_event = _phrase_seq.event(*itr);
+            if ((note_on_event.note_event.data.note.note == note_event.note_event.data.note.note) &&
+                (note_on_event.note_event.data.note.channel == note_event.note_event.data.note.channel)) {
+                // Pair the NOTE OFF event, so it is quantised from the NOTE ON event
+                note_event.note_on_index = *itr;
 
                 // Remove the from the NOTE ON events
-                _phrase_seq_note_on_events.erase(itr2);
+                _phrase_seq_note_on_events.erase(itr);
                 break;
             }
-        }                        
+        }
+        _phrase_seq.add_event(note_event);
+    }
+}
+
+//----------------------------------------------------------------------------
+// _quantise_seq
+//----------------------------------------------------------------------------
+void SeqManager::_quantise_seq()
+{
+    // Requantise the phrase sequence to the current note value, ordered by either the
+    // quantised or non-quantised ticks
+    // Note: This is lazy, each part of the sequence is quantised when it is next played.
+    // Quantising moves a note by at most the quantisation pulse count, other than notes
+    // which wrap around the end of the phrase
+    _phrase_seq.requantise((_phrase_qnt != PhraseQuantisation::NONE), (_phrase_qnt_pulse_count + 1), _end_of_phrase_ticks);
+}
+
+//----------------------------------------------------------------------------
+// _quantise_phrase_seq_event
+//----------------------------------------------------------------------------
+void SeqManager::_quantise_phrase_seq_event(PhraseSeqEvent& event, const PhraseSeqEvent *note_on_event)
+{
+    // Is this a NOTE event?
+    if (event.type == PhraseSeqEventType::NOTE) {
+        // Quantise the NOTE OFF event if it has been paired, or the NOTE ON event
+        if (note_on_event) {
+            _quantise_note_off_event(*note_on_event, event);
+        }
+        else if (event.note_event.type == snd_seq_event_type::SND_SEQ_EVENT_NOTEON) {
+            _quantise_note_on_event(event);
+        }
     }
 }
 
 //----------------------------------------------------------------------------
 // _quantise_note_on_event
 //----------------------------------------------------------------------------
-void SeqManager::_quantise_note_on_event(std::vector<PhraseSeqEvent>::iterator note_on_event_itr)
+void SeqManager::_quantise_note_on_event(PhraseSeqEvent& note_on_event)
 {
     // Calculate the quantised ticks
-    note_on_event_itr->qnt_ticks = _quantise_ticks(note_on_event_itr->ticks);
+    note_on_event.qnt_ticks = _quantise_ticks(note_on_event.ticks);
 
     // If a phrase has been defined, and the quantised ticks have moved past the end
     // of the phrase, wrap it around to the start
-    if (_end_of_phrase_ticks && (note_on_event_itr->qnt_ticks >= _end_of_phrase_ticks)) {
-        note_on_event_itr->qnt_ticks = 1;
+    if (_end_of_phrase_ticks && (note_on_event.qnt_ticks >= _end_of_phrase_ticks)) {
+        note_on_event.qnt_ticks = 1;
     }
 }
 
 //----------------------------------------------------------------------------
 // _quantise_note_off_event
 //----------------------------------------------------------------------------
-void SeqManager::_quantise_note_off_event(std::vector<PhraseSeqEvent>::iterator note_on_event_itr, std::vector<PhraseSeqEvent>::iterator note_off_event_itr)
+void SeqManager::_quantise_note_off_event(const PhraseSeqEvent& note_on_event, PhraseSeqEvent& note_off_event)
 {
     // Calculate the quantised note off ticks - firstly calculate the note duration
     uint32_t note_dur;
-    if (note_on_event_itr->ticks <= note_off_event_itr->ticks) {
-        note_dur = note_off_event_itr->ticks - note_on_event_itr->ticks;
+    if (note_on_event.ticks <= note_off_event.ticks) {
+        note_dur = note_off_event.ticks - note_on_event.ticks;
     }
     else {
-        note_dur = (_end_of_phrase_ticks - note_on_event_itr->ticks) + note_off_event_itr->ticks - 1;
+        note_dur = (_end_of_phrase_ticks - note_on_event.ticks) + note_off_event.ticks - 1;
     }
 
     // Calculate the quantised note off ticks, wrap around if the phrase exists and
     // it exceeds the phrase duration
-    uint32_t qnt_ticks = note_on_event_itr->qnt_ticks + note_dur;
+    uint32_t qnt_ticks = note_on_event.qnt_ticks + note_dur;
     if (_end_of_phrase_ticks && (qnt_ticks > _end_of_phrase_ticks)) {
-        qnt_ticks = note_dur - (_end_of_phrase_ticks - note_on_event_itr->qnt_ticks) + 1;
+        qnt_ticks = note_dur - (_end_of_phrase_ticks - note_on_event.qnt_ticks) + 1;
     }
-    note_off_event_itr->qnt_ticks = qnt_ticks;
+    note_off_event.qnt_ticks = qnt_ticks;
 }
 
 //----------------------------------------------------------------------------
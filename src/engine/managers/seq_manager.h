@@ -10,6 +10,8 @@
 #define _SEQ_MANAGER_H
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include "base_manager.h"
 #include "midi_device_manager.h"
 #include "event.h"
@@ -17,6 +19,9 @@
 #include "utils.h"
 #include "layer_info.h"
 #include "param.h"
+#include "phrase_seq_timeline.h"
+#include "note_scheduler.h"
+#include "tempo_pulse_counter.h"
 
 // Constants
 constexpr uint STEP_SEQ_MAX_STEPS = 16;
@@ -74,13 +79,6 @@ enum class StepType
     REST
 };
 
-// Phrase Sequencer Event Type
-enum class PhraseSeqEventType
-{
-    NOTE,
-    END_OF_PHRASE
-};
-
 // Phrase Beats per Bar
 enum class PhraseBeatsPerBar
 {
@@ -115,15 +113,6 @@ struct SeqStep
     int num_notes;
 };
 
-// Phrase Sequencer Event
-struct PhraseSeqEvent
-{
-    PhraseSeqEventType type;
-    snd_seq_event_t note_event;
-    uint32_t ticks;
-    uint32_t qnt_ticks;
-};
-
 // Sequencer Manager class
 class SeqManager : public BaseManager
 {
@@ -161,8 +150,7 @@ private:
     StepSeqState _step_seq_state;
     LooperSeqState _looper_seq_state;
     std::array<SeqStep, STEP_SEQ_MAX_STEPS> _seq_steps;
-    uint _tempo_pulse_count;
-    uint _note_duration_pulse_count;
+    TempoPulseCounter _pulse_counter;
     uint _phrase_metronome_accent_pulse_count;
     uint _phrase_metronome_accent_pulses;
     uint _phrase_qnt_pulse_count;
@@ -179,21 +167,28 @@ private:
     std::vector<snd_seq_event_t> _sent_notes;
     std::vector<snd_seq_event_t> _idle_sent_notes;       
     Param *_num_steps_param;
-    std::vector<PhraseSeqEvent> _phrase_seq_events;
-    std::vector<PhraseSeqEvent>::iterator _phrase_seq_events_itr;
-    std::vector<PhraseSeqEvent> _phrase_seq_note_on_events;
+    PhraseSeqTimeline _phrase_seq;
+    std::vector<uint> _phrase_seq_note_on_events;
     std::atomic<uint32_t> _ticks;
     uint32_t _end_of_phrase_ticks;
     uint _clock_pulse_count;
     bool _overdub;
-    bool _overdub_started;
     std::vector<unsigned char> _seq_played_notes;
     unsigned char _current_midi_channel = 0;
     Param *_midi_clk_in_param;
+    std::mutex _save_phrase_seq_mutex;
+    std::condition_variable _save_phrase_seq_cv;
+    bool _save_phrase_seq_running;
     bool _save_phrase_seq;
+    bool _save_phrase_seq_full;
+    std::vector<PhraseSeqEvent> _save_phrase_seq_events;
+    std::chrono::steady_clock::time_point _save_phrase_seq_time;
+    bool _phrase_seq_full_save;
+    uint _phrase_seq_saved_size;
     bool _round_to_bar;
     uint _round_bar_count;
     common::TempoNoteValue _tempo_note_value;
+    std::chrono::steady_clock::time_point _send_time;
 
     // Private functions
     void _process_param_changed_event(const ParamChange &param_change);
@@ -208,6 +203,7 @@ private:
     void _stop_seq();
     void _clear_idle_sent_notes();    
     void _send_note(const snd_seq_event_t &note);
+    void _forward_note(const snd_seq_event_t &note);
     void _set_sys_func_switch(SystemFuncType system_func_type, bool set);
     void _set_multifn_switch(uint index, bool reset_other_switches);
     void _send_step_seq_note();
@@ -219,13 +215,16 @@ private:
     void _set_seq_step_param(uint step);
     void _check_for_phrase_held_notes();
     void _append_end_phrase_event();
-    void _sort_phrase_seq();
     void _load_seq_chunks();
-    void _save_seq_chunks(const std::vector<PhraseSeqEvent>& seq);
+    void _request_save_phrase_seq();
+    void _cancel_save_phrase_seq();
+    void _save_seq_chunks(const std::vector<PhraseSeqEvent>& seq, uint first_changed);
+    void _save_seq_chunk(Param *param, const std::string& chunk_notes);
+    void _add_phrase_seq_note_event(PhraseSeqEvent& note_event);
     void _quantise_seq();
-    void _quantise_note_event(std::vector<PhraseSeqEvent>::iterator note_event_itr);
-    void _quantise_note_on_event(std::vector<PhraseSeqEvent>::iterator note_on_event_itr);
-    void _quantise_note_off_event(std::vector<PhraseSeqEvent>::iterator note_on_event_itr, std::vector<PhraseSeqEvent>::iterator note_off_event_itr);
+    void _quantise_phrase_seq_event(PhraseSeqEvent& event, const PhraseSeqEvent *note_on_event);
+    void _quantise_note_on_event(PhraseSeqEvent& note_on_event);
+    void _quantise_note_off_event(const PhraseSeqEvent& note_on_event, PhraseSeqEvent& note_off_event);
     inline uint32_t _quantise_ticks(uint32_t ticks); 
     inline uint32_t _quantise_ticks(uint32_t ticks, uint phrase_note_pulse_count, bool round_up=false); 
 };
@@ -12,10 +12,13 @@
 #include <sys/reboot.h>
 #include "event.h"
 #include "event_router.h"
+#include "event_trace.h"
+#include "metrics.h"
 #include "sw_manager.h"
 #include "sfc_manager.h"
 #include "utils.h"
 #include "logger.h"
+#include "thread_config.h"
 
 // Constants
 constexpr uint POLL_THRESH_COUNT                    = 300;
@@ -31,6 +34,11 @@ constexpr uint SWITCH_TOGGLE_RELEASE_THRESHOLD      = std::chrono::milliseconds(
 constexpr uint SWITCH_TOGGLE_HOLD_THRESHOLD         = std::chrono::milliseconds(1000).count();
 constexpr uint SWITCH_GROUPED_PUSH_HOLD_THRESHOLD   = std::chrono::milliseconds(1000).count();
 
+// Static variables
+static Metric _poll_overruns("sfc_poll_overruns_total", MetricType::COUNTER);
+static MetricTiming _poll_timing("sfc_poll");
+static Metric _panel_frame_follow_ups("sfc_panel_frame_follow_ups_total", MetricType::COUNTER);
+
 // Static functions
 static void *_process_sfc_control(void* data);
 
@@ -38,7 +46,7 @@ static void *_process_sfc_control(void* data);
 // SfcManager
 //----------------------------------------------------------------------------
 SfcManager::SfcManager(EventRouter *event_router) :
-    BaseManager(MoniqueModule::SFC_CONTROL, "SurfaceControlManager", event_router)
+    BaseManager(MoniqueModule::SFC_CONTROL, "SurfaceControlManager", event_router, ExecutorPriority::HIGH_IO)
 {
     // Initialise class data
     for (uint i=0; i<NUM_PHYSICAL_KNOBS; i++) {
@@ -67,6 +75,7 @@ SfcManager::SfcManager(EventRouter *event_router) :
     _reload_presets_listener = 0;
     _exit_sfc_control_thread = false;
     _preset_reloaded = false;
+    _panel_frame_follow_up_posted = false;
 
     // Register the Surface params
     _register_params();
@@ -176,6 +185,7 @@ bool SfcManager::start()
         pthread_getschedparam(_sfc_control_thread->native_handle(), &policy, &param);
         param.sched_priority = 1;
         pthread_setschedparam(_sfc_control_thread->native_handle(), SCHED_FIFO, &param);
+        ThreadConfig::Apply(_sfc_control_thread->native_handle(), "sfc_control");
 #endif
     }
 
@@ -295,6 +305,12 @@ void SfcManager::process_sfc_control()
     // Loop forever until exited
     while (!_exit_sfc_control_thread && !poweroff) {
         {
+            // Each poll starts a new event chain - any events posted while processing the
+            // controls are traced as part of it
+            EventTraceContext trace_context(EventTrace::NewId());
+            EventTraceScope trace_scope(name(), "process_sfc_control");
+            auto poll_start = std::chrono::steady_clock::now();
+
             // Get the Surface control mutex
             std::lock_guard<std::mutex> lock(_sfc_mutex);
             bool morph_params_changed = false;
@@ -306,15 +322,28 @@ void SfcManager::process_sfc_control()
                 // processing      
                 utils::morph_lock();
                 if (utils::get_morph_state() || utils::get_prev_morph_state()) {
-                    // Yes - if we are in morph dance mode, retrieve the state params
+                    // Yes - if we are in morph dance mode, morph the state params
                     if (utils::morph_mode() == Monique::MorphMode::DANCE) {
-                        // Dance mode, retrieve the params
-                        auto s = std::chrono::steady_clock::now();
-                        morph_params_changed = static_cast<DawManager *>(utils::get_manager(MoniqueModule::DAW))->get_layer_patch_state_params();
-                        auto f = std::chrono::steady_clock::now();
-                        float tt = std::chrono::duration_cast<std::chrono::microseconds>(f - s).count();
-                        if(tt > 15000) {
-                            MSG("get_layer_patch_state_params time (us): " << tt);
+                        auto daw_manager = static_cast<DawManager *>(utils::get_manager(MoniqueModule::DAW));
+                        bool local_morph = utils::system_config()->get_local_morph();
+                        if (local_morph) {
+                            // Dance mode, morph the params locally
+                            morph_params_changed = daw_manager->morph_layer_patch_state_params(!utils::get_prev_morph_state());
+                        }
+
+                        // Retrieve the params from the DAW - on every poll, or if morphing locally
+                        // once morphing has finished, so the final values are exactly the DAW's
+                        // Note: The local morph is not the default until it has been verified
+                        // against the DAW morph
+                        if (!local_morph || !utils::get_morph_state()) {
+                            auto s = std::chrono::steady_clock::now();
+                            morph_params_changed |= (local_morph ? daw_manager->resync_layer_patch_state_params() :
+                                                                   daw_manager->get_layer_patch_state_params());
+                            auto f = std::chrono::steady_clock::now();
+                            float tt = std::chrono::duration_cast<std::chrono::microseconds>(f - s).count();
+                            if(tt > 15000) {
+                                MSG("get_layer_patch_state_params time (us): " << tt);
+                            }
                         }
                     }
                 }
@@ -401,6 +430,13 @@ void SfcManager::process_sfc_control()
             if (!utils::maintenance_mode()) {
                 _commit_led_control_states();
             }
+
+            // Record the poll processing time, and if it overran the poll time
+            auto poll_time_taken = std::chrono::steady_clock::now() - poll_start;
+            _poll_timing.record(poll_time_taken);
+            if (poll_time_taken > std::chrono::nanoseconds(SFC_HW_POLL_NANOSECONDS)) {
+                _poll_overruns.inc();
+            }
         }
 
 #ifndef NO_XENOMAI
@@ -445,6 +481,8 @@ void SfcManager::_process_reload_presets(bool from_layer_toggle)
     }
 
     // Process the initial state and preset value for each knob
+    // Note: The knobs are set together as a single panel frame
+    sfc::PanelFrame panel_frame;
     for (uint i=1; i<NUM_PHYSICAL_KNOBS; i++) {
         // Process this knob if:
         // - It is not morphable OR
@@ -452,9 +490,10 @@ void SfcManager::_process_reload_presets(bool from_layer_toggle)
         const KnobParam *param = static_cast<const KnobParam *>(utils::get_param(KnobParam::ParamPath(i).c_str()));
         if (param && (!param->morphable() || !morphing)) {
             // Set the knob control position from the knob param preset
-            _set_knob_control_position_from_preset(param);
+            _set_knob_control_position_from_preset(param, panel_frame);
         }
     }
+    _apply_panel_frame(panel_frame);
 
     // Process the initial state and preset value for each switch
     for (uint i=0; i<NUM_PHYSICAL_SWITCHES; i++) {
@@ -580,19 +619,21 @@ void SfcManager::_process_sfc_func(const SfcFunc &sfc_func)
 
         case SfcFuncType::SET_CONTROLS_STATE: {
             // Get all the params associated with state to set
-            auto params = utils::get_params_with_state(sfc_func.controls_state);
+            auto params = utils::get_params_with_state(sfc_func.controls_state_id);
 
             // Process the state params
+            // Note: The knobs are set together as a single panel frame
+            sfc::PanelFrame panel_frame;
             for (SfcControlParam *p : params) {
                 // Set the new control state
-                if (p->set_control_state(sfc_func.controls_state)) {
+                if (p->set_control_state(sfc_func.controls_state_id)) {
                     // Are we changing a knob control state?
                     if (p->control_type() == sfc::ControlType::KNOB) {
                         // Set the knob control haptic mode
-                        _set_knob_control_haptic_mode(static_cast<KnobParam *>(p));
+                        panel_frame.set_knob_haptic_mode(p->param_id(), static_cast<KnobParam *>(p)->haptic_mode());
                                                         
                         // Now set the knob position from the param
-                        _set_knob_control_position(static_cast<KnobParam *>(p));
+                        _set_knob_control_position(static_cast<KnobParam *>(p), panel_frame);
 
                         // Create the control param change event
                         //auto mapped_param_change = ParamChange(p, module());
@@ -609,6 +650,17 @@ void SfcManager::_process_sfc_func(const SfcFunc &sfc_func)
                     }
                 }         
             }
+            _apply_panel_frame(panel_frame);
+            break;
+        }
+
+        case SfcFuncType::APPLY_PANEL_FRAME: {
+            // Apply the knobs still pending from a previous panel frame
+            {
+                std::lock_guard<std::mutex> lock(_panel_frame_mutex);
+                _panel_frame_follow_up_posted = false;
+            }
+            _apply_panel_frame(sfc::PanelFrame());
             break;
         }
 
@@ -620,16 +672,16 @@ void SfcManager::_process_sfc_func(const SfcFunc &sfc_func)
 //----------------------------------------------------------------------------
 // _set_knob_control_position_from_preset
 //----------------------------------------------------------------------------
-void SfcManager::_set_knob_control_position_from_preset(const KnobParam *param)
+void SfcManager::_set_knob_control_position_from_preset(const KnobParam *param, sfc::PanelFrame& panel_frame)
 {
     // Is this knob active?
     if (sfc::knob_is_active(param->control_num())) {        
         // Set the knob control haptic mode
-        _set_knob_control_haptic_mode(param);
+        panel_frame.set_knob_haptic_mode(param->param_id(), param->haptic_mode());
     }
 
     // Set the knob position from the param
-    _set_knob_control_position(param);
+    _set_knob_control_position(param, panel_frame);
 }
 
 //----------------------------------------------------------------------------
@@ -788,7 +840,13 @@ void SfcManager::_set_knob_control_position(const KnobParam *param, bool robust)
             if (sfc::knob_is_active(num))
             {
                 // Get the hardware position
+                // Note: This position replaces any still pending from a panel frame
                 uint32_t pos = param->hw_value();
+                {
+                    std::lock_guard<std::mutex> lock(_panel_frame_mutex);
+                    _pending_panel_frame.clear_knob_position(num);
+                    _superseded_panel_frame.set_knob_position(num, pos);
+                }
 
                 // Set the target knob position in the hardware
                 int res = sfc::set_knob_position(num, pos, robust);
@@ -802,6 +860,27 @@ void SfcManager::_set_knob_control_position(const KnobParam *param, bool robust)
     }
 }
 
+//----------------------------------------------------------------------------
+// _set_knob_control_position
+//----------------------------------------------------------------------------
+void SfcManager::_set_knob_control_position(const KnobParam *param, sfc::PanelFrame& panel_frame)
+{    
+    // No point doing anything if the Surface Control isn't initialised
+    if (_sfc_control_init)
+    {
+        // The knob number is stored in the param ID
+        uint num = param->param_id();
+
+        // Knob 0 is a special case and we *never* go to position on this knob
+        // (it is a relative position knob)
+        if (num && sfc::knob_is_active(num))
+        {
+            // Set the target knob position in the panel frame
+            panel_frame.set_knob_position(num, param->hw_value());
+        }
+    }
+}
+
 //----------------------------------------------------------------------------
 // _set_switch_control_value
 //----------------------------------------------------------------------------
@@ -831,6 +910,12 @@ void SfcManager::_set_switch_control_value(const SwitchParam *param)
 void SfcManager::_set_knob_control_haptic_mode(const KnobParam *param)
 {
     // Set the knob haptic mode
+    // Note: This haptic mode replaces any still pending from a panel frame
+    {
+        std::lock_guard<std::mutex> lock(_panel_frame_mutex);
+        _pending_panel_frame.clear_knob_haptic_mode(param->param_id());
+        _superseded_panel_frame.set_knob_haptic_mode(param->param_id(), param->haptic_mode());
+    }
     int res = sfc::set_knob_haptic_mode(param->param_id(), param->haptic_mode());
     if (res < 0)
     {
@@ -839,6 +924,59 @@ void SfcManager::_set_knob_control_haptic_mode(const KnobParam *param)
     }
 }
 
+//----------------------------------------------------------------------------
+// _apply_panel_frame
+//----------------------------------------------------------------------------
+void SfcManager::_apply_panel_frame(const sfc::PanelFrame& panel_frame)
+{
+    sfc::PanelFrame frame;
+
+    // Add the frame to any knobs still pending from a previous frame - the knobs in
+    // this frame take precedence - and take the frame to apply
+    // Note: Panel frames are only applied by this manager's event processing, so only
+    // one frame is applied at a time
+    {
+        std::lock_guard<std::mutex> lock(_panel_frame_mutex);
+        _pending_panel_frame.merge(panel_frame);
+        if (!_sfc_control_init)
+        {
+            // No point doing anything if the Surface Control isn't initialised
+            return;
+        }
+        frame = _pending_panel_frame;
+        _pending_panel_frame = sfc::PanelFrame();
+        _superseded_panel_frame = sfc::PanelFrame();
+    }
+
+    // Apply the knob haptic modes and positions
+    // Note: The panel frame mutex is not held while the frame is written, as this
+    // can take until the frame deadline. Any knobs not applied within the frame
+    // deadline are returned as remaining
+    sfc::PanelFrame remaining;
+    int res = sfc::apply_panel_frame(frame, remaining);
+    if (res < 0)
+    {
+        // Error applying the panel frame
+        MSG("ERROR: Could not apply the surface control panel frame: " << res);
+    }
+
+    // The remaining knobs are still pending, unless set directly while the frame was
+    // being written, and any knobs pending since take precedence
+    std::lock_guard<std::mutex> lock(_panel_frame_mutex);
+    remaining.remove(_superseded_panel_frame);
+    remaining.merge(_pending_panel_frame);
+    _pending_panel_frame = remaining;
+
+    // If any knobs are still pending, apply them in a follow-up frame, queued after
+    // any events already posted to this manager
+    if (!_pending_panel_frame.empty() && !_panel_frame_follow_up_posted)
+    {
+        _panel_frame_follow_up_posted = true;
+        _panel_frame_follow_ups.inc();
+        post_msg(new SfcFuncEvent(SfcFunc(SfcFuncType::APPLY_PANEL_FRAME, module())));
+    }
+}
+
 //----------------------------------------------------------------------------
 // _process_knob_control
 //----------------------------------------------------------------------------
@@ -1295,7 +1433,7 @@ void SfcManager::_process_physical_switch(SwitchParam *param, const bool *physic
                     if (switch_control.led_pulse_timer == nullptr) {
                         // Start the switch LED timer task
                         switch_control.led_state = true;
-                        switch_control.led_pulse_timer = new Timer(TimerType::PERIODIC);
+                        switch_control.led_pulse_timer = new Timer(TimerType::PERIODIC, ExecutorPriority::NORMAL);
                         switch_control.led_pulse_timer->start(SWITCH_TOGGLE_LED_DUTY, 
                             std::bind(&SfcManager::_switch_led_pulse_timer_callback, 
                                 this, &switch_control));                   
@@ -1661,7 +1799,7 @@ void SfcManager::_set_switch_led_state(const SwitchParam *param)
                 if (switch_control.led_pulse_timer == nullptr) {
                     // Start the switch LED timer task
                     switch_control.led_state = true;
-                    switch_control.led_pulse_timer = new Timer(TimerType::PERIODIC);
+                    switch_control.led_pulse_timer = new Timer(TimerType::PERIODIC, ExecutorPriority::NORMAL);
                     switch_control.led_pulse_timer->start(SWITCH_TOGGLE_LED_DUTY, 
                         std::bind(&SfcManager::_switch_led_pulse_timer_callback, 
                             this, &switch_control));                      
@@ -1681,7 +1819,7 @@ void SfcManager::_set_switch_led_state(const SwitchParam *param)
                 if (switch_control.led_pulse_timer == nullptr) {
                     // Start the switch LED timer task
                     switch_control.led_state = true;
-                    switch_control.led_pulse_timer = new Timer(TimerType::PERIODIC);
+                    switch_control.led_pulse_timer = new Timer(TimerType::PERIODIC, ExecutorPriority::NORMAL);
                     switch_control.led_pulse_timer->start(SWITCH_TOGGLE_LED_DUTY, 
                         std::bind(&SfcManager::_switch_led_pulse_timer_callback, 
                             this, &switch_control));
@@ -1744,7 +1882,7 @@ void SfcManager::_set_switch_led_state(const SwitchParam *param, SwitchValue led
             if (switch_control.led_pulse_timer == nullptr) {
                 // Start the switch LED timer task
                 switch_control.led_state = true;
-                switch_control.led_pulse_timer = new Timer(TimerType::PERIODIC);
+                switch_control.led_pulse_timer = new Timer(TimerType::PERIODIC, ExecutorPriority::NORMAL);
                 switch_control.led_pulse_timer->start(SWITCH_TOGGLE_LED_DUTY, 
                     std::bind(&SfcManager::_switch_led_pulse_timer_callback, 
                         this, &switch_control));                 
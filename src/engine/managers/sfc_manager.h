@@ -91,20 +91,26 @@ private:
     std::atomic<bool> _exit_sfc_control_thread;
     bool _sfc_control_init;
     bool _preset_reloaded;
+    std::mutex _panel_frame_mutex;
+    sfc::PanelFrame _pending_panel_frame;
+    sfc::PanelFrame _superseded_panel_frame;
+    bool _panel_frame_follow_up_posted;
 
     // Private functions
     void _process_param_changed_event(const ParamChange &param_change);
     void _process_reload_presets(bool from_layer_toggle);
     void _process_sfc_func(const SfcFunc &sfc_func);
-    void _set_knob_control_position_from_preset(const KnobParam *param);
+    void _set_knob_control_position_from_preset(const KnobParam *param, sfc::PanelFrame& panel_frame);
     void _set_switch_control_value_from_preset(const SwitchParam *param);
     void _process_sfc_param_changed(Param *param);
     void _process_param_changed_mapped_params(const Param *param, float diff, const Param *skip_param, bool displayed, bool force=false);
     void _send_knob_control_param_change_events(const Param *param, float diff);
     void _send_control_param_change_events(const Param *param, bool force=false);
     void _set_knob_control_position(const KnobParam *param, bool robust=true);
+    void _set_knob_control_position(const KnobParam *param, sfc::PanelFrame& panel_frame);
     void _set_switch_control_value(const SwitchParam *param);
     void _set_knob_control_haptic_mode(const KnobParam *param);
+    void _apply_panel_frame(const sfc::PanelFrame& panel_frame);
     void _process_knob_control(uint num, const sfc::KnobState &knob_state, bool morphing);
     void _process_switch_control(uint num, const bool *physical_states, bool morphing);
     void _process_physical_knob(KnobParam *param, KnobControl &knob_control, const sfc::KnobState &knob_state);
@@ -69,7 +69,7 @@ static int _msd_device_handler(sd_device_monitor *m, sd_device *device, void *us
 // SwManager
 //----------------------------------------------------------------------------
 SwManager::SwManager(EventRouter *event_router) : 
-    BaseManager(MoniqueModule::SOFTWARE, "SwManager", event_router)
+    BaseManager(MoniqueModule::SOFTWARE, "SwManager", event_router, ExecutorPriority::BACKGROUND)
 {
     // Initialise class data
     _sw_update_thread = nullptr;
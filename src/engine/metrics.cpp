@@ -0,0 +1,298 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  metrics.cpp
+ * @brief Metrics implementation.
+ *-----------------------------------------------------------------------------
+ */
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "ui_common.h"
+#include "metrics.h"
+
+// Constants
+constexpr char METRICS_SOCKET_PATH[]    = "/tmp/delia_ui_metrics.sock";
+constexpr uint METRICS_SOCKET_BACKLOG   = 4;
+constexpr int METRICS_POLL_TIMEOUT_MS   = 100;
+
+// Metrics Registry
+// Note: Accessed via a function, so that metrics defined as static objects in
+// other files can be registered during static initialisation
+struct MetricsRegistry
+{
+    std::mutex mutex;
+    std::vector<Metric *> metrics;
+};
+
+// Static variables
+static std::atomic<bool> _running = false;
+static std::thread *_server_thread = nullptr;
+static int _server_socket = -1;
+
+//----------------------------------------------------------------------------
+// _registry
+//----------------------------------------------------------------------------
+static MetricsRegistry& _registry()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
+
+//----------------------------------------------------------------------------
+// _family
+//----------------------------------------------------------------------------
+static std::string _family(const std::string& name)
+{
+    // The metric family is the metric name without any labels
+    return name.substr(0, name.find('{'));
+}
+
+//----------------------------------------------------------------------------
+// _suffixed_name
+//----------------------------------------------------------------------------
+static std::string _suffixed_name(const std::string& name, const char *suffix)
+{
+    // Add the suffix to the metric family, before any labels
+    auto family = _family(name);
+    return family + suffix + name.substr(family.size());
+}
+
+//----------------------------------------------------------------------------
+// _process_server
+//----------------------------------------------------------------------------
+static void _process_server()
+{
+    pollfd pfd = {_server_socket, POLLIN, 0};
+
+    // Serve a snapshot to each client that connects, until stopped
+    while (_running) {
+        if ((::poll(&pfd, 1, METRICS_POLL_TIMEOUT_MS) > 0) && (pfd.revents & POLLIN)) {
+            int client = ::accept(_server_socket, nullptr, nullptr);
+            if (client >= 0) {
+                // Write the snapshot and close the connection
+                auto snapshot = Metrics::Snapshot();
+                const char *data = snapshot.data();
+                size_t len = snapshot.size();
+                while (len > 0) {
+                    auto res = ::send(client, data, len, MSG_NOSIGNAL);
+                    if (res <= 0) {
+                        break;
+                    }
+                    data += res;
+                    len -= res;
+                }
+                ::close(client);
+            }
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Metric
+//----------------------------------------------------------------------------
+Metric::Metric(const std::string& name, MetricType type) : _name(name), _type(type), _value(0)
+{
+    // Add this metric to the snapshot
+    Metrics::_Register(this);
+}
+
+//----------------------------------------------------------------------------
+// ~Metric
+//----------------------------------------------------------------------------
+Metric::~Metric()
+{
+    // Remove this metric from the snapshot
+    Metrics::_Unregister(this);
+}
+
+//----------------------------------------------------------------------------
+// name
+//----------------------------------------------------------------------------
+const std::string& Metric::name() const
+{
+    return _name;
+}
+
+//----------------------------------------------------------------------------
+// type
+//----------------------------------------------------------------------------
+MetricType Metric::type() const
+{
+    return _type;
+}
+
+//----------------------------------------------------------------------------
+// value
+//----------------------------------------------------------------------------
+int64_t Metric::value() const
+{
+    return _value.load(std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------
+// inc
+//----------------------------------------------------------------------------
+void Metric::inc(int64_t n)
+{
+    _value.fetch_add(n, std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------
+// set
+//----------------------------------------------------------------------------
+void Metric::set(int64_t value)
+{
+    _value.store(value, std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------
+// set_max
+//----------------------------------------------------------------------------
+void Metric::set_max(int64_t value)
+{
+    // Set the value if it is greater than the current value
+    int64_t current = _value.load(std::memory_order_relaxed);
+    while ((value > current) && !_value.compare_exchange_weak(current, value, std::memory_order_relaxed));
+}
+
+//----------------------------------------------------------------------------
+// MetricTiming
+//----------------------------------------------------------------------------
+MetricTiming::MetricTiming(const std::string& name) :
+    _count(_suffixed_name(name, "_count"), MetricType::COUNTER),
+    _total_us(_suffixed_name(name, "_us_sum"), MetricType::COUNTER),
+    _max_us(_suffixed_name(name, "_us_max"), MetricType::GAUGE)
+{
+    // Nothing specific to do
+}
+
+//----------------------------------------------------------------------------
+// record
+//----------------------------------------------------------------------------
+void MetricTiming::record(std::chrono::steady_clock::duration duration)
+{
+    // Add the timing
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    _count.inc();
+    _total_us.inc(us);
+    _max_us.set_max(us);
+}
+
+//----------------------------------------------------------------------------
+// Start
+//----------------------------------------------------------------------------
+void Metrics::Start()
+{
+    // If the server is not already running
+    if (!_server_thread) {
+        // Create the metrics socket, replacing any left from a previous run
+        _server_socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (_server_socket < 0) {
+            MSG("Metrics: Could not create the socket: " << std::strerror(errno));
+            return;
+        }
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, METRICS_SOCKET_PATH, sizeof(addr.sun_path) - 1);
+        ::unlink(METRICS_SOCKET_PATH);
+        if ((::bind(_server_socket, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) ||
+            (::listen(_server_socket, METRICS_SOCKET_BACKLOG) < 0)) {
+            MSG("Metrics: Could not open the socket " << METRICS_SOCKET_PATH << ": " << std::strerror(errno));
+            ::close(_server_socket);
+            _server_socket = -1;
+            return;
+        }
+
+        // Start the server thread
+        _running = true;
+        _server_thread = new std::thread(_process_server);
+    }
+}
+
+//----------------------------------------------------------------------------
+// Stop
+//----------------------------------------------------------------------------
+void Metrics::Stop()
+{
+    // Stop the server thread and remove the socket
+    if (_server_thread) {
+        _running = false;
+        if (_server_thread->joinable()) {
+            _server_thread->join();
+        }
+        delete _server_thread;
+        _server_thread = nullptr;
+        ::close(_server_socket);
+        _server_socket = -1;
+        ::unlink(METRICS_SOCKET_PATH);
+    }
+}
+
+//----------------------------------------------------------------------------
+// Snapshot
+//----------------------------------------------------------------------------
+std::string Metrics::Snapshot()
+{
+    std::vector<std::pair<std::string, int64_t>> values;
+    std::vector<MetricType> types;
+    std::ostringstream snapshot;
+
+    // Get the current value of each metric, grouped by metric family
+    {
+        auto& registry = _registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        std::vector<Metric *> metrics = registry.metrics;
+        std::sort(metrics.begin(), metrics.end(), [](const Metric *a, const Metric *b) {
+            auto a_family = _family(a->name());
+            auto b_family = _family(b->name());
+            return (a_family != b_family) ? (a_family < b_family) : (a->name() < b->name());
+        });
+        for (const Metric *m : metrics) {
+            values.emplace_back(m->name(), m->value());
+            types.push_back(m->type());
+        }
+    }
+
+    // Write each metric, with the type of each metric family (the metric name
+    // without any labels)
+    std::string family;
+    for (uint i=0; i<values.size(); i++) {
+        auto& [name, value] = values[i];
+        auto name_family = _family(name);
+        if (name_family != family) {
+            family = name_family;
+            snapshot << "# TYPE " << family << ((types[i] == MetricType::COUNTER) ? " counter\n" : " gauge\n");
+        }
+        snapshot << name << ' ' << value << '\n';
+    }
+    return snapshot.str();
+}
+
+//----------------------------------------------------------------------------
+// _Register
+//----------------------------------------------------------------------------
+void Metrics::_Register(Metric *metric)
+{
+    auto& registry = _registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.metrics.push_back(metric);
+}
+
+//----------------------------------------------------------------------------
+// _Unregister
+//----------------------------------------------------------------------------
+void Metrics::_Unregister(Metric *metric)
+{
+    auto& registry = _registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    std::erase(registry.metrics, metric);
+}
@@ -0,0 +1,92 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  metrics.h
+ * @brief Metrics class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _METRICS_H
+#define _METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+// Metric Type
+enum class MetricType
+{
+    COUNTER,
+    GAUGE
+};
+
+// Metric
+// A named counter or gauge, which is included in the metrics snapshot while it
+// exists. Labels can be added to the name in the text format, e.g.
+// events_total{type="midi"}
+// Note: Updating a metric is a single relaxed atomic operation, so metrics can
+// be updated from any thread, including RT threads
+class Metric
+{
+public:
+    // Constructor/destructor
+    Metric(const std::string& name, MetricType type);
+    ~Metric();
+
+    // Public functions
+    const std::string& name() const;
+    MetricType type() const;
+    int64_t value() const;
+    void inc(int64_t n = 1);
+    void set(int64_t value);
+    void set_max(int64_t value);
+
+private:
+    // Private variables
+    std::string _name;
+    MetricType _type;
+    std::atomic<int64_t> _value;
+};
+
+// Metric Timing
+// Count, total and maximum of a timed operation, in microseconds. These are
+// reported as the _count, _us_sum and _us_max metric families of the name, with
+// any labels in the name added to each, e.g. note_timing_error{mode="scheduled"}
+// is reported as note_timing_error_count{mode="scheduled"} etc
+class MetricTiming
+{
+public:
+    // Constructor
+    MetricTiming(const std::string& name);
+
+    // Public functions
+    void record(std::chrono::steady_clock::duration duration);
+
+private:
+    // Private variables
+    Metric _count;
+    Metric _total_us;
+    Metric _max_us;
+};
+
+// Metrics
+// Serves a snapshot of all metrics, in the Prometheus text format, to each
+// client that connects to the metrics Unix domain socket, for example:
+// socat - UNIX-CONNECT:/tmp/delia_ui_metrics.sock
+class Metrics
+{
+public:
+    // Public functions
+    static void Start();
+    static void Stop();
+    static std::string Snapshot();
+
+private:
+    friend class Metric;
+
+    // Private functions
+    static void _Register(Metric *metric);
+    static void _Unregister(Metric *metric);
+};
+
+#endif // _METRICS_H
@@ -0,0 +1,233 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  note_scheduler.cpp
+ * @brief Note Scheduler implementation.
+ *-----------------------------------------------------------------------------
+ */
+#include <algorithm>
+#include <pthread.h>
+#include "note_scheduler.h"
+#include "ui_common.h"
+#include "thread_config.h"
+#include "metrics.h"
+
+// Constants
+constexpr uint NOTE_SCHEDULER_RESERVE_SIZE = 256;
+constexpr uint NOTE_SCHEDULER_STATS_COUNT  = 1000;
+
+// Static variables
+static MetricTiming _unscheduled_timing("note_timing_error{mode=\"unscheduled\"}");
+static MetricTiming _scheduled_timing("note_timing_error{mode=\"scheduled\"}");
+
+//----------------------------------------------------------------------------
+// NoteScheduler
+//----------------------------------------------------------------------------
+NoteScheduler::NoteScheduler()
+{
+    // Initialise class data
+    _running = false;
+    _thread = 0;
+    _send_fn = 0;
+    _notes.reserve(NOTE_SCHEDULER_RESERVE_SIZE);
+    _order = 0;
+    _schedule_stats = {};
+    _send_stats = {};
+}
+
+//----------------------------------------------------------------------------
+// ~NoteScheduler
+//----------------------------------------------------------------------------
+NoteScheduler::~NoteScheduler()
+{
+    // Stop the scheduler if running
+    stop();
+}
+
+//----------------------------------------------------------------------------
+// start
+//----------------------------------------------------------------------------
+void NoteScheduler::start(std::function<void(const snd_seq_event_t&)> send_fn)
+{
+    // Assumes the scheduler is stopped if already running
+
+    // Set the send function and indicate the scheduler is now running
+    _send_fn = send_fn;
+    _running = true;
+
+    // Create a SCHED_FIFO thread to send the scheduled notes - so that it has
+    // priority over the threads generating the notes
+    int policy;
+    struct sched_param param;
+    _thread = new std::thread(&NoteScheduler::_process_scheduled_notes, this);
+    pthread_getschedparam(_thread->native_handle(), &policy, &param);
+    param.sched_priority = 1;
+    pthread_setschedparam(_thread->native_handle(), SCHED_FIFO, &param);
+    ThreadConfig::Apply(_thread->native_handle(), "note_scheduler");
+}
+
+//----------------------------------------------------------------------------
+// stop
+//----------------------------------------------------------------------------
+void NoteScheduler::stop()
+{
+    // Stop the scheduler
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        _running = false;
+    }
+    _cv.notify_all();
+
+    // Stop the scheduler thread
+    if (_thread) {
+        // Wait for the scheduler thread to finish and delete it
+        if (_thread->joinable())
+            _thread->join();
+        delete _thread;
+        _thread = 0;
+    }
+
+    // Send any NOTE OFFs still scheduled, in deadline order, so that no note is left
+    // hanging - any NOTE ONs still scheduled are discarded
+    // Note: The scheduler thread has exited, so the mutex is not needed
+    std::sort_heap(_notes.begin(), _notes.end(), _later);
+    for (auto itr = _notes.rbegin(); itr != _notes.rend(); itr++) {
+        if ((itr->event.type == SND_SEQ_EVENT_NOTEOFF) || ((itr->event.type == SND_SEQ_EVENT_NOTEON) && (itr->event.data.note.velocity == 0))) {
+            _send_fn(itr->event);
+        }
+    }
+    _notes.clear();
+}
+
+//----------------------------------------------------------------------------
+// schedule
+//----------------------------------------------------------------------------
+bool NoteScheduler::schedule(const snd_seq_event_t& event, std::chrono::steady_clock::time_point time)
+{
+    auto now = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+
+        // If this NOTE ON was sent for a tempo pulse, record how late it was generated
+        // relative to its tempo pulse - this is the timing error if the note is sent
+        // immediately
+        bool timed = (time != NOTE_SCHEDULER_SEND_NOW);
+        if (timed && (event.type == SND_SEQ_EVENT_NOTEON) && (event.data.note.velocity != 0)) {
+            _update_stats(_schedule_stats, now - (time - NOTE_SCHEDULER_LATENCY));
+            _unscheduled_timing.record(now - (time - NOTE_SCHEDULER_LATENCY));
+        }
+        if (!timed) {
+            time = now;
+        }
+
+        // If the scheduler is not running, the note must be sent immediately
+        if (!_running) {
+            return false;
+        }
+
+        // If this is a NOTE OFF, remove any NOTE ON for this note with a later deadline, as
+        // otherwise it would be sent after the note is stopped (e.g. by the Sequencer or
+        // Arpeggiator being stopped) and never be released
+        if ((event.type == SND_SEQ_EVENT_NOTEOFF) || ((event.type == SND_SEQ_EVENT_NOTEON) && (event.data.note.velocity == 0))) {
+            auto itr = std::remove_if(_notes.begin(), _notes.end(), [&event, time](const ScheduledNote& n) {
+                return (n.time > time) && (n.event.type == SND_SEQ_EVENT_NOTEON) && (n.event.data.note.velocity != 0) &&
+                       (n.event.data.note.channel == event.data.note.channel) && (n.event.data.note.note == event.data.note.note);
+            });
+            if (itr != _notes.end()) {
+                _notes.erase(itr, _notes.end());
+                std::make_heap(_notes.begin(), _notes.end(), _later);
+            }
+        }
+
+        // Add the note to the schedule
+        // Note: Notes with the same deadline are sent in the order they were scheduled
+        _notes.push_back({time, _order++, timed, event});
+        std::push_heap(_notes.begin(), _notes.end(), _later);
+    }
+    _cv.notify_all();
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// _process_scheduled_notes
+//----------------------------------------------------------------------------
+void NoteScheduler::_process_scheduled_notes()
+{
+    // Do forever until stopped
+    std::unique_lock<std::mutex> lk(_mutex);
+    while (_running) {
+        // Wait for a note to be scheduled
+        if (_notes.empty()) {
+            _cv.wait(lk);
+            continue;
+        }
+
+        // Wait for the deadline of the next note, or for an earlier note to be scheduled
+        auto time = _notes.front().time;
+        if (std::chrono::steady_clock::now() < time) {
+            _cv.wait_until(lk, time);
+            continue;
+        }
+
+        // Take the next note from the schedule
+        std::pop_heap(_notes.begin(), _notes.end(), _later);
+        auto note = _notes.back();
+        _notes.pop_back();
+
+        // Send the note without the mutex held, and if a NOTE ON sent for a tempo pulse,
+        // record how late it was sent
+        lk.unlock();
+        auto now = std::chrono::steady_clock::now();
+        _send_fn(note.event);
+        lk.lock();
+        if (note.timed && (note.event.type == SND_SEQ_EVENT_NOTEON) && (note.event.data.note.velocity != 0)) {
+            _update_stats(_send_stats, now - time);
+            _scheduled_timing.record(now - time);
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// _update_stats
+//----------------------------------------------------------------------------
+void NoteScheduler::_update_stats(TimingStats& stats, std::chrono::steady_clock::duration error)
+{
+    // Note: Assumes the mutex is held
+    int64_t error_us = std::chrono::duration_cast<std::chrono::microseconds>(error).count();
+    stats.total_us += error_us;
+    stats.max_us = std::max(stats.max_us, error_us);
+    stats.count++;
+
+    // Report the stats once enough notes have been recorded
+    if (stats.count >= NOTE_SCHEDULER_STATS_COUNT) {
+        _report_stats();
+    }
+}
+
+//----------------------------------------------------------------------------
+// _later
+//----------------------------------------------------------------------------
+bool NoteScheduler::_later(const ScheduledNote& a, const ScheduledNote& b)
+{
+    // Notes are ordered by deadline, and then by the order they were scheduled
+    return (a.time > b.time) || ((a.time == b.time) && (a.order > b.order));
+}
+
+//----------------------------------------------------------------------------
+// _report_stats
+//----------------------------------------------------------------------------
+void NoteScheduler::_report_stats()
+{
+    // Note: Assumes the mutex is held
+    // Report the timing error if the notes were sent when generated, and the
+    // timing error when sent by the scheduler
+    if (_schedule_stats.count) {
+        DEBUG_MSG("NoteScheduler: Timing error unscheduled (avg/max): " << (_schedule_stats.total_us / _schedule_stats.count) << "/" << _schedule_stats.max_us << "us");
+    }
+    if (_send_stats.count) {
+        DEBUG_MSG("NoteScheduler: Timing error scheduled (avg/max): " << (_send_stats.total_us / _send_stats.count) << "/" << _send_stats.max_us << "us");
+    }
+    _schedule_stats = {};
+    _send_stats = {};
+}
@@ -0,0 +1,89 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  note_scheduler.h
+ * @brief Note Scheduler class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _NOTE_SCHEDULER_H
+#define _NOTE_SCHEDULER_H
+
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <vector>
+#include "alsa/asoundlib.h"
+
+// Constants
+// The time ahead of each tempo pulse at which the Sequencer and Arpeggiator notes
+// are scheduled to be sent
+constexpr auto NOTE_SCHEDULER_LATENCY = std::chrono::microseconds(2000);
+
+// The send time of a Sequencer or Arpeggiator note that is not sent for a tempo
+// pulse (e.g. the NOTE OFFs sent when stopped) - the note is sent immediately
+constexpr auto NOTE_SCHEDULER_SEND_NOW = std::chrono::steady_clock::time_point::min();
+
+// The send time of a note that is not generated by the Sequencer or Arpeggiator
+// (e.g. from the keyboard) - the note is sent directly, and never scheduled
+constexpr auto NOTE_SCHEDULER_SEND_DIRECT = std::chrono::steady_clock::time_point();
+
+// Note Scheduler class
+// Sends each scheduled note at its deadline, so that note timing is not
+// affected by the wake-up latency of the thread that generated the note
+// Note: The scheduler is only started if enabled in the config file - if not
+// started, notes are not scheduled and must be sent immediately by the caller,
+// but the timing error of the NOTE ONs sent immediately is still recorded
+class NoteScheduler
+{
+public:
+    // Constructor
+    NoteScheduler();
+
+    // Destructor
+    ~NoteScheduler();
+
+    // Public functions
+    void start(std::function<void(const snd_seq_event_t&)> send_fn);
+    void stop();
+    bool schedule(const snd_seq_event_t& event, std::chrono::steady_clock::time_point time);
+
+private:
+    // Scheduled Note
+    struct ScheduledNote
+    {
+        std::chrono::steady_clock::time_point time;
+        uint64_t order;
+        bool timed;
+        snd_seq_event_t event;
+    };
+
+    // Timing Stats
+    struct TimingStats
+    {
+        uint count;
+        int64_t total_us;
+        int64_t max_us;
+    };
+
+    // Private data
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    bool _running;
+    std::thread *_thread;
+    std::function<void(const snd_seq_event_t&)> _send_fn;
+    std::vector<ScheduledNote> _notes;
+    uint64_t _order;
+    TimingStats _schedule_stats;
+    TimingStats _send_stats;
+
+    // Private functions
+    void _process_scheduled_notes();
+    void _update_stats(TimingStats& stats, std::chrono::steady_clock::duration error);
+    void _report_stats();
+    static bool _later(const ScheduledNote& a, const ScheduledNote& b);
+};
+
+#endif  // _NOTE_SCHEDULER_H
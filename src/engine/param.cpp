@@ -11,10 +11,13 @@
 #include <cstring>
 #include <cstdlib>
 #include <math.h>
+#include <thread>
 #include "param.h"
 #include "base_manager.h"
 #include "utils.h"
 #include "data_conversion.h"
+#include "param_value_store.h"
+#include "string_pool.h"
 
 // Constants
 constexpr char ARP_PARAM_PATH_PREFIX[]            = "/arp/";
@@ -35,6 +38,8 @@ constexpr uint16_t KNOB_HW_VALUE_NORMAL_THRESHOLD = (FLOAT_TO_KNOB_HW_VALUE_SCAL
 constexpr uint16_t KNOB_HW_VALUE_LARGE_THRESHOLD  = (KNOB_HW_VALUE_NORMAL_THRESHOLD * 2 * 2);
 constexpr uint16_t KNOB_HW_INDENT_WIDTH           = 0.03 * FLOAT_TO_KNOB_HW_VALUE_SCALING_FACTOR;
 constexpr uint16_t KNOB_HW_INDENT_THRESHOLD       = 5;
+constexpr uint32_t DISPLAY_STRING_CACHE_EMPTY     = 0xFFFFFFFF;
+constexpr uint DISPLAY_STRING_CACHE_MAX_LEN       = sizeof(uint64_t);
 
 //---------------------------
 // Param class implementation
@@ -103,7 +108,7 @@ std::unique_ptr<Param> Param::CreateParam(int param_id, std::string param_name,
     auto param = std::make_unique<Param>(MoniqueModule::SYSTEM, data_type);
     param->_param_id = param_id;
     param->_path = Param::ParamPath(param_name);
-    param->_display_name = display_name;
+    param->_display_name = StringPool::Intern(display_name);
     return param;
 }
 
@@ -116,7 +121,7 @@ std::unique_ptr<Param> Param::CreateParam(const BaseManager *mgr, int param_id,
     auto param = std::make_unique<Param>(mgr->module(), data_type);
     param->_param_id = param_id;    
     param->_path = Param::ParamPath(mgr->module(), param_name);
-    param->_display_name = display_name;
+    param->_display_name = StringPool::Intern(display_name);
     return param;
 }
 
@@ -129,7 +134,7 @@ std::unique_ptr<Param> Param::CreateParam(MoniqueModule module, int param_id, st
     auto param = std::make_unique<Param>(module, data_type);
     param->_param_id = param_id;    
     param->_path = Param::ParamPath(module, param_name);
-    param->_display_name = display_name;
+    param->_display_name = StringPool::Intern(display_name);
     return param;
 }
 
@@ -153,6 +158,7 @@ Param::Param(const Param& param) :
     _param_list_display_name = param._param_list_display_name;
     _param_list_type = param._param_list_type;
     _param_list = param._param_list;
+    _param_list_indexes = param._param_list_indexes;
     _mapped_params = param._mapped_params;
     _value =  param._value;
     _num_positions = param._num_positions;
@@ -175,6 +181,9 @@ Param::Param(const Param& param) :
     _mod_src_name = param._mod_src_name;
     _mod_dst_name = param._mod_dst_name;
     _is_seq_chunk_param = param._is_seq_chunk_param;    
+    _display_string_cache_seq = 0;
+    _display_string_cache_value = DISPLAY_STRING_CACHE_EMPTY;
+    _display_string_cache_str = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -191,10 +200,10 @@ Param::Param(MoniqueModule module, ParamDataType data_type) :
     _preset = true;
     _save = true;
     _path = "";
-    _ref = "";
-    _display_name = "";
-    _param_list_name = "";
-    _param_list_display_name = "";
+    _ref = StringPool::Intern("");
+    _display_name = StringPool::Intern("");
+    _param_list_name = StringPool::Intern("");
+    _param_list_display_name = StringPool::Intern("");
     _param_list_type = ParamListType::NORMAL;
     _param_list.clear();
     _mapped_params.clear();
@@ -206,8 +215,8 @@ Param::Param(MoniqueModule module, ParamDataType data_type) :
     _display_range_min = DEFAULT_DISPLAY_RANGE_MIN;
     _display_range_max = DEFAULT_DISPLAY_RANGE_MAX;
     _display_decimal_places = 0;   
-    _value_strings.clear();
-    _value_tags.clear();
+    _value_strings = StringPool::Intern(std::vector<std::string>());
+    _value_tags = StringPool::Intern(std::vector<std::string>());
     _display_as_numeric = false;
     _display_enum_list = true;
     _display_hr_value = false;
@@ -216,9 +225,12 @@ Param::Param(MoniqueModule module, ParamDataType data_type) :
     _linked_param_enabled = false;
     _sfc_control = false;
     _mod_matrix_param = false;
-    _mod_src_name = "";
-    _mod_dst_name = "";
+    _mod_src_name = StringPool::Intern("");
+    _mod_dst_name = StringPool::Intern("");
     _is_seq_chunk_param = false;    
+    _display_string_cache_seq = 0;
+    _display_string_cache_value = DISPLAY_STRING_CACHE_EMPTY;
+    _display_string_cache_str = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -298,7 +310,7 @@ std::string Param::path() const
 std::string Param::ref() const
 {
     // Return the param reference
-    return _ref;
+    return *_ref;
 }
 
 //----------------------------------------------------------------------------
@@ -307,7 +319,7 @@ std::string Param::ref() const
 const char *Param::display_name() const
 {
     // Return the display name
-    return _display_name.c_str();
+    return _display_name->c_str();
 }
 
 //----------------------------------------------------------------------------
@@ -316,7 +328,7 @@ const char *Param::display_name() const
 std::string Param::param_list_name() const
 {
     // Return the param list name
-    return _param_list_name;
+    return *_param_list_name;
 }
 
 //----------------------------------------------------------------------------
@@ -325,7 +337,7 @@ std::string Param::param_list_name() const
 std::string Param::param_list_display_name() const
 {
     // Return the param list display name
-    return _param_list_display_name;
+    return *_param_list_display_name;
 }
 
 //----------------------------------------------------------------------------
@@ -340,31 +352,38 @@ ParamListType Param::param_list_type() const
 //----------------------------------------------------------------------------
 // param_list_name
 //----------------------------------------------------------------------------
-std::vector<Param *> Param::param_list() const
+const std::vector<Param *>& Param::param_list() const
 {
+    static const std::vector<Param *> empty_param_list;
+
     // Does this param have a basic param list?
     if (_param_list.size() > 0) {
         return _param_list;
     }
-    // Does this param have a context param list?
-    else if (_context_specific_param_list.size() > 0) {
-        // Go through each context specific param list
-        for (const ContextSpecificParams& csp : _context_specific_param_list) {
-            // If the context param exists
-            if (csp.context_param) {
-                // If the context param value matches
-                if (csp.context_param->num_positions()) {
-                    if (csp.context_param->position_value() == csp.context_value) {
-                        return csp.param_list;
-                    }
-                }
-                else if (csp.context_param->value() == csp.context_value) {
-                    return csp.param_list;
-                }
-            }
+
+    // Does this param have a context param list that matches the current context?
+    auto csp = _context_specific_params();
+    return csp ? csp->param_list : empty_param_list;
+}
+
+//----------------------------------------------------------------------------
+// param_list_index
+//----------------------------------------------------------------------------
+int Param::param_list_index(const Param *param) const
+{
+    // Get the param list indexes for the current param list
+    auto indexes = &_param_list_indexes;
+    if (_param_list.size() == 0) {
+        auto csp = _context_specific_params();
+        if (!csp) {
+            return -1;
         }
+        indexes = &csp->param_list_indexes;
     }
-    return std::vector<Param *>();
+
+    // Return the index of the param in the param list, if it is in the list
+    auto itr = indexes->find(param->path());
+    return itr != indexes->end() ? itr->second : -1;
 }
 
 //----------------------------------------------------------------------------
@@ -418,7 +437,7 @@ void Param::set_save(bool save)
 void Param::set_ref(std::string ref)
 {
     // Set the param reference
-    _ref = ref;
+    _ref = StringPool::Intern(ref);
 }
 
 //----------------------------------------------------------------------------
@@ -427,7 +446,7 @@ void Param::set_ref(std::string ref)
 void Param::set_display_name(std::string name)
 {
     // Set the display name
-    _display_name = name;
+    _display_name = StringPool::Intern(name);
 }
 
 //----------------------------------------------------------------------------
@@ -436,7 +455,7 @@ void Param::set_display_name(std::string name)
 void Param::set_param_list_name(std::string name)
 {
     // Set the param list name
-    _param_list_name = name;
+    _param_list_name = StringPool::Intern(name);
 }
 
 //----------------------------------------------------------------------------
@@ -445,7 +464,7 @@ void Param::set_param_list_name(std::string name)
 void Param::set_param_list_display_name(std::string name)
 {
     // Set the param list display name
-    _param_list_display_name = name;
+    _param_list_display_name = StringPool::Intern(name);
 }
 
 //----------------------------------------------------------------------------
@@ -462,8 +481,9 @@ void Param::set_param_list_type(ParamListType type)
 //----------------------------------------------------------------------------
 void Param::set_param_list(std::vector<Param *> list)
 {
-    // Set the param list
+    // Set the param list, and index it by param path
     _param_list = list;
+    _param_list_indexes = _param_list_indexes_from(_param_list);
 }
 
 //----------------------------------------------------------------------------
@@ -471,8 +491,11 @@ void Param::set_param_list(std::vector<Param *> list)
 //----------------------------------------------------------------------------
 void Param::set_context_specific_param_list(std::vector<ContextSpecificParams>& list)
 {
-    // Set the context specific param list
+    // Set the context specific param list, and index each list by param path
     _context_specific_param_list = list;
+    for (ContextSpecificParams& csp : _context_specific_param_list) {
+        csp.param_list_indexes = _param_list_indexes_from(csp.param_list);
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -586,104 +609,44 @@ std::pair<bool, std::string> Param::display_string() const
 {
     // Should we always display the HR value?
     if (_display_hr_value) {
-        // Get the HR value
-        auto value = hr_value();
-
-        // Format the string, with decimal places if needed
-        std::string format;
-        if (_display_decimal_places == 2) {
-            value = std::ceil(value * 100.0) / 100.0;
-            format = "%.2f";       
-        }
-        else if (_display_decimal_places == 1) {
-            value = std::ceil(value * 10.0) / 10.0;
-            format = "%.1f";    
-        }    
-        else {
-            value = std::roundf(value);
-            format = "%.0f";  
-        }
-        if (_display_range_min < 0) {
-            value += _display_range_min;
-        }
-        char buf[sizeof("123456")];
-        std::sprintf(buf, format.c_str(), value);
-        return std::pair<bool, std::string>(true, buf);        
+        // Return the formatted HR value
+        return std::pair<bool, std::string>(true, _display_value_string(hr_value()));
     }
 
     // Get the display string based on the param type and settings
     // Is this a position based param?
     float val = value();
     if (_num_positions > 0) {
+        // Get the display strings for each position
+        // Note: The strings are replaced if the number of positions changes, so the
+        // position is clamped to the strings fetched rather than to the number of
+        // positions
+        auto strings = _get_position_display_strings();
+        if (strings->empty()) {
+            return std::pair<bool, std::string>(true, "");
+        }
+
         // Convert the value to an integer position
         val = std::roundf(val / _position_increment);
-        if (val >= _num_positions)
-            val = _num_positions - 1;
-        // TODO - fix this
         if (val < 0) {
             val = 0;
         }
-
-        // If a value string can be shown, return it
-        if (val < _value_strings.size()) {
-            // Check if this string is a numeric value or not
-            bool is_numeric = true;
-            if (!_display_as_numeric) {
-                for (uint i=0; i<_value_strings[val].size(); i++) {
-                    if (!std::isdigit(_value_strings[val].at(i))) {
-                        is_numeric = false;
-                        break;
-                    }
-                }
-            }
-            return std::pair<bool, std::string>(is_numeric, _value_strings[val]);
-        }
-
-        // Calculate the display range
-        uint range;
-        if (_display_range_min < 0) {
-            range = std::abs(_display_range_min) + _display_range_max;
-        }
-        else {
-            range = _display_range_max - _display_range_min;
+        else if (val >= strings->size()) {
+            val = strings->size() - 1;
         }
 
-        // Range the integer value
-        val *= range / (_num_positions - 1);
-        if (_display_range_min)
-            val += _display_range_min;          
-        return std::pair<bool, std::string>(true, std::to_string(static_cast<int>(val)));
+        // Return the display string for this position
+        return (*strings)[val];
     }
 
-    // Convert the float to the required display value (with or without decimal places)
+    // Convert the float to the required display value, and return it formatted
     int min = _display_range_min;
     int max = _display_range_max;
     if (_display_range_min < 0) {
         min = 0;
         max += std::abs(_display_range_min);
     }
-    float value = min + ((max - min) * val);
-
-    // Format the string, with decimal places if needed
-    std::string format;
-    if (_display_decimal_places == 2) {
-        value = std::ceil(value * 100.0) / 100.0;
-        format = "%.2f";       
-    }
-    else if (_display_decimal_places == 1) {
-        value = std::ceil(value * 10.0) / 10.0;
-        format = "%.1f";    
-    }    
-    else {
-        value = std::roundf(value);
-        format = "%.0f";  
-    }
-    if (_display_range_min < 0) {
-        value += _display_range_min;
-    }
-    char buf[sizeof("123456")];
-    std::sprintf(buf, format.c_str(), value);
-    return std::pair<bool, std::string>(true, buf);
+    return std::pair<bool, std::string>(true, _display_value_string(min + ((max - min) * val)));
 }
 
 //----------------------------------------------------------------------------
@@ -693,8 +656,8 @@ std::string Param::position_string(uint pos) const
 {
     // Is this a position based param?
     if (_num_positions > 0) {
-        if (pos < _value_strings.size())
-            return _value_strings.at(pos);
+        if (pos < _value_strings->size())
+            return _value_strings->at(pos);
         if (_display_range_min)
             pos += _display_range_min;
         return std::to_string(static_cast<int>(pos));
@@ -709,16 +672,16 @@ std::string Param::display_tag() const
 {
     // Is there just one tag in the array?
     // If so, always return it
-    if (_value_tags.size() == 1) {
-        return _value_tags[0];
+    if (_value_tags->size() == 1) {
+        return (*_value_tags)[0];
     }
 
     // Is this an enum param?
     if (_num_positions > 0) {
         // Does it have an equivalent value tag?
         auto pos_value = position_value();
-        if ((pos_value >=0) && ((uint)pos_value < _value_tags.size())) {
-            return _value_tags[pos_value];
+        if ((pos_value >=0) && ((uint)pos_value < _value_tags->size())) {
+            return (*_value_tags)[pos_value];
         }
     }
     return "";
@@ -855,6 +818,7 @@ void Param::set_position_param(uint num_positions)
     _actual_num_positions = num_positions;
     _position_increment = 1.0 / _num_positions;
     _physical_pos_increment = 1.0 / (_num_positions - 1);
+    _reset_display_strings();
 }
 
 //----------------------------------------------------------------------------
@@ -878,6 +842,7 @@ void Param::set_display_min_value(int min)
 {
     // Set the display range min
     _display_range_min = min;
+    _reset_display_strings();
 }
 
 //----------------------------------------------------------------------------
@@ -887,6 +852,7 @@ void Param::set_display_max_value(int max)
 {
     // Set the display range max
     _display_range_max = max;
+    _reset_display_strings();
 }
 
 //----------------------------------------------------------------------------
@@ -898,6 +864,7 @@ void Param::set_display_decimal_places(uint num)
     if (num < 3) {
         // Set the display number of decimal places
         _display_decimal_places = num;
+        _reset_display_strings();
     }
 }
 
@@ -908,6 +875,7 @@ void Param::set_display_as_numeric(bool display)
 {
     // Set if this should be displayed as if it were a numeric param
     _display_as_numeric = display;
+    _reset_display_strings();
 }
 
 //----------------------------------------------------------------------------
@@ -927,6 +895,7 @@ void Param::set_display_hr_value(bool display)
 {
     // Set if we should always just display the HR value
     _display_hr_value = display;
+    _reset_display_strings();
 }
 
 //----------------------------------------------------------------------------
@@ -934,7 +903,22 @@ void Param::set_display_hr_value(bool display)
 //----------------------------------------------------------------------------
 void Param::add_value_string(std::string value)
 {
-    _value_strings.push_back(value);
+    add_value_strings({value});
+}
+
+//----------------------------------------------------------------------------
+// add_value_strings
+//----------------------------------------------------------------------------
+void Param::add_value_strings(const std::vector<std::string>& values)
+{
+    // Add the value strings to a copy of the current list, and reference the
+    // pooled copy of the new list
+    // Note: Add all value strings in one call where possible, as the pool holds
+    // each intermediate list
+    auto value_strings = *_value_strings;
+    value_strings.insert(value_strings.end(), values.begin(), values.end());
+    _value_strings = StringPool::Intern(value_strings);
+    _reset_display_strings();
 }
 
 //----------------------------------------------------------------------------
@@ -942,7 +926,19 @@ void Param::add_value_string(std::string value)
 //----------------------------------------------------------------------------
 void Param::add_value_tag(std::string tag)
 {
-    _value_tags.push_back(tag);
+    add_value_tags({tag});
+}
+
+//----------------------------------------------------------------------------
+// add_value_tags
+//----------------------------------------------------------------------------
+void Param::add_value_tags(const std::vector<std::string>& tags)
+{
+    // Add the value tags to a copy of the current list, and reference the pooled
+    // copy of the new list
+    auto value_tags = *_value_tags;
+    value_tags.insert(value_tags.end(), tags.begin(), tags.end());
+    _value_tags = StringPool::Intern(value_tags);
 }
 
 //----------------------------------------------------------------------------
@@ -984,7 +980,7 @@ bool Param::mod_matrix_param() const
 std::string Param::mod_src_name() const
 {
     // Return the mod src name
-    return _mod_src_name;
+    return *_mod_src_name;
 }
 
 //----------------------------------------------------------------------------
@@ -993,7 +989,7 @@ std::string Param::mod_src_name() const
 std::string Param::mod_dst_name() const
 {
     // Return the mod dst name
-    return _mod_dst_name;
+    return *_mod_dst_name;
 }
 
 //----------------------------------------------------------------------------
@@ -1003,8 +999,26 @@ void Param::set_as_mod_matrix_param(std::string src_name, std::string dst_name)
 {
     // Indicate this is a mod matrix param
     _mod_matrix_param = true;
-    _mod_src_name = src_name;
-    _mod_dst_name = dst_name;
+    _mod_src_name = StringPool::Intern(src_name);
+    _mod_dst_name = StringPool::Intern(dst_name);
+}
+
+//----------------------------------------------------------------------------
+// count_pooled_refs
+//----------------------------------------------------------------------------
+void Param::count_pooled_refs(StringPoolRefs& refs) const
+{
+    // Count the references this param holds to pooled metadata
+    // Note: Pooled metadata is only set when the param files are parsed, so no
+    // lock is needed
+    StringPool::CountRef(refs, _ref);
+    StringPool::CountRef(refs, _display_name);
+    StringPool::CountRef(refs, _param_list_name);
+    StringPool::CountRef(refs, _param_list_display_name);
+    StringPool::CountRef(refs, _value_strings);
+    StringPool::CountRef(refs, _value_tags);
+    StringPool::CountRef(refs, _mod_src_name);
+    StringPool::CountRef(refs, _mod_dst_name);
 }
 
 //----------------------------------------------------------------------------
@@ -1103,6 +1117,223 @@ float Param::_value_from_param(const Param& param) const
     return val;
 }
 
+//----------------------------------------------------------------------------
+// _context_specific_params
+//----------------------------------------------------------------------------
+const ContextSpecificParams *Param::_context_specific_params() const
+{
+    // Go through each context specific param list
+    for (const ContextSpecificParams& csp : _context_specific_param_list) {
+        // If the context param exists
+        if (csp.context_param) {
+            // If the context param value matches
+            if (csp.context_param->num_positions()) {
+                if (csp.context_param->position_value() == csp.context_value) {
+                    return &csp;
+                }
+            }
+            else if (csp.context_param->value() == csp.context_value) {
+                return &csp;
+            }
+        }
+    }
+    return nullptr;
+}
+
+//----------------------------------------------------------------------------
+// _param_list_indexes_from
+//----------------------------------------------------------------------------
+std::unordered_map<std::string, uint> Param::_param_list_indexes_from(const std::vector<Param *>& list)
+{
+    // Index the params in the list by path - if a path is in the list more than
+    // once, the first index is used
+    std::unordered_map<std::string, uint> indexes;
+    for (uint i=0; i<list.size(); i++) {
+        indexes.emplace(list[i]->path(), i);
+    }
+    return indexes;
+}
+
+//----------------------------------------------------------------------------
+// _position_display_string
+//----------------------------------------------------------------------------
+std::pair<bool, std::string> Param::_position_display_string(uint pos) const
+{
+    // If a value string can be shown, return it
+    if (pos < _value_strings->size()) {
+        // Check if this string is a numeric value or not
+        auto& value_string = (*_value_strings)[pos];
+        bool is_numeric = true;
+        if (!_display_as_numeric) {
+            for (uint i=0; i<value_string.size(); i++) {
+                if (!std::isdigit(value_string.at(i))) {
+                    is_numeric = false;
+                    break;
+                }
+            }
+        }
+        return std::pair<bool, std::string>(is_numeric, value_string);
+    }
+
+    // Calculate the display range
+    uint range;
+    if (_display_range_min < 0) {
+        range = std::abs(_display_range_min) + _display_range_max;
+    }
+    else {
+        range = _display_range_max - _display_range_min;
+    }
+
+    // Range the integer value
+    float val = pos;
+    val *= range / (_num_positions - 1);
+    if (_display_range_min)
+        val += _display_range_min;          
+    return std::pair<bool, std::string>(true, std::to_string(static_cast<int>(val)));
+}
+
+//----------------------------------------------------------------------------
+// _get_position_display_strings
+//----------------------------------------------------------------------------
+std::shared_ptr<const std::vector<std::pair<bool, std::string>>> Param::_get_position_display_strings() const
+{
+    std::lock_guard<std::mutex> lock(_display_strings_mutex);
+
+    // The display string for each position is only created when first needed, and again
+    // if the display settings change
+    // Note: The display settings can change at runtime (e.g. set_position_param), so the
+    // strings are never modified once created - they are replaced, and each caller
+    // holds a reference to the strings it is using
+    if (!_position_display_strings) {
+        auto strings = std::make_shared<std::vector<std::pair<bool, std::string>>>();
+        strings->reserve(_num_positions);
+        for (uint i=0; i<_num_positions; i++) {
+            strings->push_back(_position_display_string(i));
+        }
+        _position_display_strings = strings;
+    }
+    return _position_display_strings;
+}
+
+//----------------------------------------------------------------------------
+// _display_value_string
+//----------------------------------------------------------------------------
+std::string Param::_display_value_string(float value) const
+{
+    // If this value was the last value formatted, return the same string
+    std::string str;
+    uint32_t seq;
+    if (_get_cached_display_string(value, str, seq)) {
+        return str;
+    }
+
+    // Format the string, with decimal places if needed
+    float display_value;
+    if (_display_decimal_places == 2) {
+        display_value = std::ceil(value * 100.0) / 100.0;
+    }
+    else if (_display_decimal_places == 1) {
+        display_value = std::ceil(value * 10.0) / 10.0;
+    }    
+    else {
+        display_value = std::roundf(value);
+    }
+    if (_display_range_min < 0) {
+        display_value += _display_range_min;
+    }
+    char buf[sizeof("-123456.00")];
+    std::snprintf(buf, sizeof(buf), "%.*f", static_cast<int>(_display_decimal_places), display_value);
+    str = buf;
+    _set_cached_display_string(value, str, seq);
+    return str;
+}
+
+//----------------------------------------------------------------------------
+// _get_cached_display_string
+//----------------------------------------------------------------------------
+bool Param::_get_cached_display_string(float value, std::string& str, uint32_t& seq) const
+{
+    // The cache holds the last value formatted and its string, and is updated without
+    // locking - a sequence number is incremented before and after each update, so a
+    // cache read is only valid if the sequence number is even and does not change
+    // The sequence number read is returned, so that a string formatted after a cache
+    // miss is only cached if the cache has not changed since
+    seq = _display_string_cache_seq.load(std::memory_order_acquire);
+    if (seq & 1) {
+        return false;
+    }
+    uint32_t cached_value = _display_string_cache_value.load(std::memory_order_relaxed);
+    uint64_t cached_str = _display_string_cache_str.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint32_t value_bits;
+    std::memcpy(&value_bits, &value, sizeof(value_bits));
+    if ((_display_string_cache_seq.load(std::memory_order_relaxed) != seq) || (cached_value != value_bits)) {
+        return false;
+    }
+
+    // Unpack the cached string
+    char buf[DISPLAY_STRING_CACHE_MAX_LEN + 1] = {};
+    std::memcpy(buf, &cached_str, DISPLAY_STRING_CACHE_MAX_LEN);
+    str = buf;
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// _set_cached_display_string
+//----------------------------------------------------------------------------
+void Param::_set_cached_display_string(float value, const std::string& str, uint32_t seq) const
+{
+    // Only strings that fit in the cache can be cached
+    if (str.size() > DISPLAY_STRING_CACHE_MAX_LEN) {
+        return;
+    }
+
+    // If another thread is updating the cache, or it has changed (or been reset) since
+    // the string was formatted, just leave it
+    if ((seq & 1) || !_display_string_cache_seq.compare_exchange_strong(seq, seq + 1, std::memory_order_acquire)) {
+        return;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+
+    // Pack and update the cached value and string
+    uint32_t value_bits;
+    uint64_t packed_str = 0;
+    std::memcpy(&value_bits, &value, sizeof(value_bits));
+    std::memcpy(&packed_str, str.c_str(), str.size());
+    _display_string_cache_value.store(value_bits, std::memory_order_relaxed);
+    _display_string_cache_str.store(packed_str, std::memory_order_relaxed);
+    _display_string_cache_seq.store(seq + 2, std::memory_order_release);
+}
+
+//----------------------------------------------------------------------------
+// _reset_display_strings
+//----------------------------------------------------------------------------
+void Param::_reset_display_strings()
+{
+    // The display settings have changed, so the display strings must be created again
+    // Note: Callers still using the previous position display strings keep them until
+    // they are done
+    {
+        std::lock_guard<std::mutex> lock(_display_strings_mutex);
+        _position_display_strings.reset();
+    }
+
+    // Empty the cached display string as a cache update, so that the sequence number
+    // changes - a string formatted with the previous settings is then not cached, as the
+    // sequence number has changed since it was formatted
+    // Note: Updates are very short, so just wait for any update in progress to finish
+    while (true) {
+        uint32_t seq = _display_string_cache_seq.load(std::memory_order_relaxed);
+        if (!(seq & 1) && _display_string_cache_seq.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire)) {
+            std::atomic_thread_fence(std::memory_order_release);
+            _display_string_cache_value.store(DISPLAY_STRING_CACHE_EMPTY, std::memory_order_relaxed);
+            _display_string_cache_seq.store(seq + 2, std::memory_order_release);
+            break;
+        }
+        std::this_thread::yield();
+    }
+}
+
 //--------------------------------
 // LayerParam class implementation
 //--------------------------------
@@ -1117,7 +1348,7 @@ std::unique_ptr<LayerParam> LayerParam::CreateParam(int param_id, std::string pa
     param->_path = Param::ParamPath(param_name);
     param->_param_id = param_id;
     param->_param_id_d1 = param_id;
-    param->_display_name = display_name;
+    param->_display_name = StringPool::Intern(display_name);
     return param;
 }
 
@@ -1131,7 +1362,7 @@ std::unique_ptr<LayerParam> LayerParam::CreateParam(const BaseManager *mgr, int
     param->_path = Param::ParamPath(mgr->module(), param_name);
     param->_param_id = param_id;
     param->_param_id_d1 = param_id;
-    param->_display_name = display_name;
+    param->_display_name = StringPool::Intern(display_name);
     return param;
 }
 
@@ -1143,7 +1374,7 @@ std::unique_ptr<LayerParam> LayerParam::CreateParam(const BaseManager *mgr, std:
     // Create as module param
     auto param = std::make_unique<LayerParam>(mgr->module(), data_type);
     param->_path = Param::ParamPath(mgr->module(), param_name);
-    param->_display_name = display_name;
+    param->_display_name = StringPool::Intern(display_name);
     return param;
 }
 
@@ -1153,8 +1384,14 @@ std::unique_ptr<LayerParam> LayerParam::CreateParam(const BaseManager *mgr, std:
 LayerParam::LayerParam(const LayerParam& param) : Param(param)
 {
     // Copy the class data
+    // Note: The copy has its own value store slot
     _param_id_d1 = param._param_id_d1;
-    _value_d1 = param._value_d1;
+    _value_slot = ParamValueStore::Alloc();
+    for (auto layer_id : {LayerId::D0, LayerId::D1}) {
+        for (auto state : {LayerState::STATE_A, LayerState::STATE_B}) {
+            ParamValueStore::Set(_value_slot, layer_id, state, param._layer_value(layer_id, state));
+        }
+    }
     _str_value_d1 = param._str_value_d1;
 }
 
@@ -1165,7 +1402,7 @@ LayerParam::LayerParam(MoniqueModule module, ParamDataType data_type) : Param(mo
 {
     // Initialise class data
     _param_id_d1 = -1;
-    _value_d1 = 0.0;
+    _value_slot = ParamValueStore::Alloc();
     _str_value_d1 = "";
 }
 
@@ -1183,7 +1420,8 @@ std::unique_ptr<Param> LayerParam::clone() const
 //----------------------------------------------------------------------------
 LayerParam::~LayerParam()
 {
-    // Nothing specific to do
+    // Free the value store slot
+    ParamValueStore::Free(_value_slot);
 }
 
 //----------------------------------------------------------------------------
@@ -1213,6 +1451,15 @@ void LayerParam::set_param_id(LayerId layer_id, int param_id)
     layer_id == LayerId::D0 ? _param_id = param_id : _param_id_d1 = param_id;
 }
 
+//----------------------------------------------------------------------------
+// value_slot
+//----------------------------------------------------------------------------
+uint LayerParam::value_slot() const
+{
+    // Return the value store slot
+    return _value_slot;
+}
+
 //----------------------------------------------------------------------------
 // hr_value
 //----------------------------------------------------------------------------
@@ -1231,8 +1478,7 @@ float LayerParam::hr_value(LayerId layer_id) const
     std::lock_guard<std::mutex> lock(_mutex);                
 
     // Return the param human readable value based on the current layer
-    return dataconv::from_normalised_float(_module, _param_id, 
-                                           (layer_id == LayerId::D0 ? _value : _value_d1));
+    return dataconv::from_normalised_float(_module, _param_id, _layer_value(layer_id, LayerState::STATE_A));
 }
 
 //----------------------------------------------------------------------------
@@ -1253,7 +1499,7 @@ float LayerParam::value(LayerId layer_id) const
     std::lock_guard<std::mutex> lock(_mutex);
 
     // Return the normalised value
-    return layer_id == LayerId::D0 ? _value : _value_d1;
+    return _layer_value(layer_id, LayerState::STATE_A);
 }
 
 //----------------------------------------------------------------------------
@@ -1278,7 +1524,7 @@ int LayerParam::position_value(LayerId layer_id) const
     // Is this a position param?
     if (_num_positions) {
         // Get the position value
-        val = _position_value((layer_id == LayerId::D0 ? _value : _value_d1), _position_increment);
+        val = _position_value(_layer_value(layer_id, LayerState::STATE_A), _position_increment);
     }
     return val;
 }
@@ -1293,9 +1539,7 @@ void LayerParam::set_hr_value(float value)
 
     // Set the normalised value from the human readable value
     auto val = dataconv::to_normalised_float(_module, _param_id, value);
-    utils::is_current_layer(LayerId::D0) ? 
-        _value = val : 
-        _value_d1 = val;
+    _set_layer_value(utils::get_current_layer_info().layer_id(), val);
 }
 
 //----------------------------------------------------------------------------
@@ -1307,9 +1551,7 @@ void LayerParam::set_value(float value)
     std::lock_guard<std::mutex> lock(_mutex);
 
     // Set the normalised value
-    utils::is_current_layer(LayerId::D0) ? 
-        _value = value : 
-        _value_d1 = value;
+    _set_layer_value(utils::get_current_layer_info().layer_id(), value);
 }
 
 //----------------------------------------------------------------------------
@@ -1334,11 +1576,8 @@ void LayerParam::set_value_from_param(LayerId layer_id, const Param &param)
         return;
     }
 
-    // Get a reference to the value to set
-    float& value = layer_id == LayerId::D0 ? _value : _value_d1;
-
     // Set the value from the param
-    value = _value_from_param(param);
+    _set_layer_value(layer_id, _value_from_param(param));
 }
 
 //----------------------------------------------------------------------------
@@ -1360,9 +1599,7 @@ void LayerParam::set_value_from_position(LayerId layer_id, uint position, bool f
 
     if ((_num_positions > 0) && ((position < _actual_num_positions) || force)) {
         // Calculate the multi-position value as a float
-        layer_id == LayerId::D0 ?
-            _value = position * _position_increment :
-            _value_d1 = position * _position_increment;
+        _set_layer_value(layer_id, position * _position_increment);
     }
 }
 
@@ -1376,9 +1613,7 @@ void LayerParam::set_hr_value(LayerId layer_id, float value)
 
     // Set the value
     auto val = dataconv::to_normalised_float(_module, _param_id, value);
-    layer_id == LayerId::D0 ? 
-        _value = val : 
-        _value_d1 = val;
+    _set_layer_value(layer_id, val);
 }
 
 //----------------------------------------------------------------------------
@@ -1390,9 +1625,7 @@ void LayerParam::set_value(LayerId layer_id, float value)
     std::lock_guard<std::mutex> lock(_mutex);
 
     // Set the value
-    layer_id == LayerId::D0 ? 
-        _value = value : 
-        _value_d1 = value;
+    _set_layer_value(layer_id, value);
 }
 
 //----------------------------------------------------------------------------
@@ -1435,6 +1668,24 @@ void LayerParam::set_str_value(LayerId layer_id, std::string value)
         _str_value_d1 = value;
 }
 
+//----------------------------------------------------------------------------
+// _layer_value
+//----------------------------------------------------------------------------
+float LayerParam::_layer_value(LayerId layer_id, LayerState state) const
+{
+    // Return the value from the value store
+    return ParamValueStore::Get(_value_slot, layer_id, state);
+}
+
+//----------------------------------------------------------------------------
+// _set_layer_value
+//----------------------------------------------------------------------------
+void LayerParam::_set_layer_value(LayerId layer_id, float value)
+{
+    // A Layer param has no state, so set the same value in both states
+    ParamValueStore::SetLayer(_value_slot, layer_id, value);
+}
+
 //-------------------------------------
 // LayerStateParam class implementation
 //-------------------------------------
@@ -1452,7 +1703,7 @@ std::unique_ptr<LayerStateParam> LayerStateParam::CreateParam(int param_id, std:
     param->_param_id_d1 = param_id;
     param->_param_id_d0_state_b = param_id;
     param->_param_id_d1_state_b = param_id;
-    param->_display_name = display_name;
+    param->_display_name = StringPool::Intern(display_name);
     return param;
 }
 
@@ -1465,7 +1716,7 @@ std::unique_ptr<LayerStateParam> LayerStateParam::CreateParam(const BaseManager
     auto param = std::make_unique<LayerStateParam>(mgr->module(), data_type);
     param->_type = ParamType::PATCH_STATE;
     param->_path = Param::ParamPath(mgr->module(), param_name);
-    param->_display_name = display_name;
+    param->_display_name = StringPool::Intern(display_name);
     return param;
 }
 
@@ -1478,10 +1729,9 @@ LayerStateParam::LayerStateParam(const LayerStateParam& param) : LayerParam(para
     _state_a_only_param = param._state_a_only_param;
     _param_id_d0_state_b = param._param_id_d0_state_b;
     _param_id_d1_state_b = param._param_id_d1_state_b;
-    _value_d0_state_b = param._value_d0_state_b;
-    _value_d1_state_b = param._value_d1_state_b; 
     _str_value_d0_state_b = param._str_value_d0_state_b;
     _str_value_d1_state_b = param._str_value_d1_state_b;
+    _set_morphable();
 }
 
 //----------------------------------------------------------------------------
@@ -1493,10 +1743,9 @@ LayerStateParam::LayerStateParam(MoniqueModule module, ParamDataType data_type)
     _state_a_only_param = false;
     _param_id_d0_state_b = -1;
     _param_id_d1_state_b = -1;
-    _value_d0_state_b = 0.0;
-    _value_d1_state_b = 0.0;
     _str_value_d0_state_b = "";
     _str_value_d1_state_b = "";
+    _set_morphable();
 }
 
 //----------------------------------------------------------------------------
@@ -1587,6 +1836,13 @@ void LayerStateParam::set_state_a_only_param(bool set)
 {
     // Set if this is a state A only param or not
     _state_a_only_param = set;
+
+    // A state A only param holds the same value in both states
+    if (set) {
+        _set_layer_value(LayerId::D0, _layer_value(LayerId::D0, LayerState::STATE_A));
+        _set_layer_value(LayerId::D1, _layer_value(LayerId::D1, LayerState::STATE_A));
+    }
+    _set_morphable();
 }
 
 //----------------------------------------------------------------------------
@@ -1599,11 +1855,7 @@ float LayerStateParam::hr_value() const
 
     // Return the param human readable value based on the current state
     return dataconv::from_normalised_float(_module, _param_id,
-                                           utils::is_current_layer(LayerId::D0) ?
-                                                (utils::get_current_layer_info().layer_state() == LayerState::STATE_A || _state_a_only_param ? 
-                                                            _value : _value_d0_state_b) :
-                                                (utils::get_current_layer_info().layer_state() == LayerState::STATE_A || _state_a_only_param ? 
-                                                            _value_d1 : _value_d1_state_b));
+                                           _state_value(utils::get_current_layer_info().layer_id(), utils::get_current_layer_info().layer_state()));
 }
 
 //----------------------------------------------------------------------------
@@ -1624,11 +1876,7 @@ float LayerStateParam::value(LayerId layer_id) const
     std::lock_guard<std::mutex> lock(_mutex);
 
     // Return the normalised value
-    return layer_id == LayerId::D0 ?
-                (utils::get_layer_info(layer_id).layer_state() == LayerState::STATE_A || _state_a_only_param ? 
-                            _value : _value_d0_state_b) :
-                (utils::get_layer_info(layer_id).layer_state() == LayerState::STATE_A || _state_a_only_param ? 
-                            _value_d1 : _value_d1_state_b);
+    return _state_value(layer_id, utils::get_layer_info(layer_id).layer_state());
 }
 
 //----------------------------------------------------------------------------
@@ -1649,11 +1897,7 @@ float LayerStateParam::value(LayerId id, LayerState state) const
     std::lock_guard<std::mutex> lock(_mutex);
 
     // Return the normalised value
-    return id == LayerId::D0 ?
-                (state == LayerState::STATE_A || _state_a_only_param ? 
-                            _value : _value_d0_state_b) :
-                (state == LayerState::STATE_A || _state_a_only_param ? 
-                            _value_d1 : _value_d1_state_b);
+    return _state_value(id, state);
 }
 
 //----------------------------------------------------------------------------
@@ -1678,12 +1922,7 @@ int LayerStateParam::position_value(LayerId layer_id, LayerState state) const
     // Is this a position param?
     if (_num_positions) {
         // Get the position value
-        val = _position_value((layer_id == LayerId::D0 ? 
-                                    (state == LayerState::STATE_A || _state_a_only_param ? 
-                                                _value : _value_d0_state_b) :
-                                    (state == LayerState::STATE_A || _state_a_only_param ? 
-                                                _value_d1 : _value_d1_state_b)),
-                              _position_increment);
+        val = _position_value(_state_value(layer_id, state), _position_increment);
     }
     return val;
 }
@@ -1698,11 +1937,7 @@ void LayerStateParam::set_hr_value(float value)
 
     // Set the human readable value as normalised
     auto val = dataconv::to_normalised_float(_module, _param_id, value);
-    utils::is_current_layer(LayerId::D0) ?
-        (utils::get_current_layer_info().layer_state() == LayerState::STATE_A || _state_a_only_param ? 
-                    _value = val : _value_d0_state_b = val) :
-        (utils::get_current_layer_info().layer_state() == LayerState::STATE_A || _state_a_only_param ? 
-                    _value_d1 = val : _value_d1_state_b = val);
+    _set_state_value(utils::get_current_layer_info().layer_id(), utils::get_current_layer_info().layer_state(), val);
 }
 
 //----------------------------------------------------------------------------
@@ -1715,11 +1950,7 @@ void LayerStateParam::set_hr_value(LayerId layer_id, float value)
 
     // Set the value
     auto val = dataconv::to_normalised_float(_module, _param_id, value);
-    layer_id == LayerId::D0 ?
-        (utils::get_layer_info(LayerId::D0).layer_state() == LayerState::STATE_A || _state_a_only_param ? 
-                    _value = val : _value_d0_state_b = val) :
-        (utils::get_layer_info(LayerId::D1).layer_state() == LayerState::STATE_A || _state_a_only_param ? 
-                    _value_d1 = val : _value_d1_state_b = val);
+    _set_state_value(layer_id, utils::get_layer_info(layer_id).layer_state(), val);
 }
 
 //----------------------------------------------------------------------------
@@ -1732,11 +1963,7 @@ void LayerStateParam::set_hr_value(LayerId layer_id, LayerState state, float val
 
     // Set the value
     auto val = dataconv::to_normalised_float(_module, _param_id, value);
-    layer_id == LayerId::D0 ?
-        (state == LayerState::STATE_A || _state_a_only_param ? 
-                    _value = val : _value_d0_state_b = val) :
-        (state == LayerState::STATE_A || _state_a_only_param ? 
-                    _value_d1 = val : _value_d1_state_b = val);
+    _set_state_value(layer_id, state, val);
 }
 
 //----------------------------------------------------------------------------
@@ -1748,11 +1975,7 @@ void LayerStateParam::set_value(float value)
     std::lock_guard<std::mutex> lock(_mutex);
 
     // Set the normalised value
-    utils::is_current_layer(LayerId::D0) ?
-        (utils::get_current_layer_info().layer_state() == LayerState::STATE_A || _state_a_only_param ? 
-                    _value = value : _value_d0_state_b = value) :
-        (utils::get_current_layer_info().layer_state() == LayerState::STATE_A || _state_a_only_param ? 
-                    _value_d1 = value : _value_d1_state_b = value);
+    _set_state_value(utils::get_current_layer_info().layer_id(), utils::get_current_layer_info().layer_state(), value);
 }
 
 //----------------------------------------------------------------------------
@@ -1764,11 +1987,7 @@ void LayerStateParam::set_value(LayerId layer_id, float value)
     std::lock_guard<std::mutex> lock(_mutex);
 
     // Set the normalised value
-    layer_id == LayerId::D0 ?
-        (utils::get_current_layer_info().layer_state() == LayerState::STATE_A || _state_a_only_param ? 
-                    _value = value : _value_d0_state_b = value) :
-        (utils::get_current_layer_info().layer_state() == LayerState::STATE_A || _state_a_only_param ? 
-                    _value_d1 = value : _value_d1_state_b = value);
+    _set_state_value(layer_id, utils::get_current_layer_info().layer_state(), value);
 }
 
 //----------------------------------------------------------------------------
@@ -1793,15 +2012,8 @@ void LayerStateParam::set_value_from_param(LayerId layer_id, const Param &param)
         return;
     }
 
-    // Get a reference to the value to set
-    float& value = layer_id == LayerId::D0 ?
-                        (utils::get_current_layer_info().layer_state() == LayerState::STATE_A || _state_a_only_param ? 
-                                    _value : _value_d0_state_b) :
-                        (utils::get_current_layer_info().layer_state() == LayerState::STATE_A || _state_a_only_param ? 
-                                    _value_d1 : _value_d1_state_b);
-
     // Set the value from the passed param
-    value = _value_from_param(param);
+    _set_state_value(layer_id, utils::get_current_layer_info().layer_state(), _value_from_param(param));
 }
 
 //----------------------------------------------------------------------------
@@ -1815,11 +2027,7 @@ void LayerStateParam::set_value_from_position(uint position, bool force)
     if ((_num_positions > 0) && ((position < _actual_num_positions) || force)) {
         // Calculate the multi-position value as a float
         auto val = position * _position_increment;
-        utils::is_current_layer(LayerId::D0) ?
-            (utils::get_current_layer_info().layer_state() == LayerState::STATE_A || _state_a_only_param ? 
-                        _value = val : _value_d0_state_b = val) :
-            (utils::get_current_layer_info().layer_state() == LayerState::STATE_A || _state_a_only_param ? 
-                        _value_d1 = val : _value_d1_state_b = val);
+        _set_state_value(utils::get_current_layer_info().layer_id(), utils::get_current_layer_info().layer_state(), val);
     }
 }
 
@@ -1832,9 +2040,7 @@ void LayerStateParam::set_state_value(LayerId layer_id, LayerState state, float
     std::lock_guard<std::mutex> lock(_mutex);
     
     // Set the state value
-    layer_id == LayerId::D0 ?
-        (state == LayerState::STATE_A || _state_a_only_param ? _value = value : _value_d0_state_b = value) :
-        (state == LayerState::STATE_A || _state_a_only_param ? _value_d1 = value : _value_d1_state_b = value);
+    _set_state_value(layer_id, state, value);
 }
 
 //----------------------------------------------------------------------------
@@ -1899,6 +2105,42 @@ void LayerStateParam::set_str_state_value(LayerId layer_id, LayerState state, st
         (state == LayerState::STATE_A || _state_a_only_param ? _str_value_d1 = value : _str_value_d1_state_b = value);
 }
 
+//----------------------------------------------------------------------------
+// _state_value
+//----------------------------------------------------------------------------
+float LayerStateParam::_state_value(LayerId layer_id, LayerState state) const
+{
+    // Return the value from the value store - a state A only param always uses
+    // the state A value
+    return _layer_value(layer_id, (_state_a_only_param ? LayerState::STATE_A : state));
+}
+
+//----------------------------------------------------------------------------
+// _set_morphable
+//----------------------------------------------------------------------------
+void LayerStateParam::_set_morphable()
+{
+    // Only DAW float state params are morphed, and never a state A only param
+    // Note: This may move the param to a new value store slot
+    _value_slot = ParamValueStore::SetMorphable(_value_slot, ((_module == MoniqueModule::DAW) &&
+                                                              (_data_type == ParamDataType::FLOAT) &&
+                                                              !_state_a_only_param));
+}
+
+//----------------------------------------------------------------------------
+// _set_state_value
+//----------------------------------------------------------------------------
+void LayerStateParam::_set_state_value(LayerId layer_id, LayerState state, float value)
+{
+    // A state A only param holds the same value in both states
+    if (_state_a_only_param) {
+        _set_layer_value(layer_id, value);
+    }
+    else {
+        ParamValueStore::Set(_value_slot, layer_id, state, value);
+    }
+}
+
 //-------------------------------------
 // SfcControlParam class implementation
 //-------------------------------------
@@ -1914,7 +2156,7 @@ SfcControlParam::SfcControlParam(const SfcControlParam& param) : Param(param)
     _control_num = param._control_num;
     _control_states = param._control_states;
     _current_control_state = param._current_control_state;
-    _default_control_state_name = param._default_control_state_name;
+    _default_control_state_id = param._default_control_state_id;
 }
 
 //----------------------------------------------------------------------------
@@ -1934,9 +2176,10 @@ SfcControlParam::SfcControlParam(sfc::ControlType control_type, uint control_num
     // Always add the default state
     auto control_state = SfcControlState();
     control_state.state = utils::default_ui_state();
+    control_state.state_id = utils::register_control_state(control_state.state);
     _control_states.push_back(control_state);
     _current_control_state = &_control_states.at(0);
-    _default_control_state_name = control_state.state;
+    _default_control_state_id = control_state.state_id;
 }
 
 //----------------------------------------------------------------------------
@@ -2210,8 +2453,17 @@ void SfcControlParam::set_haptic_mode(const std::string haptic_mode_name)
 bool SfcControlParam::has_control_state(std::string state)
 {
     // Find the specified state
-    for (SfcControlState& cs : _control_states) {
-        if (cs.state == state) {
+    return has_control_state(utils::get_control_state_id(state));
+}
+
+//----------------------------------------------------------------------------
+// has_control_state
+//----------------------------------------------------------------------------
+bool SfcControlParam::has_control_state(uint state_id) const
+{
+    // Find the specified state
+    for (const SfcControlState& cs : _control_states) {
+        if (cs.state_id == state_id) {
             // Found
             return true;
         }
@@ -2219,22 +2471,36 @@ bool SfcControlParam::has_control_state(std::string state)
     return false;
 }
 
+//----------------------------------------------------------------------------
+// control_state_ids
+//----------------------------------------------------------------------------
+const std::vector<uint> SfcControlParam::control_state_ids() const
+{
+    std::vector<uint> state_ids;
+
+    // Return the IDs of all the control states
+    for (const SfcControlState& cs : _control_states) {
+        state_ids.push_back(cs.state_id);
+    }
+    return state_ids;
+}
+
 //----------------------------------------------------------------------------
 // add_control_state
 //----------------------------------------------------------------------------
 void SfcControlParam::add_control_state(std::string state)
 {
-    // Check if this state already exists
-    for (SfcControlState& cs : _control_states) {
-        if (cs.state == state) {
-            // Already exists, so do nothing
-            return;
-        }
+    // Get the state ID, and check if this state already exists
+    auto state_id = utils::register_control_state(state);
+    if (has_control_state(state_id)) {
+        // Already exists, so do nothing
+        return;
     }
 
     // This is a new state to add
     auto control_state = SfcControlState();
     control_state.state = state;
+    control_state.state_id = state_id;
 
     // If this is the *first* new state added AND the default
     // state has not been set, make this the new default
@@ -2243,7 +2509,7 @@ void SfcControlParam::add_control_state(std::string state)
     if ((_control_states.size() == 1) && (_control_states.at(0).mapped_params.size() == 0)) {
         // Make this state the new default by overwriting the default state
         _control_states.at(0) = control_state;
-        _default_control_state_name = state;
+        _default_control_state_id = state_id;
     }
     else {
         // Push the new control state
@@ -2257,13 +2523,22 @@ void SfcControlParam::add_control_state(std::string state)
 void SfcControlParam::set_default_control_state()
 {
     // Select the default control state
-    (void)set_control_state(_default_control_state_name);
+    (void)set_control_state(_default_control_state_id);
 }
 
 //----------------------------------------------------------------------------
 // set_control_state
 //----------------------------------------------------------------------------
 bool SfcControlParam::set_control_state(std::string state)
+{
+    // Set the specified state
+    return set_control_state(utils::get_control_state_id(state));
+}
+
+//----------------------------------------------------------------------------
+// set_control_state
+//----------------------------------------------------------------------------
+bool SfcControlParam::set_control_state(uint state_id)
 {
     bool ret = false;
 
@@ -2271,10 +2546,10 @@ bool SfcControlParam::set_control_state(std::string state)
     std::lock_guard<std::mutex> lock(_mutex);
     
     // If we are not already in that state
-    if (_current_control_state->state != state) {
+    if (_current_control_state->state_id != state_id) {
         // Find the specified state
         for (SfcControlState& cs : _control_states) {
-            if (cs.state == state) {
+            if (cs.state_id == state_id) {
                 // Found, set it
                 _current_control_state = &cs;
                 ret = true;
@@ -2335,7 +2610,7 @@ KnobParam::KnobParam(unsigned int control_num)
 {
     // Initialise the knob variables
     _path = KnobParam::ParamPath(control_num);
-    _display_name = KNOB_CONTROL_BASE_NAME + std::string(" ") + std::to_string(control_num);
+    _display_name = StringPool::Intern(KNOB_CONTROL_BASE_NAME + std::string(" ") + std::to_string(control_num));
     _relative_value_control = false;
     _relative_value_offset = 0;
     _last_value = 0;
@@ -2929,7 +3204,7 @@ SwitchParam::SwitchParam(unsigned int control_num)
 {
     // Initialise the switch variables
     _path = SwitchParam::ParamPath(control_num);
-    _display_name = SWITCH_CONTROL_BASE_NAME + std::string(" ") + std::to_string(control_num);
+    _display_name = StringPool::Intern(SWITCH_CONTROL_BASE_NAME + std::string(" ") + std::to_string(control_num));
     _switch_type = SwitchType::NORMAL;
     _num_positions = 2;
     _position_increment = 1.0 / _num_positions;
@@ -3151,7 +3426,7 @@ std::unique_ptr<DummyParam> DummyParam::CreateParam(MoniqueModule module, std::s
     param->_preset = false;
     param->_save = false;
     param->_path = path;
-    param->_display_name = path;
+    param->_display_name = StringPool::Intern(path);
     return param;
 }
 
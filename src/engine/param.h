@@ -9,11 +9,14 @@
 #ifndef _PARAM_H
 #define _PARAM_H
 
+#include <atomic>
+#include <climits>
 #include <memory>
 #include <string>
 #include <cstring>
 #include <functional>
 #include <mutex>
+#include <unordered_map>
 #include <vector>
 #include "ui_common.h"
 #include "system_func.h"
@@ -21,6 +24,7 @@
 
 // External classes
 class BaseManager;
+struct StringPoolRefs;
 
 // Param Type
 enum class ParamType
@@ -69,6 +73,7 @@ struct ContextSpecificParams
     Param *context_param;
     float context_value;
     std::vector<Param *> param_list;
+    std::unordered_map<std::string, uint> param_list_indexes;
 };
 
 // Base Param class
@@ -105,7 +110,8 @@ public:
     std::string param_list_name() const;
     std::string param_list_display_name() const;
     ParamListType param_list_type() const;
-    std::vector<Param *> param_list() const;
+    const std::vector<Param *>& param_list() const;
+    int param_list_index(const Param *param) const;
     bool cmp_path(std::string path) const;
     void set_type(ParamType type);
     virtual void set_processor_id(int processor_id);
@@ -151,7 +157,9 @@ public:
     virtual void set_display_enum_list(bool display);
     virtual void set_display_hr_value(bool display);
     void add_value_string(std::string value);
+    void add_value_strings(const std::vector<std::string>& values);
     void add_value_tag(std::string tag);
+    void add_value_tags(const std::vector<std::string>& tags);
 
     // String value public functions
     virtual std::string str_value() const;
@@ -169,6 +177,9 @@ public:
     bool seq_chunk_param_is_reset() const;
     void reset_seq_chunk_param();
 
+    // Memory report functions
+    void count_pooled_refs(StringPoolRefs& refs) const;
+
 protected:
     // Protected variables
     mutable std::mutex _mutex;
@@ -180,12 +191,13 @@ protected:
     bool _preset;
     bool _save;
     std::string _path;
-    std::string _ref;
-    std::string _display_name;
-    std::string _param_list_name;
-    std::string _param_list_display_name;
+    const std::string *_ref;
+    const std::string *_display_name;
+    const std::string *_param_list_name;
+    const std::string *_param_list_display_name;
     ParamListType _param_list_type;
     std::vector<Param *> _param_list;
+    std::unordered_map<std::string, uint> _param_list_indexes;
     std::vector<ContextSpecificParams> _context_specific_param_list;
     std::vector<Param *> _mapped_params;
     bool _linked_param;
@@ -199,20 +211,33 @@ protected:
     float _display_range_min;
     float _display_range_max;
     uint _display_decimal_places;
-    std::vector<std::string> _value_strings;
-    std::vector<std::string> _value_tags;
+    const std::vector<std::string> *_value_strings;
+    const std::vector<std::string> *_value_tags;
     bool _display_as_numeric;
     bool _display_enum_list;
     bool _display_hr_value;
     std::string _str_value;
     bool _mod_matrix_param;
-    std::string _mod_src_name;
-    std::string _mod_dst_name;
+    const std::string *_mod_src_name;
+    const std::string *_mod_dst_name;
     bool _is_seq_chunk_param;
+    mutable std::mutex _display_strings_mutex;
+    mutable std::shared_ptr<const std::vector<std::pair<bool, std::string>>> _position_display_strings;
+    mutable std::atomic<uint32_t> _display_string_cache_seq;
+    mutable std::atomic<uint32_t> _display_string_cache_value;
+    mutable std::atomic<uint64_t> _display_string_cache_str;
 
     // Private functions
     int _position_value(float from_value, float pos_increment) const;
     float _value_from_param(const Param& param) const;
+    const ContextSpecificParams *_context_specific_params() const;
+    static std::unordered_map<std::string, uint> _param_list_indexes_from(const std::vector<Param *>& list);
+    std::pair<bool, std::string> _position_display_string(uint pos) const;
+    std::shared_ptr<const std::vector<std::pair<bool, std::string>>> _get_position_display_strings() const;
+    std::string _display_value_string(float value) const;
+    bool _get_cached_display_string(float value, std::string& str, uint32_t& seq) const;
+    void _set_cached_display_string(float value, const std::string& str, uint32_t seq) const;
+    void _reset_display_strings();
 };
 
 // Layer param
@@ -236,6 +261,7 @@ public:
     virtual int param_id() const;
     virtual int param_id(LayerId layer_id) const;
     void set_param_id(LayerId layer_id, int param_id);
+    uint value_slot() const;
 
     // Float value public functions
     float hr_value() const;
@@ -261,8 +287,12 @@ public:
 protected:
     // Protected variables
     int _param_id_d1;
-    float _value_d1;
+    uint _value_slot;
     std::string _str_value_d1;
+
+    // Protected functions
+    float _layer_value(LayerId layer_id, LayerState state) const;
+    void _set_layer_value(LayerId layer_id, float value);
 };
 
 // Layer State param
@@ -319,18 +349,27 @@ protected:
     bool _state_a_only_param;
     int _param_id_d0_state_b;
     int _param_id_d1_state_b;
-    float _value_d0_state_b;
-    float _value_d1_state_b;
     bool _seq_chunk_param;
     std::string _str_value_d0_state_b;
     std::string _str_value_d1_state_b;
+
+    // Protected functions
+    float _state_value(LayerId layer_id, LayerState state) const;
+    void _set_state_value(LayerId layer_id, LayerState state, float value);
+    void _set_morphable();
 };
 
+// Surface Control State ID
+// Control states are interned to dense IDs when loaded, so that they can be
+// compared and looked up without any string work
+constexpr uint CONTROL_STATE_ID_NONE = UINT_MAX;
+
 // Surface Control State struct
 struct SfcControlState
 {
     float value;
     std::string state;
+    uint state_id;
     std::string haptic_mode_name;
     std::vector<Param *> mapped_params;
     std::string group_name;
@@ -341,6 +380,7 @@ struct SfcControlState
     SfcControlState() {
         value = 0.0f;
         state = "";
+        state_id = CONTROL_STATE_ID_NONE;
         haptic_mode_name = "";
         mapped_params.clear();
         group_name = "";
@@ -390,9 +430,12 @@ public:
     void set_group_param(Param *param);
     void set_haptic_mode(const std::string haptic_mode_name);
     bool has_control_state(std::string state);
+    bool has_control_state(uint state_id) const;
+    const std::vector<uint> control_state_ids() const;
     void add_control_state(std::string state);
     void set_default_control_state();
     bool set_control_state(std::string state);
+    bool set_control_state(uint state_id);
     void set_morphable(bool morphable);
 
 protected:
@@ -401,7 +444,7 @@ protected:
     uint _control_num;
     std::vector<SfcControlState> _control_states;
     SfcControlState *_current_control_state;
-    std::string _default_control_state_name;
+    uint _default_control_state_id;
 };
 
 // Knob Param class
@@ -0,0 +1,309 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  param_value_store.cpp
+ * @brief Param Value Store implementation.
+ *-----------------------------------------------------------------------------
+ */
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "param_value_store.h"
+
+// Constants
+constexpr uint NUM_LAYERS = 2;
+constexpr uint NUM_LAYER_STATES = 2;
+
+// Note: The overflow slot indexes a scratch chunk, and is only used if the store
+// is full
+constexpr uint OVERFLOW_SLOT = ParamValueStore::MAX_NUM_SLOTS;
+
+// Param Value Store Chunk
+// Note: Each value is accessed with a relaxed atomic_ref, which compiles to a plain
+// load or store, so that single value accesses never race with the bulk operations.
+// The snapshot values and number of slots are only accessed under the store mutex
+struct ValueStoreChunk
+{
+    alignas(64) float values[NUM_LAYERS][NUM_LAYER_STATES][ParamValueStore::CHUNK_NUM_SLOTS];
+    alignas(64) float snapshot_values[NUM_LAYERS][ParamValueStore::CHUNK_NUM_SLOTS];
+    uint num_slots;
+    bool morphable;
+};
+
+// Param Value Store Pool
+// The chunks the slots of a pool are allocated from, and the freed slots of the
+// pool that can be re-used
+struct ValueStorePool
+{
+    std::vector<uint> chunks;
+    std::vector<uint> free_slots;
+};
+
+// Static variables
+static std::mutex _mutex;
+static ValueStoreChunk _overflow_chunk = {};
+static std::atomic<ValueStoreChunk *> _chunks[ParamValueStore::MAX_NUM_CHUNKS + 1] = {};
+static uint _num_chunks = 0;
+static ValueStorePool _pool;
+static ValueStorePool _morphable_pool;
+
+//----------------------------------------------------------------------------
+// _value
+//----------------------------------------------------------------------------
+static inline std::atomic_ref<float> _value(uint slot, LayerId layer_id, LayerState state)
+{
+    // Return the value for this slot from its chunk
+    auto chunk = _chunks[slot / ParamValueStore::CHUNK_NUM_SLOTS].load(std::memory_order_acquire);
+    return std::atomic_ref<float>(chunk->values[layer_id == LayerId::D0 ? 0 : 1]
+                                               [state == LayerState::STATE_A ? 0 : 1]
+                                               [slot % ParamValueStore::CHUNK_NUM_SLOTS]);
+}
+
+//----------------------------------------------------------------------------
+// _chunk
+//----------------------------------------------------------------------------
+static inline ValueStoreChunk *_chunk(uint chunk)
+{
+    // Return the chunk
+    // Note: The store mutex must be held
+    return _chunks[chunk].load(std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------
+// _chunk_values
+//----------------------------------------------------------------------------
+static inline float *_chunk_values(uint chunk, LayerId layer_id, LayerState state)
+{
+    // Return the values array of this chunk for the layer and state
+    // Note: The store mutex must be held
+    return _chunk(chunk)->values[layer_id == LayerId::D0 ? 0 : 1][state == LayerState::STATE_A ? 0 : 1];
+}
+
+//----------------------------------------------------------------------------
+// _interpolate
+//----------------------------------------------------------------------------
+static inline float _interpolate(float value_a, float value_b, float morph_value)
+{
+    // Linear interpolation from the state A value (morph value 0.0) to the state
+    // B value (morph value 1.0)
+    // Note: Calculated as a weighted sum so that both end values are exact, with or
+    // without FMA contraction
+    return (value_a * (1.0f - morph_value)) + (value_b * morph_value);
+}
+
+//----------------------------------------------------------------------------
+// _alloc
+//----------------------------------------------------------------------------
+static uint _alloc(bool morphable)
+{
+    auto& pool = morphable ? _morphable_pool : _pool;
+    uint slot;
+
+    // Re-use a free slot in the pool if possible, otherwise allocate the next slot
+    // in the last chunk of the pool
+    // Note: The store mutex must be held
+    if (!pool.free_slots.empty()) {
+        slot = pool.free_slots.back();
+        pool.free_slots.pop_back();
+    }
+    else if (!pool.chunks.empty() && (_chunk(pool.chunks.back())->num_slots < ParamValueStore::CHUNK_NUM_SLOTS)) {
+        auto c = _chunk(pool.chunks.back());
+        slot = (pool.chunks.back() * ParamValueStore::CHUNK_NUM_SLOTS) + c->num_slots++;
+    }
+    else if (_num_chunks < ParamValueStore::MAX_NUM_CHUNKS) {
+        // Allocate a new chunk for the pool
+        // Note: Chunks are never freed, so that a value can be accessed without
+        // the store mutex
+        uint chunk = _num_chunks++;
+        auto c = new ValueStoreChunk();
+        c->num_slots = 1;
+        c->morphable = morphable;
+        _chunks[chunk].store(c, std::memory_order_release);
+        pool.chunks.push_back(chunk);
+        slot = chunk * ParamValueStore::CHUNK_NUM_SLOTS;
+    }
+    else {
+        // The store is full - this should never happen as the max number of slots
+        // is well above the number of params
+        MSG("ERROR: Param value store is full");
+        _chunks[OVERFLOW_SLOT / ParamValueStore::CHUNK_NUM_SLOTS].store(&_overflow_chunk, std::memory_order_release);
+        return OVERFLOW_SLOT;
+    }
+
+    // Reset the slot values
+    for (auto layer_id : {LayerId::D0, LayerId::D1}) {
+        for (auto state : {LayerState::STATE_A, LayerState::STATE_B}) {
+            _value(slot, layer_id, state).store(0.0f, std::memory_order_relaxed);
+        }
+    }
+    return slot;
+}
+
+//----------------------------------------------------------------------------
+// _free
+//----------------------------------------------------------------------------
+static void _free(uint slot)
+{
+    // Make the slot available for re-use in its pool
+    // Note: The store mutex must be held
+    if (slot < OVERFLOW_SLOT) {
+        (_chunk(slot / ParamValueStore::CHUNK_NUM_SLOTS)->morphable ? _morphable_pool : _pool).free_slots.push_back(slot);
+    }
+}
+
+//----------------------------------------------------------------------------
+// Alloc
+//----------------------------------------------------------------------------
+uint ParamValueStore::Alloc()
+{
+    // Get the store mutex
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Allocate a slot that is not morphed
+    return _alloc(false);
+}
+
+//----------------------------------------------------------------------------
+// Free
+//----------------------------------------------------------------------------
+void ParamValueStore::Free(uint slot)
+{
+    // Get the store mutex
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Make the slot available for re-use
+    _free(slot);
+}
+
+//----------------------------------------------------------------------------
+// Get
+//----------------------------------------------------------------------------
+float ParamValueStore::Get(uint slot, LayerId layer_id, LayerState state)
+{
+    // Return the value for this slot
+    return _value(slot, layer_id, state).load(std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------
+// Set
+//----------------------------------------------------------------------------
+void ParamValueStore::Set(uint slot, LayerId layer_id, LayerState state, float value)
+{
+    // Set the value for this slot
+    _value(slot, layer_id, state).store(value, std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------
+// SetLayer
+//----------------------------------------------------------------------------
+void ParamValueStore::SetLayer(uint slot, LayerId layer_id, float value)
+{
+    // Set the same value for this slot in both states
+    // Note: The caller holds the param mutex, so no other single value access can
+    // see one state set and not the other
+    _value(slot, layer_id, LayerState::STATE_A).store(value, std::memory_order_relaxed);
+    _value(slot, layer_id, LayerState::STATE_B).store(value, std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------
+// Copy
+//----------------------------------------------------------------------------
+void ParamValueStore::Copy(LayerId layer_id, LayerState from_state, LayerState to_state, const std::vector<uint>& slots)
+{
+    // Get the store mutex
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Copy the values of the specified slots from one state to the other
+    // Note: The values of all other slots are left unchanged
+    if (from_state != to_state) {
+        for (uint slot : slots) {
+            _value(slot, layer_id, to_state).store(_value(slot, layer_id, from_state).load(std::memory_order_relaxed),
+                                                   std::memory_order_relaxed);
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// SetMorphable
+//----------------------------------------------------------------------------
+uint ParamValueStore::SetMorphable(uint slot, bool morphable)
+{
+    // Get the store mutex
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // If the slot is not in the pool for whether it is morphed, move its values to
+    // a slot allocated from that pool, and return the new slot
+    // Note: This changes the slot of the param, so can only be called when the param
+    // is not otherwise being accessed (when it is created or its config loaded)
+    if ((slot < OVERFLOW_SLOT) && (_chunk(slot / CHUNK_NUM_SLOTS)->morphable != morphable)) {
+        uint new_slot = _alloc(morphable);
+        for (auto layer_id : {LayerId::D0, LayerId::D1}) {
+            for (auto state : {LayerState::STATE_A, LayerState::STATE_B}) {
+                _value(new_slot, layer_id, state).store(_value(slot, layer_id, state).load(std::memory_order_relaxed),
+                                                        std::memory_order_relaxed);
+            }
+        }
+        _free(slot);
+        slot = new_slot;
+    }
+    return slot;
+}
+
+//----------------------------------------------------------------------------
+// Snapshot
+//----------------------------------------------------------------------------
+void ParamValueStore::Snapshot(LayerId layer_id, LayerState state)
+{
+    // Get the store mutex
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Snapshot the morphable values of the layer state being morphed from, as
+    // morphing overwrites these values
+    // Note: Each layer has its own snapshot, so morphing one layer never changes
+    // the snapshot of the other
+    uint layer = (layer_id == LayerId::D0 ? 0 : 1);
+    for (uint chunk : _morphable_pool.chunks) {
+        auto values = _chunk_values(chunk, layer_id, state);
+        auto snapshot_values = _chunk(chunk)->snapshot_values[layer];
+        uint num_slots = _chunk(chunk)->num_slots;
+        for (uint i=0; i<num_slots; i++) {
+            snapshot_values[i] = std::atomic_ref<float>(values[i]).load(std::memory_order_relaxed);
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Morph
+//----------------------------------------------------------------------------
+bool ParamValueStore::Morph(LayerId layer_id, LayerState state, float morph_value)
+{
+    bool changed = false;
+
+    // Get the store mutex
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Set the value of each morphable slot in the current state to the value
+    // interpolated between the state A and B values, where the current state value
+    // is taken from the layer snapshot made when morphing started
+    // Note: Only the morphable chunks are processed, and every slot in them is
+    // morphed - a free slot is not used by any param, so its value doesn't matter
+    uint layer = (layer_id == LayerId::D0 ? 0 : 1);
+    for (uint chunk : _morphable_pool.chunks) {
+        auto c = _chunk(chunk);
+        float *values_a = (state == LayerState::STATE_A) ? c->snapshot_values[layer] : _chunk_values(chunk, layer_id, LayerState::STATE_A);
+        float *values_b = (state == LayerState::STATE_B) ? c->snapshot_values[layer] : _chunk_values(chunk, layer_id, LayerState::STATE_B);
+        float *values = _chunk_values(chunk, layer_id, state);
+        uint num_slots = c->num_slots;
+        for (uint i=0; i<num_slots; i++) {
+            float value_a = std::atomic_ref<float>(values_a[i]).load(std::memory_order_relaxed);
+            float value_b = std::atomic_ref<float>(values_b[i]).load(std::memory_order_relaxed);
+            float value = _interpolate(value_a, value_b, morph_value);
+            std::atomic_ref<float> current(values[i]);
+            changed |= (current.load(std::memory_order_relaxed) != value);
+            current.store(value, std::memory_order_relaxed);
+        }
+    }
+    return changed;
+}
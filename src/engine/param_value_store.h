@@ -0,0 +1,49 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  param_value_store.h
+ * @brief Param Value Store class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _PARAM_VALUE_STORE_H
+#define _PARAM_VALUE_STORE_H
+
+#include <vector>
+#include "ui_common.h"
+
+// Param Value Store
+// The normalised values of all Layer and Layer State params, held in contiguous
+// arrays for each Layer and State. Each param is allocated a slot which indexes
+// these arrays, so that bulk operations (such as morphing, or copying params from
+// one state to the other) are passes over the arrays rather than a walk of the params.
+// A param with no state (or a state A only param) holds the same value in both
+// states, so bulk operations can process every slot without checking the param
+// type. Morphing however only sets the slots of the DAW state params, so that the
+// values of all other params are left unchanged - these slots are allocated in
+// their own chunks, so that morphing is a linear pass over just those chunks
+// Note: The arrays are allocated in fixed size chunks that are never moved or
+// freed, so a single value is read and written without the store mutex (the
+// caller holds the mutex of the param that owns the slot). The store mutex is only
+// taken to allocate or free a slot, and for the bulk operations
+class ParamValueStore
+{
+public:
+    // Constants
+    static constexpr uint CHUNK_NUM_SLOTS = 512;
+    static constexpr uint MAX_NUM_CHUNKS = 64;
+    static constexpr uint MAX_NUM_SLOTS = (CHUNK_NUM_SLOTS * MAX_NUM_CHUNKS);
+
+    // Public functions
+    static uint Alloc();
+    static void Free(uint slot);
+    static float Get(uint slot, LayerId layer_id, LayerState state);
+    static void Set(uint slot, LayerId layer_id, LayerState state, float value);
+    static void SetLayer(uint slot, LayerId layer_id, float value);
+    static void Copy(LayerId layer_id, LayerState from_state, LayerState to_state, const std::vector<uint>& slots);
+    static uint SetMorphable(uint slot, bool morphable);
+    static void Snapshot(LayerId layer_id, LayerState state);
+    static bool Morph(LayerId layer_id, LayerState state, float morph_value);
+};
+
+#endif // _PARAM_VALUE_STORE_H
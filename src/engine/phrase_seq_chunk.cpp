@@ -0,0 +1,104 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  phrase_seq_chunk.cpp
+ * @brief Phrase Sequencer Chunk implementation.
+ *-----------------------------------------------------------------------------
+ */
+#include <cstdio>
+#include "phrase_seq_chunk.h"
+
+// Constants
+constexpr uint EVENT_STR_LEN                = (7 * 2);
+constexpr uint MIDI_MAX_NOTE                = 127;
+constexpr uint END_OF_PHRASE_INDICATOR      = 0xFE;
+constexpr char END_OF_CHUNKS_EVENT_STR[]    = "00000000FFFFFF";
+
+//----------------------------------------------------------------------------
+// encode
+//----------------------------------------------------------------------------
+std::vector<std::string> phrase_seq_chunk::encode(const std::vector<PhraseSeqEvent>& seq, uint first_chunk, uint max_chunks)
+{
+    std::vector<std::string> chunks;
+    char str_event[EVENT_STR_LEN + 1];
+
+    // Encode all events from the start of the first chunk, until the end of phrase
+    // event or the max number of chunks
+    for (uint i=(first_chunk * CHUNK_MAX_EVENTS); i<seq.size(); i++) {
+        // Start a new chunk if needed
+        if ((i % CHUNK_MAX_EVENTS) == 0) {
+            if ((first_chunk + chunks.size()) >= max_chunks) {
+                return chunks;
+            }
+            chunks.emplace_back();
+            chunks.back().reserve(CHUNK_MAX_EVENTS * EVENT_STR_LEN);
+        }
+
+        // Is this an end of phrase event?
+        auto& ev = seq[i];
+        if (ev.type == PhraseSeqEventType::END_OF_PHRASE) {
+            // Add the end of phrase event, which ends the phrase
+            std::sprintf(str_event, "%08X%02XFFFF", ev.ticks, END_OF_PHRASE_INDICATOR);
+            chunks.back().append(str_event);
+            return chunks;
+        }
+
+        // Add the note event
+        std::sprintf(str_event, "%08X%02X%02X%02X", ev.ticks, ev.note_event.data.note.channel, ev.note_event.data.note.note, ev.note_event.data.note.velocity);
+        chunks.back().append(str_event);
+    }
+
+    // There is no end of phrase event - if the last chunk is not full, add an invalid
+    // event so that the phrase ends there, rather than continuing into any chunk
+    // saved previously
+    if (!chunks.empty() && (chunks.back().size() < (CHUNK_MAX_EVENTS * EVENT_STR_LEN))) {
+        chunks.back().append(END_OF_CHUNKS_EVENT_STR);
+    }
+    return chunks;
+}
+
+//----------------------------------------------------------------------------
+// decode
+//----------------------------------------------------------------------------
+bool phrase_seq_chunk::decode(const std::string& chunk, std::vector<PhraseSeqEvent>& events)
+{
+    // Decode each event in the chunk
+    for (uint pos=0; (pos + EVENT_STR_LEN)<=chunk.size(); pos+=EVENT_STR_LEN) {
+        // Extract the ticks and channel
+        // Check if the channel is set to the end of phrase indicator
+        auto ticks = std::stoul(chunk.substr(pos, 8), nullptr, 16);
+        auto channel = std::stoul(chunk.substr((pos + 8), 2), nullptr, 16);
+        if (channel == END_OF_PHRASE_INDICATOR) {
+            // Add the end of phrase event, the phrase ends here
+            auto ev = PhraseSeqEvent();
+            ev.type = PhraseSeqEventType::END_OF_PHRASE;
+            ev.ticks = ticks;
+            ev.qnt_ticks = ticks;
+            events.push_back(ev);
+            return false;
+        }
+
+        // Extract the note and velocity, and check if this is a valid note definition
+        auto note = std::stoul(chunk.substr((pos + 10), 2), nullptr, 16);
+        auto vel = std::stoul(chunk.substr((pos + 12), 2), nullptr, 16);
+        if (note > MIDI_MAX_NOTE) {
+            // Note is invalid, the phrase ends here
+            return false;
+        }
+
+        // Add the note event
+        auto ev = PhraseSeqEvent();
+        ev.type = PhraseSeqEventType::NOTE;
+        ev.note_event.type = vel ? snd_seq_event_type::SND_SEQ_EVENT_NOTEON : snd_seq_event_type::SND_SEQ_EVENT_NOTEOFF;
+        ev.note_event.data.note.channel = channel;
+        ev.note_event.data.note.note = note;
+        ev.note_event.data.note.velocity = vel;
+        ev.ticks = ticks;
+        ev.qnt_ticks = ticks;
+        events.push_back(ev);
+    }
+
+    // The phrase continues in the next chunk
+    return true;
+}
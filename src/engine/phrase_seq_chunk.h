@@ -0,0 +1,33 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  phrase_seq_chunk.h
+ * @brief Phrase Sequencer Chunk definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _PHRASE_SEQ_CHUNK_H
+#define _PHRASE_SEQ_CHUNK_H
+
+#include <string>
+#include <vector>
+#include "phrase_seq_timeline.h"
+
+// Phrase Sequencer Chunks
+// A phrase is saved as a sequence of chunk strings (one per chunk param), each
+// holding up to CHUNK_MAX_EVENTS events encoded as 14 hex characters - the ticks,
+// channel, note and velocity. The phrase ends at the end of phrase event, or at the
+// first invalid event
+// Note: Presets saved with the previous fixed size chunks (10 events per chunk)
+// decode unchanged, as each chunk is decoded until its string ends
+namespace phrase_seq_chunk
+{
+    // Constants
+    constexpr uint CHUNK_MAX_EVENTS = 100;
+
+    // Public functions
+    std::vector<std::string> encode(const std::vector<PhraseSeqEvent>& seq, uint first_chunk, uint max_chunks);
+    bool decode(const std::string& chunk, std::vector<PhraseSeqEvent>& events);
+}
+
+#endif // _PHRASE_SEQ_CHUNK_H
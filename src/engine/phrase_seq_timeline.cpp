@@ -0,0 +1,370 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  phrase_seq_timeline.cpp
+ * @brief Phrase Sequencer Timeline implementation.
+ *-----------------------------------------------------------------------------
+ */
+#include <algorithm>
+#include <climits>
+#include "phrase_seq_timeline.h"
+
+// Constants
+constexpr uint BUCKET_TICKS = PPQN;
+constexpr uint GENERATION_NONE = UINT_MAX;
+
+//----------------------------------------------------------------------------
+// PhraseSeqTimeline
+//----------------------------------------------------------------------------
+PhraseSeqTimeline::PhraseSeqTimeline(uint max_events, PhraseSeqQuantiser quantiser) :
+    _max_events(max_events),
+    _quantiser(quantiser)
+{
+    // Initialise class data
+    // Note: The events storage is reserved up-front so that adding an event
+    // while recording never re-allocates the whole sequence
+    _events.reserve(_max_events);
+    _event_generations.reserve(_max_events);
+    _generation = 0;
+    _quantised = false;
+    _max_shift_ticks = 0;
+    _end_ticks = 0;
+    _max_ticks = 0;
+    _cursor_bucket = 0;
+    _cursor_pos = 0;
+    _playhead = -1;
+}
+
+//----------------------------------------------------------------------------
+// ~PhraseSeqTimeline
+//----------------------------------------------------------------------------
+PhraseSeqTimeline::~PhraseSeqTimeline()
+{
+    // Nothing specific to do
+}
+
+//----------------------------------------------------------------------------
+// clear
+//----------------------------------------------------------------------------
+void PhraseSeqTimeline::clear()
+{
+    // Clear all events and reset the timeline
+    _events.clear();
+    _event_generations.clear();
+    _recorded_buckets.clear();
+    _buckets.clear();
+    _end_ticks = 0;
+    _max_ticks = 0;
+    _cursor_bucket = 0;
+    _cursor_pos = 0;
+    _playhead = -1;
+}
+
+//----------------------------------------------------------------------------
+// empty
+//----------------------------------------------------------------------------
+bool PhraseSeqTimeline::empty() const
+{
+    return _events.empty();
+}
+
+//----------------------------------------------------------------------------
+// full
+//----------------------------------------------------------------------------
+bool PhraseSeqTimeline::full() const
+{
+    return _events.size() >= _max_events;
+}
+
+//----------------------------------------------------------------------------
+// size
+//----------------------------------------------------------------------------
+uint PhraseSeqTimeline::size() const
+{
+    return _events.size();
+}
+
+//----------------------------------------------------------------------------
+// add_event
+//----------------------------------------------------------------------------
+uint PhraseSeqTimeline::add_event(const PhraseSeqEvent& event)
+{
+    // Add the event to the end of the events storage, and quantise it
+    uint index = _events.size();
+    _events.push_back(event);
+    _event_generations.push_back(GENERATION_NONE);
+    _quantise_event(index);
+
+    // Add the event to the bucket for its recorded ticks
+    uint recorded_bucket_index = _bucket_index(event.ticks);
+    if (recorded_bucket_index >= _recorded_buckets.size()) {
+        _recorded_buckets.resize(recorded_bucket_index + 1);
+    }
+    _recorded_buckets[recorded_bucket_index].push_back(index);
+    _max_ticks = std::max(_max_ticks, event.ticks);
+    _resize_buckets();
+
+    // If the timeline bucket for this event has not been built since the last
+    // requantise, the event is added when it is built
+    auto key = _key(index);
+    uint bucket_index = _bucket_index(key);
+    if (bucket_index >= _buckets.size()) {
+        _buckets.resize(bucket_index + 1, {{}, GENERATION_NONE});
+    }
+    auto& bucket = _buckets[bucket_index];
+    if (bucket.generation != _generation) {
+        return index;
+    }
+
+    // Insert the event after any other events with the same ticks
+    auto itr = std::upper_bound(bucket.events.begin(), bucket.events.end(), key, [this](uint32_t k, uint i) {return k < _key(i);});
+    uint pos = itr - bucket.events.begin();
+    bucket.events.insert(itr, index);
+
+    // If the event was inserted behind the playback cursor, or at a position that has
+    // already been played, move the cursor so that it still points to the same next
+    // event - the event will be played from the next loop of the timeline
+    if ((bucket_index == _cursor_bucket) && ((pos < _cursor_pos) || ((int64_t)key <= _playhead))) {
+        _cursor_pos++;
+    }
+    return index;
+}
+
+//----------------------------------------------------------------------------
+// event
+//----------------------------------------------------------------------------
+const PhraseSeqEvent& PhraseSeqTimeline::event(uint index) const
+{
+    return _events[index];
+}
+
+//----------------------------------------------------------------------------
+// events
+//----------------------------------------------------------------------------
+const std::vector<PhraseSeqEvent>& PhraseSeqTimeline::events() const
+{
+    // Note: The quantised ticks of an event are only valid once the timeline
+    // bucket it is played from has been built
+    return _events;
+}
+
+//----------------------------------------------------------------------------
+// set_ticks
+//----------------------------------------------------------------------------
+void PhraseSeqTimeline::set_ticks(uint index, uint32_t ticks)
+{
+    // Move the event to the bucket for its new recorded ticks
+    // Note: The timeline must be requantised after changing the ticks of any event
+    auto& recorded_bucket = _recorded_buckets[_bucket_index(_events[index].ticks)];
+    recorded_bucket.erase(std::find(recorded_bucket.begin(), recorded_bucket.end(), index));
+    uint recorded_bucket_index = _bucket_index(ticks);
+    if (recorded_bucket_index >= _recorded_buckets.size()) {
+        _recorded_buckets.resize(recorded_bucket_index + 1);
+    }
+    auto& new_recorded_bucket = _recorded_buckets[recorded_bucket_index];
+    new_recorded_bucket.insert(std::upper_bound(new_recorded_bucket.begin(), new_recorded_bucket.end(), index), index);
+    _events[index].ticks = ticks;
+    _max_ticks = std::max(_max_ticks, ticks);
+    _event_generations[index] = GENERATION_NONE;
+}
+
+//----------------------------------------------------------------------------
+// requantise
+//----------------------------------------------------------------------------
+void PhraseSeqTimeline::requantise(bool quantised, uint32_t max_shift_ticks, uint32_t end_ticks)
+{
+    // Start a new generation of the timeline - each event is quantised, and each
+    // bucket rebuilt, when it is next accessed
+    _generation = (_generation + 1) % GENERATION_NONE;
+    _quantised = quantised;
+    _max_shift_ticks = max_shift_ticks;
+    _end_ticks = end_ticks;
+    _resize_buckets();
+
+    // Reset the playback cursor to the start of the timeline
+    _cursor_bucket = 0;
+    _cursor_pos = 0;
+    _playhead = -1;
+}
+
+//----------------------------------------------------------------------------
+// seek
+//----------------------------------------------------------------------------
+void PhraseSeqTimeline::seek(uint32_t ticks)
+{
+    // Position the playback cursor at the first event at or after the
+    // specified ticks
+    _cursor_bucket = _bucket_index(ticks);
+    _cursor_pos = 0;
+    _playhead = (int64_t)ticks - 1;
+    if (_cursor_bucket < _buckets.size()) {
+        auto& bucket = _current_bucket(_cursor_bucket);
+        auto itr = std::lower_bound(bucket.events.begin(), bucket.events.end(), ticks, [this](uint i, uint32_t k) {return _key(i) < k;});
+        _cursor_pos = itr - bucket.events.begin();
+    }
+}
+
+//----------------------------------------------------------------------------
+// end
+//----------------------------------------------------------------------------
+bool PhraseSeqTimeline::end()
+{
+    // Check if there are any events still to be played from the playback cursor
+    // Note: Only the last bucket needs to be checked, as no event is played after
+    // the end of phrase event, which is always in the last bucket
+    if (_cursor_bucket < _buckets.size()) {
+        return (_cursor_bucket == (_buckets.size() - 1)) && (_cursor_pos >= _current_bucket(_cursor_bucket).events.size());
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// next_event
+//----------------------------------------------------------------------------
+const PhraseSeqEvent *PhraseSeqTimeline::next_event(uint32_t ticks)
+{
+    // Move the playhead, and process each bucket up to and including the bucket
+    // for the specified ticks
+    // Note: The cursor is never moved past this bucket, so that events added after the
+    // playhead are always played
+    _playhead = ticks;
+    uint last_bucket = _bucket_index(ticks);
+    while ((_cursor_bucket < _buckets.size()) && (_cursor_bucket <= last_bucket)) {
+        // Make sure the bucket is built before playing from it
+        auto& bucket = _current_bucket(_cursor_bucket);
+
+        // Is there an event to check in this bucket?
+        if (_cursor_pos < bucket.events.size()) {
+            // If this event is due to be played, return it and advance the cursor
+            uint index = bucket.events[_cursor_pos];
+            if (_key(index) <= ticks) {
+                _cursor_pos++;
+                return &_events[index];
+            }
+            break;
+        }
+
+        // Move to the next bucket, if it is not past the bucket for the specified ticks
+        if (_cursor_bucket == last_bucket) {
+            break;
+        }
+        _cursor_bucket++;
+        _cursor_pos = 0;
+    }
+    return nullptr;
+}
+
+//----------------------------------------------------------------------------
+// _key
+//----------------------------------------------------------------------------
+inline uint32_t PhraseSeqTimeline::_key(uint index) const
+{
+    // Return the ticks the timeline is ordered by
+    return _quantised ? _events[index].qnt_ticks : _events[index].ticks;
+}
+
+//----------------------------------------------------------------------------
+// _bucket_index
+//----------------------------------------------------------------------------
+inline uint PhraseSeqTimeline::_bucket_index(uint32_t ticks) const
+{
+    return ticks / BUCKET_TICKS;
+}
+
+//----------------------------------------------------------------------------
+// _last_bucket
+//----------------------------------------------------------------------------
+uint PhraseSeqTimeline::_last_bucket() const
+{
+    // If the end of the phrase is set, no event is played after it, otherwise
+    // quantising can move the last recorded event by up to the max shift ticks
+    if (_end_ticks) {
+        return _bucket_index(std::max(_end_ticks, _max_ticks));
+    }
+    return _bucket_index(_quantised ? (_max_ticks + _max_shift_ticks) : _max_ticks);
+}
+
+//----------------------------------------------------------------------------
+// _resize_buckets
+//----------------------------------------------------------------------------
+void PhraseSeqTimeline::_resize_buckets()
+{
+    // Make sure there is a bucket for every ticks an event can be played at - any
+    // new buckets are built when first accessed
+    if (!_events.empty()) {
+        _buckets.resize(_last_bucket() + 1, {{}, GENERATION_NONE});
+    }
+}
+
+//----------------------------------------------------------------------------
+// _quantise_event
+//----------------------------------------------------------------------------
+void PhraseSeqTimeline::_quantise_event(uint index)
+{
+    // Quantise the event if it has not been quantised since the last requantise
+    // Note: A NOTE OFF event is quantised from its NOTE ON event, so make sure
+    // that is quantised first
+    if (_event_generations[index] != _generation) {
+        auto& ev = _events[index];
+        const PhraseSeqEvent *note_on_event = nullptr;
+        if (ev.note_on_index >= 0) {
+            _quantise_event(ev.note_on_index);
+            note_on_event = &_events[ev.note_on_index];
+        }
+        _quantiser(ev, note_on_event);
+        _event_generations[index] = _generation;
+    }
+}
+
+//----------------------------------------------------------------------------
+// _current_bucket
+//----------------------------------------------------------------------------
+PhraseSeqTimeline::Bucket& PhraseSeqTimeline::_current_bucket(uint bucket_index)
+{
+    auto& bucket = _buckets[bucket_index];
+
+    // Has this bucket been built since the last requantise?
+    if (bucket.generation != _generation) {
+        // Get the range of recorded buckets an event played from this bucket can
+        // be recorded in
+        // Note: Events recorded near the start or end of the phrase can wrap around,
+        // so when quantised those recorded buckets are also checked
+        uint32_t start_ticks = bucket_index * BUCKET_TICKS;
+        std::pair<uint, uint> ranges[] = {
+            {_bucket_index((start_ticks > _max_shift_ticks) ? (start_ticks - _max_shift_ticks) : 0), _bucket_index(start_ticks + BUCKET_TICKS - 1 + _max_shift_ticks)},
+            {0, 0},
+            {0, 0}
+        };
+        uint num_ranges = 1;
+        if (_quantised && _end_ticks) {
+            ranges[num_ranges++] = {0, _bucket_index(_max_shift_ticks)};
+            ranges[num_ranges++] = {_bucket_index((_end_ticks > _max_shift_ticks) ? (_end_ticks - _max_shift_ticks) : 0), UINT_MAX};
+            std::sort(ranges, (ranges + num_ranges));
+        }
+
+        // Quantise the events in each recorded bucket in these ranges, and add those now
+        // played from this bucket
+        bucket.events.clear();
+        uint next = 0;
+        for (uint i=0; i<num_ranges; i++) {
+            for (uint j=std::max(ranges[i].first, next); (j <= ranges[i].second) && (j < _recorded_buckets.size()); j++) {
+                for (uint index : _recorded_buckets[j]) {
+                    _quantise_event(index);
+                    if (_bucket_index(_key(index)) == bucket_index) {
+                        bucket.events.push_back(index);
+                    }
+                }
+                next = j + 1;
+            }
+        }
+
+        // Order the events by ticks - events with the same ticks are kept in the order
+        // they were added
+        std::sort(bucket.events.begin(), bucket.events.end(), [this](uint a, uint b) {
+            return (_key(a) < _key(b)) || ((_key(a) == _key(b)) && (a < b));
+        });
+        bucket.generation = _generation;
+    }
+    return bucket;
+}
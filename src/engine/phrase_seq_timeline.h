@@ -0,0 +1,103 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  phrase_seq_timeline.h
+ * @brief Phrase Sequencer Timeline class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _PHRASE_SEQ_TIMELINE_H
+#define _PHRASE_SEQ_TIMELINE_H
+
+#include <functional>
+#include <vector>
+#include "alsa/asoundlib.h"
+#include "ui_common.h"
+
+// Phrase Sequencer Event Type
+enum class PhraseSeqEventType
+{
+    NOTE,
+    END_OF_PHRASE
+};
+
+// Phrase Sequencer Event
+struct PhraseSeqEvent
+{
+    PhraseSeqEventType type;
+    snd_seq_event_t note_event;
+    uint32_t ticks;
+    uint32_t qnt_ticks;
+    int note_on_index = -1;
+};
+
+// Phrase Sequencer Quantiser
+// Sets the quantised ticks of an event, the NOTE ON event is specified for a
+// paired NOTE OFF event
+typedef std::function<void(PhraseSeqEvent& event, const PhraseSeqEvent *note_on_event)> PhraseSeqQuantiser;
+
+// Phrase Sequencer Timeline class
+// The events are stored in the order they were added, and indexed by a tick
+// bucketed timeline (one bucket per beat) which is ordered by either the
+// recorded or quantised ticks
+// Requantising is lazy - each bucket is rebuilt when next played, from the events
+// recorded within the max shift ticks of that bucket. The quantiser must not move
+// an event by more than the max shift ticks, other than an event recorded within
+// the max shift ticks of the start or end of the phrase, which can wrap around
+class PhraseSeqTimeline
+{
+public:
+    // Constructor
+    PhraseSeqTimeline(uint max_events, PhraseSeqQuantiser quantiser);
+
+    // Destructor
+    ~PhraseSeqTimeline();
+
+    // Public functions
+    void clear();
+    bool empty() const;
+    bool full() const;
+    uint size() const;
+    uint add_event(const PhraseSeqEvent& event);
+    const PhraseSeqEvent& event(uint index) const;
+    const std::vector<PhraseSeqEvent>& events() const;
+    void set_ticks(uint index, uint32_t ticks);
+    void requantise(bool quantised, uint32_t max_shift_ticks, uint32_t end_ticks);
+    void seek(uint32_t ticks);
+    bool end();
+    const PhraseSeqEvent *next_event(uint32_t ticks);
+
+private:
+    // Timeline Bucket
+    struct Bucket
+    {
+        std::vector<uint> events;
+        uint generation;
+    };
+
+    // Private variables
+    const uint _max_events;
+    PhraseSeqQuantiser _quantiser;
+    std::vector<PhraseSeqEvent> _events;
+    std::vector<uint> _event_generations;
+    std::vector<std::vector<uint>> _recorded_buckets;
+    std::vector<Bucket> _buckets;
+    uint _generation;
+    bool _quantised;
+    uint32_t _max_shift_ticks;
+    uint32_t _end_ticks;
+    uint32_t _max_ticks;
+    uint _cursor_bucket;
+    uint _cursor_pos;
+    int64_t _playhead;
+
+    // Private functions
+    inline uint32_t _key(uint index) const;
+    inline uint _bucket_index(uint32_t ticks) const;
+    uint _last_bucket() const;
+    void _resize_buckets();
+    void _quantise_event(uint index);
+    Bucket& _current_bucket(uint bucket_index);
+};
+
+#endif // _PHRASE_SEQ_TIMELINE_H
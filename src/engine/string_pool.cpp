@@ -0,0 +1,143 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  string_pool.cpp
+ * @brief String Pool implementation.
+ *-----------------------------------------------------------------------------
+ */
+#include <functional>
+#include <mutex>
+#include <unordered_set>
+#include "string_pool.h"
+#include "metrics.h"
+
+// String List Hash
+struct StringListHash
+{
+    size_t operator()(const std::vector<std::string>& list) const {
+        size_t hash = list.size();
+        for (const auto& str : list) {
+            hash ^= std::hash<std::string>()(str) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        }
+        return hash;
+    }
+};
+
+// Static variables
+// Note: The entries of an unordered set are never moved, so references to them
+// remain valid as the pool grows
+static std::mutex _mutex;
+static std::unordered_set<std::string> _strings;
+static std::unordered_set<std::vector<std::string>, StringListHash> _lists;
+static StringPoolStats _stats = {};
+static Metric _num_strings("string_pool_entries{type=\"string\"}", MetricType::GAUGE);
+static Metric _num_lists("string_pool_entries{type=\"list\"}", MetricType::GAUGE);
+static Metric _pooled_bytes("string_pool_bytes{type=\"pooled\"}", MetricType::GAUGE);
+
+//----------------------------------------------------------------------------
+// _string_bytes
+//----------------------------------------------------------------------------
+static size_t _string_bytes(const std::string& str)
+{
+    // The string object, plus its heap buffer if the string does not fit in the
+    // small string buffer
+    return sizeof(std::string) + ((str.capacity() > std::string().capacity()) ? (str.capacity() + 1) : 0);
+}
+
+//----------------------------------------------------------------------------
+// _list_bytes
+//----------------------------------------------------------------------------
+static size_t _list_bytes(const std::vector<std::string>& list)
+{
+    // The list object, plus its heap buffer and the heap buffers of each string
+    size_t bytes = sizeof(std::vector<std::string>) + ((list.capacity() - list.size()) * sizeof(std::string));
+    for (const auto& str : list) {
+        bytes += _string_bytes(str);
+    }
+    return bytes;
+}
+
+//----------------------------------------------------------------------------
+// _update_stats
+//----------------------------------------------------------------------------
+static void _update_stats(size_t entry_bytes)
+{
+    // Add a new entry to the pool stats
+    _stats.pooled_bytes += entry_bytes;
+    _num_strings.set(_stats.num_strings);
+    _num_lists.set(_stats.num_lists);
+    _pooled_bytes.set(_stats.pooled_bytes);
+}
+
+//----------------------------------------------------------------------------
+// Intern
+//----------------------------------------------------------------------------
+const std::string *StringPool::Intern(const std::string& str)
+{
+    // Get the pool mutex
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Add the string to the pool if it is not already pooled, and return the
+    // pooled copy
+    auto [itr, added] = _strings.insert(str);
+    if (added) {
+        _stats.num_strings++;
+        _update_stats(_string_bytes(*itr));
+    }
+    return &*itr;
+}
+
+//----------------------------------------------------------------------------
+// Intern
+//----------------------------------------------------------------------------
+const std::vector<std::string> *StringPool::Intern(const std::vector<std::string>& list)
+{
+    // Get the pool mutex
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Add the list to the pool if it is not already pooled, and return the
+    // pooled copy
+    auto [itr, added] = _lists.insert(list);
+    if (added) {
+        _stats.num_lists++;
+        _update_stats(_list_bytes(*itr));
+    }
+    return &*itr;
+}
+
+//----------------------------------------------------------------------------
+// Stats
+//----------------------------------------------------------------------------
+StringPoolStats StringPool::Stats()
+{
+    // Get the pool mutex
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
+
+//----------------------------------------------------------------------------
+// CountRef
+//----------------------------------------------------------------------------
+void StringPool::CountRef(StringPoolRefs& refs, const std::string *str)
+{
+    // A pooled reference holds a pointer to the entry, whereas an owned copy
+    // holds the entry itself
+    // Note: Pooled entries are read-only, so no lock is needed
+    refs.num_refs++;
+    refs.ref_bytes += sizeof(str);
+    refs.unpooled_bytes += _string_bytes(*str);
+}
+
+//----------------------------------------------------------------------------
+// CountRef
+//----------------------------------------------------------------------------
+void StringPool::CountRef(StringPoolRefs& refs, const std::vector<std::string> *list)
+{
+    // A pooled reference holds a pointer to the entry, whereas an owned copy
+    // holds the entry itself
+    // Note: Pooled entries are read-only, so no lock is needed
+    refs.num_refs++;
+    refs.ref_bytes += sizeof(list);
+    refs.unpooled_bytes += _list_bytes(*list);
+}
@@ -0,0 +1,55 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  string_pool.h
+ * @brief String Pool class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _STRING_POOL_H
+#define _STRING_POOL_H
+
+#include <string>
+#include <vector>
+#include "ui_common.h"
+
+// String Pool Stats
+// The entries held in the pool, and the bytes they hold
+struct StringPoolStats
+{
+    uint num_strings;
+    uint num_lists;
+    size_t pooled_bytes;
+};
+
+// String Pool Refs
+// The live references to pooled entries (counted by walking the referencing
+// objects), the bytes these references hold, and the bytes they would hold if
+// each reference owned its own copy of the entry
+struct StringPoolRefs
+{
+    uint num_refs;
+    size_t ref_bytes;
+    size_t unpooled_bytes;
+};
+
+// String Pool
+// A single, read-only copy of each distinct param metadata string and string
+// list (ref, display names, list names, value strings and tags). This metadata
+// is set when the param files are parsed, and is heavily duplicated across the
+// params (most strings are shared by both layers and the state B params), so
+// each param references the pooled copy rather than owning its own
+// Note: Pooled entries are never freed, so a reference stays valid for the life
+// of the app, and can be read without a lock
+class StringPool
+{
+public:
+    // Public functions
+    static const std::string *Intern(const std::string& str);
+    static const std::vector<std::string> *Intern(const std::vector<std::string>& list);
+    static StringPoolStats Stats();
+    static void CountRef(StringPoolRefs& refs, const std::string *str);
+    static void CountRef(StringPoolRefs& refs, const std::vector<std::string> *list);
+};
+
+#endif // _STRING_POOL_H
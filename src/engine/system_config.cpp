@@ -10,6 +10,19 @@
 #include "system_config.h"
 #include "utils.h"
 
+// Constants
+// Default Expression pedal filter config
+// Note: The AIN1 ADC has a resolution of 124-255 steps (depending on the CM4
+// revision), so the dead-band is just over one step
+constexpr AinFilterConfig DEFAULT_EXPRESSION_PEDAL_FILTER_CONFIG = {
+    .oversample = 3,
+    .smoothing_min = 0.2f,
+    .smoothing_max = 1.0f,
+    .fast_delta = 0.05f,
+    .dead_band = 0.01f,
+    .min_publish_interval = std::chrono::milliseconds(20)
+};
+
 
 //----------------------------------------------------------------------------
 // SystemConfig
@@ -19,6 +32,10 @@ SystemConfig::SystemConfig()
     // Initialise class data
     _mod_src_num = DEFAULT_MOD_SRC_NUM;
     _demo_mode = false;
+    _expression_pedal_filter_config = DEFAULT_EXPRESSION_PEDAL_FILTER_CONFIG;
+    _gui_msg_ring = false;
+    _note_scheduler = false;
+    _local_morph = false;
 }
 
 //----------------------------------------------------------------------------
@@ -222,3 +239,79 @@ bool SystemConfig::system_colour_is_custom()
     }
     return true;
 }
+
+//----------------------------------------------------------------------------
+// get_expression_pedal_filter_config
+//----------------------------------------------------------------------------
+AinFilterConfig SystemConfig::get_expression_pedal_filter_config()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Return the Expression pedal filter config
+    return _expression_pedal_filter_config;
+}
+
+//----------------------------------------------------------------------------
+// set_expression_pedal_filter_config
+//----------------------------------------------------------------------------
+void SystemConfig::set_expression_pedal_filter_config(const AinFilterConfig& config)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Set the Expression pedal filter config
+    _expression_pedal_filter_config = config;
+}
+
+//----------------------------------------------------------------------------
+// get_gui_msg_ring
+//----------------------------------------------------------------------------
+bool SystemConfig::get_gui_msg_ring()
+{
+    // Return if the GUI Message Ring is enabled
+    return _gui_msg_ring;
+}
+
+//----------------------------------------------------------------------------
+// set_gui_msg_ring
+//----------------------------------------------------------------------------
+void SystemConfig::set_gui_msg_ring(bool enable)
+{
+    // Enable/disable the GUI Message Ring
+    _gui_msg_ring = enable;
+}
+
+//----------------------------------------------------------------------------
+// get_note_scheduler
+//----------------------------------------------------------------------------
+bool SystemConfig::get_note_scheduler()
+{
+    // Return if the Note Scheduler is enabled
+    return _note_scheduler;
+}
+
+//----------------------------------------------------------------------------
+// set_note_scheduler
+//----------------------------------------------------------------------------
+void SystemConfig::set_note_scheduler(bool enable)
+{
+    // Enable/disable the Note Scheduler
+    _note_scheduler = enable;
+}
+
+//----------------------------------------------------------------------------
+// get_local_morph
+//----------------------------------------------------------------------------
+bool SystemConfig::get_local_morph()
+{
+    // Return if the local dance mode morph is enabled
+    return _local_morph;
+}
+
+//----------------------------------------------------------------------------
+// set_local_morph
+//----------------------------------------------------------------------------
+void SystemConfig::set_local_morph(bool enable)
+{
+    // Enable/disable the local dance mode morph
+    _local_morph = enable;
+}
@@ -12,6 +12,7 @@
 #include <mutex>
 #include "param.h"
 #include "ui_common.h"
+#include "ain_filter.h"
 
 // System Config struct
 class SystemConfig
@@ -40,6 +41,14 @@ public:
     void set_system_colour(std::string colour);
     void add_available_system_colour(SystemColour colour);
     bool system_colour_is_custom();
+    AinFilterConfig get_expression_pedal_filter_config();
+    void set_expression_pedal_filter_config(const AinFilterConfig& config);
+    bool get_gui_msg_ring();
+    void set_gui_msg_ring(bool enable);
+    bool get_note_scheduler();
+    void set_note_scheduler(bool enable);
+    bool get_local_morph();
+    void set_local_morph(bool enable);
 
 private:
     // Private variables
@@ -52,6 +61,10 @@ private:
     uint _demo_mode_timeout;
     std::string _system_colour;
     std::vector<SystemColour> _system_colours;
+    AinFilterConfig _expression_pedal_filter_config;
+    bool _gui_msg_ring;
+    bool _note_scheduler;
+    bool _local_morph;
 };
 
 #endif  // _SYSTEM_CONFIG_H
@@ -0,0 +1,113 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  tempo_pulse_counter.cpp
+ * @brief Tempo Pulse Counter implementation.
+ *-----------------------------------------------------------------------------
+ */
+#include "tempo_pulse_counter.h"
+
+//----------------------------------------------------------------------------
+// TempoPulseCounter
+//----------------------------------------------------------------------------
+TempoPulseCounter::TempoPulseCounter()
+{
+    // Initialise class data
+    _tempo_pulse_count = PulseCount(common::TempoNoteValue::QUARTER);
+    _note_duration_pulse_count = _tempo_pulse_count >> 1;
+    _pulse_count = 0;
+}
+
+//----------------------------------------------------------------------------
+// ~TempoPulseCounter
+//----------------------------------------------------------------------------
+TempoPulseCounter::~TempoPulseCounter()
+{
+    // Nothing specific to do
+}
+
+//----------------------------------------------------------------------------
+// PulseCount
+//----------------------------------------------------------------------------
+uint TempoPulseCounter::PulseCount(common::TempoNoteValue note_value)
+{
+    // Return the number of MIDI clock pulses for the note value
+    switch (note_value)
+    {
+        case common::TempoNoteValue::QUARTER:
+            return NUM_MIDI_CLOCK_PULSES_PER_QTR_NOTE_BEAT / 1;
+
+        case common::TempoNoteValue::EIGHTH:
+            return NUM_MIDI_CLOCK_PULSES_PER_QTR_NOTE_BEAT / 2;
+
+        case common::TempoNoteValue::SIXTEENTH:
+            return NUM_MIDI_CLOCK_PULSES_PER_QTR_NOTE_BEAT / 4;
+
+        case common::TempoNoteValue::THIRTYSECOND:
+            return NUM_MIDI_CLOCK_PULSES_PER_QTR_NOTE_BEAT / 8;
+
+        case common::TempoNoteValue::QUARTER_TRIPLETS:
+            return NUM_MIDI_CLOCK_PULSES_PER_QTR_NOTE_BEAT / 1.5;
+
+        case common::TempoNoteValue::EIGHTH_TRIPLETS:
+            return NUM_MIDI_CLOCK_PULSES_PER_QTR_NOTE_BEAT / 3;
+
+        case common::TempoNoteValue::SIXTEENTH_TRIPLETS:
+            return NUM_MIDI_CLOCK_PULSES_PER_QTR_NOTE_BEAT / 6;
+
+        case common::TempoNoteValue::THIRTYSECOND_TRIPLETS:
+            return NUM_MIDI_CLOCK_PULSES_PER_QTR_NOTE_BEAT / 12;
+
+        default:
+            return NUM_MIDI_CLOCK_PULSES_PER_QTR_NOTE_BEAT / 1;
+    }
+}
+
+//----------------------------------------------------------------------------
+// tempo_pulse_count
+//----------------------------------------------------------------------------
+uint TempoPulseCounter::tempo_pulse_count() const
+{
+    return _tempo_pulse_count;
+}
+
+//----------------------------------------------------------------------------
+// note_duration_pulse_count
+//----------------------------------------------------------------------------
+uint TempoPulseCounter::note_duration_pulse_count() const
+{
+    return _note_duration_pulse_count;
+}
+
+//----------------------------------------------------------------------------
+// set_tempo_pulse_count
+//----------------------------------------------------------------------------
+void TempoPulseCounter::set_tempo_pulse_count(uint pulse_count)
+{
+    // Set the tempo note pulse count, the note duration is half of it
+    // Note: The current pulse count is not reset, so a tempo note in progress
+    // ends when the new note duration is reached
+    _tempo_pulse_count = pulse_count;
+    _note_duration_pulse_count = _tempo_pulse_count >> 1;
+}
+
+//----------------------------------------------------------------------------
+// pulse
+//----------------------------------------------------------------------------
+bool TempoPulseCounter::pulse()
+{
+    // Count the pulse, and return if the current duration has been reached
+    return ++_pulse_count >= _note_duration_pulse_count;
+}
+
+//----------------------------------------------------------------------------
+// next_duration
+//----------------------------------------------------------------------------
+void TempoPulseCounter::next_duration(bool end_on_next_pulse)
+{
+    // Switch to the other duration of the tempo note, and restart the count
+    // If specified, the count is set so that this duration ends on the next pulse
+    _note_duration_pulse_count = _tempo_pulse_count - _note_duration_pulse_count;
+    _pulse_count = end_on_next_pulse ? (_note_duration_pulse_count - 1) : 0;
+}
@@ -0,0 +1,43 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  tempo_pulse_counter.h
+ * @brief Tempo Pulse Counter class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _TEMPO_PULSE_COUNTER_H
+#define _TEMPO_PULSE_COUNTER_H
+
+#include "ui_common.h"
+
+// Tempo Pulse Counter class
+// Counts the tempo pulses signalled to the Sequencer and Arpeggiator tempo
+// threads. Each tempo note is split into two durations, the note (half the
+// tempo note pulse count) and the remainder of the tempo note, and the counter
+// indicates when the pulse count for the current duration has been reached
+class TempoPulseCounter
+{
+public:
+    // Constructor
+    TempoPulseCounter();
+
+    // Destructor
+    ~TempoPulseCounter();
+
+    // Public functions
+    static uint PulseCount(common::TempoNoteValue note_value);
+    uint tempo_pulse_count() const;
+    uint note_duration_pulse_count() const;
+    void set_tempo_pulse_count(uint pulse_count);
+    bool pulse();
+    void next_duration(bool end_on_next_pulse=false);
+
+private:
+    // Private variables
+    uint _tempo_pulse_count;
+    uint _note_duration_pulse_count;
+    uint _pulse_count;
+};
+
+#endif  // _TEMPO_PULSE_COUNTER_H
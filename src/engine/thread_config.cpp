@@ -0,0 +1,171 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  thread_config.cpp
+ * @brief Thread Config implementation.
+ *-----------------------------------------------------------------------------
+ */
+#include <sched.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#define RAPIDJSON_HAS_STDSTRING 1
+#include "rapidjson/document.h"
+#include "rapidjson/schema.h"
+#include "ui_common.h"
+#include "thread_config.h"
+
+// Constants
+constexpr char THREAD_CONFIG_FILE[] = "thread_config.json";
+constexpr uint MAX_THREAD_NAME_LEN  = 15;
+
+// Thread Config Entry
+struct ThreadConfigEntry
+{
+    std::string name;
+    bool policy_set;
+    int policy;
+    int priority;
+    std::vector<uint> cpus;
+};
+
+// Static variables
+// Note: The config is only written by Load, before the engine threads are created
+static std::map<std::string, ThreadConfigEntry> _config;
+
+//----------------------------------------------------------------------------
+// _open_thread_config_file
+//----------------------------------------------------------------------------
+static bool _open_thread_config_file(rapidjson::Document &json_data)
+{
+    const char *schema =
+#include "../json_schemas/thread_config_schema.json"
+;
+    rapidjson::Document schema_data;
+
+    // Open the thread config file - if it doesn't exist, the threads just use
+    // their defaults
+    std::ifstream json_file(MONIQUE_ROOT_FILE_PATH(THREAD_CONFIG_FILE));
+    if (!json_file.good()) {
+        return false;
+    }
+    std::string json_file_contents((std::istreambuf_iterator<char>(json_file)), std::istreambuf_iterator<char>());
+    json_data.Parse(json_file_contents.c_str());
+    if (json_data.HasParseError()) {
+        MSG("Thread config file read error: " << THREAD_CONFIG_FILE);
+        return false;
+    }
+
+    // Validate the JSON data against the schema
+    schema_data.Parse(schema);
+    rapidjson::SchemaDocument schema_document(schema_data);
+    rapidjson::SchemaValidator schema_validator(schema_document);
+    if (!json_data.Accept(schema_validator)) {
+        MSG("Thread config schema validation failed: " << THREAD_CONFIG_FILE);
+        return false;
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// _thread_name
+//----------------------------------------------------------------------------
+static std::string _thread_name(const std::string& name, const std::string& suffix)
+{
+    // Return the thread name with its suffix, truncating the name so that the
+    // suffix is always kept
+    return name.substr(0, (MAX_THREAD_NAME_LEN - std::min(suffix.size(), size_t(MAX_THREAD_NAME_LEN)))) + suffix;
+}
+
+//----------------------------------------------------------------------------
+// Load
+//----------------------------------------------------------------------------
+void ThreadConfig::Load()
+{
+    rapidjson::Document json_data;
+
+    // Open the thread config file
+    _config.clear();
+    if (!_open_thread_config_file(json_data)) {
+        return;
+    }
+
+    // Parse each thread config entry
+    for (auto& item : json_data.GetArray()) {
+        auto obj = item.GetObject();
+        ThreadConfigEntry entry = {};
+        entry.name = obj.HasMember("name") ? obj["name"].GetString() : obj["thread"].GetString();
+        if (obj.HasMember("policy")) {
+            entry.policy_set = true;
+            entry.policy = (std::strcmp(obj["policy"].GetString(), "SCHED_FIFO") == 0) ? SCHED_FIFO : SCHED_OTHER;
+            entry.priority = obj.HasMember("priority") ? obj["priority"].GetInt() : 0;
+        }
+        else if (obj.HasMember("priority")) {
+            // A priority is meaningless without a policy, so warn that it is ignored
+            // Note: The schema should already reject this
+            MSG("Thread config: " << obj["thread"].GetString() << " priority ignored, no policy specified");
+        }
+        if (obj.HasMember("cpus")) {
+            for (auto& cpu : obj["cpus"].GetArray()) {
+                entry.cpus.push_back(cpu.GetUint());
+            }
+        }
+        _config[obj["thread"].GetString()] = entry;
+    }
+    MSG("Thread config: " << _config.size() << " threads configured");
+}
+
+//----------------------------------------------------------------------------
+// Apply
+//----------------------------------------------------------------------------
+void ThreadConfig::Apply(pthread_t thread, const char *id, const std::string& name_suffix)
+{
+    // Is there a config for this thread?
+    auto itr = _config.find(id);
+    if (itr == _config.end()) {
+        // No, just name the thread with its ID
+        ::pthread_setname_np(thread, _thread_name(id, name_suffix).c_str());
+        return;
+    }
+    auto& entry = itr->second;
+    auto name = _thread_name(entry.name, name_suffix);
+    std::ostringstream report;
+    report << "Thread " << id << name_suffix << ": name " << name;
+
+    // Set the thread name
+    ::pthread_setname_np(thread, name.c_str());
+
+    // Set the scheduling policy and priority, if specified
+    if (entry.policy_set) {
+        struct sched_param param = {};
+        param.sched_priority = entry.priority;
+        int res = ::pthread_setschedparam(thread, entry.policy, &param);
+        report << ", " << ((entry.policy == SCHED_FIFO) ? "SCHED_FIFO" : "SCHED_OTHER") << " priority " << entry.priority;
+        if (res != 0) {
+            report << " (FAILED: " << std::strerror(res) << ")";
+        }
+    }
+
+    // Set the CPU affinity, if specified
+    if (!entry.cpus.empty()) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        report << ", cpus";
+        for (uint cpu : entry.cpus) {
+            CPU_SET(cpu, &cpus);
+            report << " " << cpu;
+        }
+        int res = ::pthread_setaffinity_np(thread, sizeof(cpus), &cpus);
+        if (res != 0) {
+            report << " (FAILED: " << std::strerror(res) << ")";
+        }
+    }
+
+    // Report the config applied
+    MSG(report.str());
+}
@@ -0,0 +1,31 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  thread_config.h
+ * @brief Thread Config class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _THREAD_CONFIG_H
+#define _THREAD_CONFIG_H
+
+#include <pthread.h>
+#include <string>
+
+// Thread Config
+// The scheduling policy, priority, CPU affinity and name of each named engine
+// thread, read from the thread config file on startup. For example:
+// [{"thread": "midi_event", "policy": "SCHED_FIFO", "priority": 10, "cpus": [2]}]
+// Threads not in the file, and any settings not specified, keep the defaults set
+// by the code that creates the thread. A priority is only applied with a policy.
+// Where several threads share a config (e.g. the executor workers), each is
+// named with its own suffix
+class ThreadConfig
+{
+public:
+    // Public functions
+    static void Load();
+    static void Apply(pthread_t thread, const char *id, const std::string& name_suffix = "");
+};
+
+#endif // _THREAD_CONFIG_H
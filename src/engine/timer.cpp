@@ -12,29 +12,64 @@
 #include <iostream>
 #include "timer.h"
 #include "ui_common.h"
+#include "thread_config.h"
 
+// Executor Timer State
+// Shared with the callbacks scheduled on the executor, so that a callback
+// scheduled before the timer is stopped (or destroyed) can safely check if it is
+// still current
+struct ExecutorTimerState
+{
+	std::mutex mutex;
+	TimerType timer_type;
+	ExecutorPriority priority;
+	std::atomic<bool> timer_running;
+	std::atomic<uint64_t> generation;
+	std::atomic<int> interval_us;
+	std::function<void(void)> callback_fn;
+};
+
+// Static functions
+static void _schedule_executor_timer(std::shared_ptr<ExecutorTimerState> state, uint64_t generation, std::chrono::steady_clock::time_point time);
+static void _executor_timer_callback(std::shared_ptr<ExecutorTimerState> state, uint64_t generation, std::chrono::steady_clock::time_point time);
+static std::chrono::steady_clock::time_point _next_deadline(std::chrono::steady_clock::time_point deadline, std::chrono::microseconds interval);
 
 //----------------------------------------------------------------------------
 // Timer
 //----------------------------------------------------------------------------
-Timer::Timer(TimerType type)
+Timer::Timer(TimerType type, const char *thread_id)
 {
 	// Initialise the private data
 	_timer_type = type;
 	_timer_running = false;
 	_timer_signalled = false;
 	_timer_thread = 0;
+	_thread_id = thread_id;
 	_interval_us = 0;
 	_callback_fn = 0;
 }
 
+//----------------------------------------------------------------------------
+// Timer
+//----------------------------------------------------------------------------
+Timer::Timer(TimerType type, ExecutorPriority priority) : Timer(type)
+{
+	// Initialise the executor timer state
+	_executor_state = std::make_shared<ExecutorTimerState>();
+	_executor_state->timer_type = type;
+	_executor_state->priority = priority;
+	_executor_state->timer_running = false;
+	_executor_state->generation = 0;
+	_executor_state->interval_us = 0;
+}
+
 //----------------------------------------------------------------------------
 // ~Timer
 //----------------------------------------------------------------------------
 Timer::~Timer()
 {
 	// Stop the timer if running
-	if (_timer_running)
+	if (_timer_running || (_executor_state && _executor_state->timer_running))
     	stop();
 }
 
@@ -45,6 +80,19 @@ void Timer::start(int interval_us, std::function<void(void)> callback_fn)
 {
 	// Assumes the timer is stopped if already running
 
+	// If this timer runs on the executor
+	if (_executor_state)
+	{
+		// Set the interval and callback function, and schedule the first callback
+		std::lock_guard<std::mutex> lk(_executor_state->mutex);
+		_executor_state->interval_us = interval_us;
+		_executor_state->callback_fn = callback_fn;
+		_executor_state->timer_running = true;
+		_schedule_executor_timer(_executor_state, ++_executor_state->generation,
+								 std::chrono::steady_clock::now() + std::chrono::microseconds(interval_us));
+		return;
+	}
+
 	// Set the interval and callback function
 	_interval_us = interval_us;
 	_callback_fn = callback_fn;
@@ -55,6 +103,7 @@ void Timer::start(int interval_us, std::function<void(void)> callback_fn)
 
 	// Start the timer thread
 	_timer_thread = new std::thread(&Timer::_timer_callback, this);
+	ThreadConfig::Apply(_timer_thread->native_handle(), _thread_id);
 }
 
 //----------------------------------------------------------------------------
@@ -62,6 +111,16 @@ void Timer::start(int interval_us, std::function<void(void)> callback_fn)
 //----------------------------------------------------------------------------
 void Timer::signal()
 {
+	// If this timer runs on the executor
+	if (_executor_state)
+	{
+		// Schedule the callback now - any callback already scheduled is no longer
+		// current
+		if (_executor_state->timer_running)
+			_schedule_executor_timer(_executor_state, ++_executor_state->generation, std::chrono::steady_clock::now());
+		return;
+	}
+
 	// Signal the timer
 	_timer_signalled = true;
 	_cv.notify_all();
@@ -74,6 +133,8 @@ void Timer::change_interval(int interval_us)
 {
 	// Get the mutex and change the timer interval
 	_interval_us = interval_us;
+	if (_executor_state)
+		_executor_state->interval_us = interval_us;
 }
 
 //----------------------------------------------------------------------------
@@ -81,6 +142,17 @@ void Timer::change_interval(int interval_us)
 //----------------------------------------------------------------------------
 void Timer::stop()
 {
+	// If this timer runs on the executor
+	if (_executor_state)
+	{
+		// Stop the timer - any scheduled callback is no longer current
+		// Note: Waits for the callback to finish if it is running
+		std::lock_guard<std::mutex> lk(_executor_state->mutex);
+		_executor_state->timer_running = false;
+		_executor_state->generation++;
+		return;
+	}
+
 	// Stop the timer
 	{
 		std::lock_guard<std::mutex> lk(_mutex);
@@ -105,6 +177,8 @@ void Timer::stop()
 //----------------------------------------------------------------------------
 bool Timer::is_running()
 {
+	if (_executor_state)
+		return _executor_state->timer_running;
     return (_timer_thread && _timer_running);
 }
 
@@ -113,7 +187,8 @@ bool Timer::is_running()
 //----------------------------------------------------------------------------
 void Timer::_timer_callback()
 {
-	std::chrono::duration<double> adj = std::chrono::microseconds(0);
+	// Calculate the first deadline
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(_interval_us);
 
 	// Do forever until stopped
 	while (true)
@@ -121,18 +196,12 @@ void Timer::_timer_callback()
 		// Get the mutex lock
 		std::unique_lock<std::mutex> lk(_mutex);
 
-		// Calculate the wait duration
-		auto const timeout = std::chrono::steady_clock::now() + std::chrono::microseconds(_interval_us) - adj;
-
 		// Wait for either a timeout or for the timer to be signalled
-		bool res = _cv.wait_until(lk, timeout, [this]{return _timer_signalled;});
+		bool res = _cv.wait_until(lk, deadline, [this]{return _timer_signalled;});
 
 		// Did either a timeout occur, or the timer signalled and still running?
 		if (!res || _timer_running)
 		{
-			// Save the time at the start of processing
-			std::chrono::_V2::system_clock::time_point start = std::chrono::high_resolution_clock::now();
-
 			// Call the callback function
 			(_callback_fn)();
 
@@ -140,11 +209,13 @@ void Timer::_timer_callback()
 			if (_timer_type == TimerType::ONE_SHOT)
 				break;
 			
+			// Calculate the next deadline - if the timer was signalled, the deadlines
+			// now start from when it was signalled
+			deadline = _next_deadline((_timer_signalled ? std::chrono::steady_clock::now() : deadline),
+									  std::chrono::microseconds(_interval_us));
+
 			// Reset the timer signalled indicator
 			_timer_signalled = false;
-
-			// Calculate the processing time adjustment
-			adj = std::chrono::high_resolution_clock::now() - start;			
 		}
 		else 
 		{
@@ -158,3 +229,57 @@ void Timer::_timer_callback()
 	// Indicate the timer is no longer running
 	_timer_running = false;
 }
+
+//----------------------------------------------------------------------------
+// _schedule_executor_timer
+//----------------------------------------------------------------------------
+static void _schedule_executor_timer(std::shared_ptr<ExecutorTimerState> state, uint64_t generation, std::chrono::steady_clock::time_point time)
+{
+	// Schedule the timer callback on the executor
+	auto priority = state->priority;
+	Executor::PostAt(priority, time, [state = std::move(state), generation, time]() { _executor_timer_callback(state, generation, time); });
+}
+
+//----------------------------------------------------------------------------
+// _executor_timer_callback
+//----------------------------------------------------------------------------
+static void _executor_timer_callback(std::shared_ptr<ExecutorTimerState> state, uint64_t generation, std::chrono::steady_clock::time_point time)
+{
+	// Get the mutex lock
+	std::lock_guard<std::mutex> lk(state->mutex);
+
+	// Ignore this callback if the timer has been stopped, re-started, or signalled
+	// since it was scheduled
+	if (!state->timer_running || (generation != state->generation))
+		return;
+
+	// Call the callback function
+	(state->callback_fn)();
+
+	// Is this a one-shot timer? If so, the timer is no longer running
+	if (state->timer_type == TimerType::ONE_SHOT)
+	{
+		state->timer_running = false;
+		return;
+	}
+
+	// Schedule the next callback, if the timer was not signalled during the callback
+	if (generation == state->generation)
+		_schedule_executor_timer(state, generation, _next_deadline(time, std::chrono::microseconds(state->interval_us)));
+}
+
+//----------------------------------------------------------------------------
+// _next_deadline
+//----------------------------------------------------------------------------
+static std::chrono::steady_clock::time_point _next_deadline(std::chrono::steady_clock::time_point deadline, std::chrono::microseconds interval)
+{
+	// The next deadline is one interval from the previous deadline, rather than from
+	// when the callback ran, so that a periodic timer does not drift
+	// Note: If the callbacks have fallen behind, the missed deadlines are skipped so
+	// that the missed callbacks are not run in a burst, but the deadlines stay aligned
+	auto now = std::chrono::steady_clock::now();
+	deadline += interval;
+	if ((deadline < now) && (interval.count() > 0))
+		deadline += ((now - deadline) / interval + 1) * interval;
+	return deadline;
+}
@@ -14,6 +14,8 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <memory>
+#include "executor.h"
 
 // Timer Type
 enum class TimerType
@@ -22,12 +24,20 @@ enum class TimerType
 	PERIODIC
 };
 
+// Executor Timer State
+struct ExecutorTimerState;
+
 // Timer class
+// By default a timer runs its callback on its own thread - this should only be
+// used for timing critical timers, such as clocks, and the thread ID selects its
+// thread config. Otherwise, the timer should be
+// created with an executor priority, and its callback is scheduled on the executor
 class Timer
 {
 public:
     // Constructor
-    Timer(TimerType type);
+    Timer(TimerType type, const char *thread_id = "timer");
+    Timer(TimerType type, ExecutorPriority priority);
 
     // Destructor
     virtual ~Timer();
@@ -47,8 +57,10 @@ private:
     bool _timer_running;
     bool _timer_signalled;
     std::thread *_timer_thread;
+    const char *_thread_id;
     int _interval_us;
     std::function<void(void)> _callback_fn;
+    std::shared_ptr<ExecutorTimerState> _executor_state;
     
     // Private functions
     void _timer_callback();
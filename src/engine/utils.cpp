@@ -28,6 +28,7 @@
 #endif
 #include "system_func.h"
 #include "utils.h"
+#include "tempo_pulse_counter.h"
 
 // MACROs
 #define MONIQUE_RT_TASK_PRIORITY    45
@@ -95,6 +96,9 @@ LayerInfo _d0_layer(LayerId::D0);
 LayerInfo _d1_layer(LayerId::D1);
 std::atomic<LayerId> _current_layer_id { LayerId::D0 };
 std::mutex _params_mutex;
+std::mutex _control_states_mutex;
+std::unordered_map<std::string, uint> _control_state_ids;
+std::vector<std::vector<SfcControlParam *>> _control_states_table;
 std::vector<std::unique_ptr<Param>> _global_params;
 std::vector<std::unique_ptr<Param>> _layer_params;
 std::vector<std::string> _params_blacklist;
@@ -125,9 +129,11 @@ BaseManager *_sw_mgr;
 bool _seq_signalled = false;
 std::mutex _seq_mutex;
 std::condition_variable _seq_cv;
+std::chrono::steady_clock::time_point _seq_pulse_time;
 bool _arp_signalled = false;
 std::mutex _arp_mutex;
 std::condition_variable _arp_cv;
+std::chrono::steady_clock::time_point _arp_pulse_time;
 const char *_mod_state_prefix[] = {
     "key_pitch_mod_",
     "key_vel_mod_",
@@ -438,6 +444,26 @@ bool utils::is_current_layer(LayerId id)
     return id == _current_layer_id;
 }
 
+//----------------------------------------------------------------------------
+// get_all_params
+//----------------------------------------------------------------------------
+std::vector<Param *> utils::get_all_params()
+{
+    std::vector<Param *> params;
+
+    // Get the params mutex
+    std::lock_guard<std::mutex> lock(_params_mutex);
+
+    // Return the global and Layer params
+    for (const std::unique_ptr<Param> &p : _global_params) {
+        params.push_back(p.get());
+    }
+    for (const std::unique_ptr<Param> &p : _layer_params) {
+        params.push_back(p.get());
+    }
+    return params;
+}
+
 //----------------------------------------------------------------------------
 // get_global_params
 //----------------------------------------------------------------------------
@@ -654,30 +680,17 @@ std::vector<Param *> utils::get_params(const std::string param_path_regex)
 //----------------------------------------------------------------------------
 // get_params_with_state
 //----------------------------------------------------------------------------
-std::vector<SfcControlParam *> utils::get_params_with_state(const std::string state)
+std::vector<SfcControlParam *> utils::get_params_with_state(uint state_id)
 {
-    std::vector<SfcControlParam *> params;
+    // Get the control states mutex
+    std::lock_guard<std::mutex> lock(_control_states_mutex);
 
-    // Was a state specified?
-    if (state.size() > 0) {
-        // Get the params mutex
-        std::lock_guard<std::mutex> lock(_params_mutex);
-
-        // Parse the global params
-        for (const std::unique_ptr<Param> &p : _global_params) {
-            // If this is a Surface Control param
-            if (p->module() == MoniqueModule::SFC_CONTROL) {
-                SfcControlParam *sp = static_cast<SfcControlParam *>(p.get());
-
-                // Does the param have this state?
-                if (sp->has_control_state(state)) {
-                    // Yes, add it
-                    params.push_back(sp);
-                }
-            }
-        }
+    // Return the params with this state from the control states table, built
+    // when the param map was loaded
+    if (state_id < _control_states_table.size()) {
+        return _control_states_table[state_id];
     }
-    return params;
+    return std::vector<SfcControlParam *>();
 }
 
 //----------------------------------------------------------------------------
@@ -1399,9 +1412,70 @@ void utils::set_multifn_switches_state(MultifnSwitchesState state)
 //----------------------------------------------------------------------------
 void utils::set_controls_state(std::string state, EventRouter *event_router)
 {
-    auto sfc_func = SfcFunc(SfcFuncType::SET_CONTROLS_STATE, MoniqueModule::GUI);
-    sfc_func.controls_state = state;
-    event_router->post_sfc_func_event(new SfcFuncEvent(sfc_func));
+    // Get the ID of the state to set - if there are no controls with this state
+    // there is nothing to do
+    auto state_id = get_control_state_id(state);
+    if (state_id != CONTROL_STATE_ID_NONE) {
+        auto sfc_func = SfcFunc(SfcFuncType::SET_CONTROLS_STATE, MoniqueModule::GUI);
+        sfc_func.controls_state_id = state_id;
+        event_router->post_sfc_func_event(new SfcFuncEvent(sfc_func));
+    }
+}
+
+//----------------------------------------------------------------------------
+// register_control_state
+//----------------------------------------------------------------------------
+uint utils::register_control_state(const std::string& state)
+{
+    // Get the control states mutex
+    std::lock_guard<std::mutex> lock(_control_states_mutex);
+
+    // Return the ID of this state, adding it if it is a new state
+    // Note: IDs are dense, so they can index the control states table
+    auto [itr, added] = _control_state_ids.try_emplace(state, _control_state_ids.size());
+    return itr->second;
+}
+
+//----------------------------------------------------------------------------
+// get_control_state_id
+//----------------------------------------------------------------------------
+uint utils::get_control_state_id(const std::string& state)
+{
+    // Get the control states mutex
+    std::lock_guard<std::mutex> lock(_control_states_mutex);
+
+    // Return the ID of this state, if it has been registered
+    auto itr = _control_state_ids.find(state);
+    return (itr != _control_state_ids.end()) ? itr->second : CONTROL_STATE_ID_NONE;
+}
+
+//----------------------------------------------------------------------------
+// build_control_states_table
+//----------------------------------------------------------------------------
+void utils::build_control_states_table()
+{
+    std::vector<std::vector<SfcControlParam *>> table;
+
+    // Get the params mutex
+    std::lock_guard<std::mutex> lock(_params_mutex);
+
+    // Parse the global params, and add each Surface Control param to the
+    // table entry of each of its states
+    for (const std::unique_ptr<Param> &p : _global_params) {
+        if (p->module() == MoniqueModule::SFC_CONTROL) {
+            SfcControlParam *sp = static_cast<SfcControlParam *>(p.get());
+            for (uint state_id : sp->control_state_ids()) {
+                if (state_id >= table.size()) {
+                    table.resize(state_id + 1);
+                }
+                table[state_id].push_back(sp);
+            }
+        }
+    }
+
+    // Set the control states table
+    std::lock_guard<std::mutex> cs_lock(_control_states_mutex);
+    _control_states_table = std::move(table);
 }
 
 //----------------------------------------------------------------------------
@@ -1562,10 +1636,11 @@ std::mutex& utils::seq_mutex()
 //----------------------------------------------------------------------------
 void utils::seq_signal()
 {
-    // Signal the Sequencer
+    // Signal the Sequencer, and save the time of this tempo pulse
     {
         std::lock_guard lk(_seq_mutex);
         _seq_signalled = true;
+        _seq_pulse_time = std::chrono::steady_clock::now();
     }    
     _seq_cv.notify_all();
 }
@@ -1577,7 +1652,10 @@ void utils::seq_signal_without_lock()
 {
     // Signal the Sequencer without a lock - assumes the lock has
     // already been aquired
+    // Note: Notes sent for this signal are scheduled relative to this time, so
+    // it must be set here as well as for each tempo pulse
     _seq_signalled = true;  
+    _seq_pulse_time = std::chrono::steady_clock::now();
     _seq_cv.notify_all();
 }
 
@@ -1591,6 +1669,16 @@ void utils::seq_wait(std::unique_lock<std::mutex>& lk)
     _seq_signalled = false;
 }
 
+//----------------------------------------------------------------------------
+// seq_pulse_time
+//----------------------------------------------------------------------------
+std::chrono::steady_clock::time_point utils::seq_pulse_time()
+{
+    // Return the time of the last tempo pulse
+    // Note: Assumes the lock has already been aquired
+    return _seq_pulse_time;
+}
+
 //----------------------------------------------------------------------------
 // seq_chunk_param_reset_value
 //----------------------------------------------------------------------------
@@ -1613,10 +1701,11 @@ std::mutex& utils::arp_mutex()
 //----------------------------------------------------------------------------
 void utils::arp_signal()
 {
-    // Signal the Arpeggiator with a lock
+    // Signal the Arpeggiator with a lock, and save the time of this tempo pulse
     {
         std::lock_guard lk(_arp_mutex);
         _arp_signalled = true;
+        _arp_pulse_time = std::chrono::steady_clock::now();
     }    
     _arp_cv.notify_all();
 }
@@ -1628,7 +1717,10 @@ void utils::arp_signal_without_lock()
 {
     // Signal the Arpeggiator without a lock - assumes the lock has
     // already been aquired
+    // Note: Notes sent for this signal are scheduled relative to this time, so
+    // it must be set here as well as for each tempo pulse
     _arp_signalled = true;  
+    _arp_pulse_time = std::chrono::steady_clock::now();
     _arp_cv.notify_all();
 }
 
@@ -1642,6 +1734,16 @@ void utils::arp_wait(std::unique_lock<std::mutex>& lk)
     _arp_signalled = false;
 }
 
+//----------------------------------------------------------------------------
+// arp_pulse_time
+//----------------------------------------------------------------------------
+std::chrono::steady_clock::time_point utils::arp_pulse_time()
+{
+    // Return the time of the last tempo pulse
+    // Note: Assumes the lock has already been aquired
+    return _arp_pulse_time;
+}
+
 //----------------------------------------------------------------------------
 // get_tempo_param
 //----------------------------------------------------------------------------
@@ -1655,36 +1757,8 @@ Param *utils::get_tempo_param()
 // tempo_pulse_count
 //----------------------------------------------------------------------------
 uint utils::tempo_pulse_count(common::TempoNoteValue note_value) {
-    // Parse the note value
-    switch (note_value)
-    {
-        case common::TempoNoteValue::QUARTER:
-            return NUM_MIDI_CLOCK_PULSES_PER_QTR_NOTE_BEAT / 1;
-
-        case common::TempoNoteValue::EIGHTH:
-            return NUM_MIDI_CLOCK_PULSES_PER_QTR_NOTE_BEAT / 2;
-
-        case common::TempoNoteValue::SIXTEENTH:
-            return NUM_MIDI_CLOCK_PULSES_PER_QTR_NOTE_BEAT / 4;
-
-        case common::TempoNoteValue::THIRTYSECOND:
-            return NUM_MIDI_CLOCK_PULSES_PER_QTR_NOTE_BEAT / 8;
-
-        case common::TempoNoteValue::QUARTER_TRIPLETS:
-            return NUM_MIDI_CLOCK_PULSES_PER_QTR_NOTE_BEAT / 1.5;
-
-        case common::TempoNoteValue::EIGHTH_TRIPLETS:
-            return NUM_MIDI_CLOCK_PULSES_PER_QTR_NOTE_BEAT / 3;
-
-        case common::TempoNoteValue::SIXTEENTH_TRIPLETS:
-            return NUM_MIDI_CLOCK_PULSES_PER_QTR_NOTE_BEAT / 6;
-
-        case common::TempoNoteValue::THIRTYSECOND_TRIPLETS:
-            return NUM_MIDI_CLOCK_PULSES_PER_QTR_NOTE_BEAT / 12;
-
-        default:
-            return NUM_MIDI_CLOCK_PULSES_PER_QTR_NOTE_BEAT / 1;
-    }
+    // Return the number of MIDI clock pulses for the note value
+    return TempoPulseCounter::PulseCount(note_value);
 }
 
 //----------------------------------------------------------------------------
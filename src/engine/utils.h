@@ -13,6 +13,7 @@
 #include <vector>
 #include <mutex>
 #include <map>
+#include <chrono>
 #include <pthread.h>
 #include "monique_synth_parameters.h"
 #include "system_config.h"
@@ -166,6 +167,7 @@ namespace utils
     bool is_current_layer(LayerId id);
     
     // Param utilities
+    std::vector<Param *> get_all_params();
     std::vector<Param *> get_global_params();
     std::vector<Param *> get_layer_params();
     std::vector<Param *> get_preset_params();
@@ -174,7 +176,7 @@ namespace utils
     std::vector<SwitchParam *> get_multifn_switch_params();
     std::vector<Param *> get_params(MoniqueModule module);
     std::vector<Param *> get_params(const std::string param_path_regex);
-    std::vector<SfcControlParam *> get_params_with_state(const std::string state);
+    std::vector<SfcControlParam *> get_params_with_state(uint state_id);
     std::vector<SfcControlParam *> get_grouped_params(const std::string group_name);
     Param *get_param(std::string path);
     Param *get_param(MoniqueModule module, int param_id);
@@ -228,6 +230,11 @@ namespace utils
     void set_multifn_switches_state(MultifnSwitchesState state);
     void set_controls_state(std::string state, EventRouter *event_router);
 
+    // Control State utilities
+    uint register_control_state(const std::string& state);
+    uint get_control_state_id(const std::string& state);
+    void build_control_states_table();
+
     // Morph param utilities
     Param *get_morph_value_param();
     KnobParam *get_morph_knob_param();
@@ -254,11 +261,13 @@ namespace utils
     void seq_signal();
     void seq_signal_without_lock();
     void seq_wait(std::unique_lock<std::mutex>& lk);
+    std::chrono::steady_clock::time_point seq_pulse_time();
     const char *seq_chunk_param_reset_value();
     std::mutex& arp_mutex();
     void arp_signal();
     void arp_signal_without_lock();
     void arp_wait(std::unique_lock<std::mutex>& lk);
+    std::chrono::steady_clock::time_point arp_pulse_time();
     Param *get_tempo_param();
     uint tempo_pulse_count(common::TempoNoteValue note_value);
     common::TempoNoteValue tempo_note_value(int value);
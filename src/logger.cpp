@@ -69,9 +69,9 @@ void Logger::Flush()
 //----------------------------------------------------------------------------
 // module_name
 //----------------------------------------------------------------------------
-std::string Logger::module_name(MoniqueModule module)
+std::string_view Logger::module_name(MoniqueModule module)
 {
-    // Parse the module
+    // Parse the module - the names are static, so no string is created
     switch(module)
     {
         case MoniqueModule::ARP:
@@ -9,13 +9,44 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
-#include <string>
+#include <string_view>
 #include "spdlog/spdlog.h"
 
-#define MONIQUE_LOG_INFO(module, msg, ...)      Logger::LogInfo(module, msg, ##__VA_ARGS__)
-#define MONIQUE_LOG_WARNING(module, msg, ...)   Logger::LogWarning(module, msg, ##__VA_ARGS__)
-#define MONIQUE_LOG_ERROR(module, msg, ...)     Logger::LogError(module, msg, ##__VA_ARGS__)
-#define MONIQUE_LOG_CRITICAL(module, msg, ...)  Logger::LogCritical(module, msg, ##__VA_ARGS__)
+// Log levels
+#define MONIQUE_LOG_LEVEL_INFO      0
+#define MONIQUE_LOG_LEVEL_WARNING   1
+#define MONIQUE_LOG_LEVEL_ERROR     2
+#define MONIQUE_LOG_LEVEL_CRITICAL  3
+#define MONIQUE_LOG_LEVEL_OFF       4
+
+// Minimum log level - log calls below this level are removed at compile time
+#ifndef MONIQUE_LOG_LEVEL
+#define MONIQUE_LOG_LEVEL MONIQUE_LOG_LEVEL_INFO
+#endif
+
+// Log MACROs
+// Note: The log message must be a string literal, so that the module name prefix
+// is added at compile time
+#if MONIQUE_LOG_LEVEL <= MONIQUE_LOG_LEVEL_INFO
+#define MONIQUE_LOG_INFO(module, msg, ...)      Logger::LogInfo(module, "{} " msg, ##__VA_ARGS__)
+#else
+#define MONIQUE_LOG_INFO(module, msg, ...)      do { } while (false)
+#endif
+#if MONIQUE_LOG_LEVEL <= MONIQUE_LOG_LEVEL_WARNING
+#define MONIQUE_LOG_WARNING(module, msg, ...)   Logger::LogWarning(module, "{} " msg, ##__VA_ARGS__)
+#else
+#define MONIQUE_LOG_WARNING(module, msg, ...)   do { } while (false)
+#endif
+#if MONIQUE_LOG_LEVEL <= MONIQUE_LOG_LEVEL_ERROR
+#define MONIQUE_LOG_ERROR(module, msg, ...)     Logger::LogError(module, "{} " msg, ##__VA_ARGS__)
+#else
+#define MONIQUE_LOG_ERROR(module, msg, ...)     do { } while (false)
+#endif
+#if MONIQUE_LOG_LEVEL <= MONIQUE_LOG_LEVEL_CRITICAL
+#define MONIQUE_LOG_CRITICAL(module, msg, ...)  Logger::LogCritical(module, "{} " msg, ##__VA_ARGS__)
+#else
+#define MONIQUE_LOG_CRITICAL(module, msg, ...)  do { } while (false)
+#endif
 #define MONIQUE_LOG_FLUSH()                     Logger::Flush()
 
 // Logger
@@ -27,24 +58,24 @@ public:
     static void Stop();
     static void Flush();
     template <typename ... Args>
-    static void LogInfo(MoniqueModule module, const std::string& msg, Args... args)
+    static void LogInfo(MoniqueModule module, std::string_view fmt, Args&&... args)
     {
-        _logger->info("{} " + msg, module_name(module), std::forward<Args>(args)...);
+        _logger->info(fmt, module_name(module), std::forward<Args>(args)...);
     }
     template <typename ... Args>
-    static void LogWarning(MoniqueModule module, const std::string& msg, Args... args)
+    static void LogWarning(MoniqueModule module, std::string_view fmt, Args&&... args)
     {
-        _logger->warn("{} " + msg, module_name(module), std::forward<Args>(args)...);
+        _logger->warn(fmt, module_name(module), std::forward<Args>(args)...);
     }
     template <typename ... Args>
-    static void LogError(MoniqueModule module, const std::string& msg, Args... args)
+    static void LogError(MoniqueModule module, std::string_view fmt, Args&&... args)
     {
-        _logger->error("{} " + msg, module_name(module), std::forward<Args>(args)...);
+        _logger->error(fmt, module_name(module), std::forward<Args>(args)...);
     }
     template <typename ... Args>
-    static void LogCritical(MoniqueModule module, const std::string& msg, Args... args)
+    static void LogCritical(MoniqueModule module, std::string_view fmt, Args&&... args)
     {
-        _logger->critical("{} " + msg, module_name(module), std::forward<Args>(args)...);
+        _logger->critical(fmt, module_name(module), std::forward<Args>(args)...);
     }
 
 private:
@@ -52,7 +83,7 @@ private:
     static std::shared_ptr<spdlog::logger> _logger;
 
     // Private functions
-    static std::string module_name(MoniqueModule module);
+    static std::string_view module_name(MoniqueModule module);
 };
 
 #endif // LOGGER_H
@@ -24,6 +24,10 @@
 #include "layer_info.h"
 #include "utils.h"
 #include "logger.h"
+#include "event_trace.h"
+#include "metrics.h"
+#include "executor.h"
+#include "thread_config.h"
 #include "ain.h"
 #include "version.h"
 
@@ -39,6 +43,7 @@ std::condition_variable exit_notifier;
 void _print_delia_ui_info();
 bool _check_pid();
 void _sigint_handler([[maybe_unused]] int sig);
+void _sigusr1_handler([[maybe_unused]] int sig);
 
 //----------------------------------------------------------------------------
 // main
@@ -52,6 +57,26 @@ int main(void)
     // Ignore broken pipe signals, handle in the app instead
     signal(SIGPIPE, SIG_IGN);
 
+    // Setup the event trace dump signal handler
+    signal(SIGUSR1, _sigusr1_handler);
+
+    // Start the trace thread, so that console messages don't block the
+    // calling thread
+    Trace::Start();
+
+    // Load the thread config, which is applied to each engine thread as it is
+    // created
+    ThreadConfig::Load();
+
+    // Start recording the event trace
+    EventTrace::Start();
+
+    // Start serving the metrics
+    Metrics::Start();
+
+    // Start the executor, which the managers and timers run on
+    Executor::Start();
+
     // Show the app info
     _print_delia_ui_info();
 
@@ -68,10 +93,14 @@ int main(void)
         // use this driver
         ain::init();
 
+        // Start sampling the analog inputs continuously, so that the managers can
+        // read the latest samples without blocking
+        ain::start_sampling();
+
         // Create the Event Router
         auto event_router = std::make_unique<EventRouter>();
 
-        // Create the manager threads
+        // Create the managers
         // Note 1: During creation, any associated params are registered
         // Note 2: The file manager must be created first so that it can create the param
         // blacklist (if any)
@@ -117,6 +146,10 @@ int main(void)
                 arp_manager->start();
                 pedals_manager->start();
                 sfc_control_manager->start();
+
+                // Startup is complete, so console messages are now dropped rather
+                // than block the calling thread
+                Trace::StartupComplete();
                         
                 // Wait forever for an exit signal
                 std::mutex m;
@@ -137,6 +170,7 @@ int main(void)
                 // Maintence mode - a software update is available and in progress
                 // Start the minimum managers to process the software update
                 sfc_control_manager->start();
+                Trace::StartupComplete();
 
                 // Wait forever for an exit signal
                 std::mutex m;
@@ -162,6 +196,18 @@ int main(void)
         Logger::Stop();
     }
 
+    // Stop the executor
+    Executor::Stop();
+
+    // Stop serving the metrics
+    Metrics::Stop();
+
+    // Stop recording the event trace
+    EventTrace::Stop();
+
+    // Stop the trace thread
+    Trace::Stop();
+
     // DELIA UI has exited
     MSG("DELIA UI exited");
     return 0;
@@ -239,3 +285,12 @@ void _sigint_handler([[maybe_unused]] int sig)
     exit_flag = true;
     exit_notifier.notify_one();
 }
+
+//----------------------------------------------------------------------------
+// _sigusr1_handler
+//----------------------------------------------------------------------------
+void _sigusr1_handler([[maybe_unused]] int sig)
+{
+    // Request a dump of the event trace
+    EventTrace::RequestDump();
+}
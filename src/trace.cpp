@@ -0,0 +1,287 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  trace.cpp
+ * @brief Trace implementation.
+ *-----------------------------------------------------------------------------
+ */
+#include <algorithm>
+#include <atomic>
+#include <streambuf>
+#include <thread>
+#include <vector>
+#include "ui_common.h"
+#include "trace.h"
+#include "metrics.h"
+
+// Constants
+constexpr uint TRACE_MSG_MAX_LEN      = 256;
+constexpr uint TRACE_RING_SIZE        = 64;
+constexpr uint TRACE_MAX_THREADS      = 64;
+constexpr auto TRACE_THREAD_POLL_TIME = std::chrono::milliseconds(10);
+constexpr auto TRACE_RING_FULL_WAIT   = std::chrono::milliseconds(1);
+
+// Trace Message
+struct TraceMsg
+{
+    uint64_t seq;
+    uint len;
+    char text[TRACE_MSG_MAX_LEN];
+};
+
+// Trace Stream Buffer
+// Formats into a fixed size buffer - anything that doesn't fit is truncated
+class TraceStreamBuf : public std::streambuf
+{
+public:
+    void reset(char *buf, uint size) { setp(buf, buf + size); }
+    char *buf() const { return pbase(); }
+    uint len() const { return pptr() - pbase(); }
+};
+
+// Trace Ring State
+enum class TraceRingState
+{
+    FREE,
+    IN_USE,
+    CLOSED
+};
+
+// Trace Ring
+// Single producer (the owning thread), single consumer (the trace thread) ring
+// of trace messages. When the owning thread exits the ring is closed, and once
+// its queued messages are written the trace thread frees it for reuse
+struct TraceRing
+{
+    TraceMsg msgs[TRACE_RING_SIZE];
+    std::atomic<uint64_t> write_pos = 0;
+    std::atomic<uint64_t> read_pos = 0;
+    std::atomic<TraceRingState> state = TraceRingState::FREE;
+};
+
+// Thread Trace
+// Per-thread trace stream and ring
+struct ThreadTrace
+{
+    TraceStreamBuf stream_buf;
+    std::ostream stream{&stream_buf};
+    TraceRing *ring = nullptr;
+    bool ring_unavailable = false;
+    char direct_buf[TRACE_MSG_MAX_LEN];
+    ~ThreadTrace() { if (ring) ring->state.store(TraceRingState::CLOSED, std::memory_order_release); }
+};
+
+// Static variables
+// Note: The rings are statically allocated and never freed, so a thread claiming
+// a ring on its first message never allocates or blocks
+static TraceRing _rings[TRACE_MAX_THREADS];
+static Metric _dropped_msgs("trace_dropped_total", MetricType::COUNTER);
+static std::atomic<bool> _running = false;
+static std::atomic<bool> _startup_complete = false;
+static std::atomic<uint> _num_writers = 0;
+static std::atomic<uint64_t> _next_seq = 0;
+static std::atomic<uint64_t> _dropped = 0;
+static std::thread *_trace_thread = nullptr;
+static thread_local ThreadTrace _thread_trace;
+
+//----------------------------------------------------------------------------
+// _get_thread_ring
+//----------------------------------------------------------------------------
+static TraceRing *_get_thread_ring()
+{
+    auto& tt = _thread_trace;
+
+    // Claim a free ring for this thread if needed
+    // Note: This is only done once for each thread - if all the rings are in use,
+    // the thread's messages are never queued
+    if (!tt.ring && !tt.ring_unavailable) {
+        for (auto& ring : _rings) {
+            auto state = TraceRingState::FREE;
+            if (ring.state.compare_exchange_strong(state, TraceRingState::IN_USE, std::memory_order_acquire)) {
+                tt.ring = &ring;
+                return tt.ring;
+            }
+        }
+        tt.ring_unavailable = true;
+    }
+    return tt.ring;
+}
+
+//----------------------------------------------------------------------------
+// _write_msgs
+//----------------------------------------------------------------------------
+static void _write_msgs()
+{
+    static std::vector<std::pair<TraceRing *, uint64_t>> read_positions;
+    static std::vector<TraceMsg *> msgs;
+
+    // Get the queued messages from each thread's ring
+    // Note: Only this thread frees a ring, so the rings are read without any lock
+    read_positions.clear();
+    msgs.clear();
+    for (auto& ring : _rings) {
+        if (ring.state.load(std::memory_order_acquire) == TraceRingState::FREE) {
+            continue;
+        }
+        uint64_t read_pos = ring.read_pos.load(std::memory_order_relaxed);
+        uint64_t write_pos = ring.write_pos.load(std::memory_order_acquire);
+        for (uint64_t pos=read_pos; pos<write_pos; pos++) {
+            msgs.push_back(&ring.msgs[pos % TRACE_RING_SIZE]);
+        }
+        read_positions.emplace_back(&ring, write_pos);
+    }
+    uint64_t dropped = _dropped.exchange(0, std::memory_order_relaxed);
+
+    // Write the messages in the order they were traced, then release them
+    std::sort(msgs.begin(), msgs.end(), [](const TraceMsg *a, const TraceMsg *b) { return a->seq < b->seq; });
+    for (const TraceMsg *msg : msgs) {
+        std::cout.write(msg->text, msg->len) << '\n';
+    }
+    if (dropped) {
+        std::cout << "Trace: " << dropped << " messages dropped\n";
+    }
+    if (!msgs.empty() || dropped) {
+        std::cout.flush();
+    }
+    for (auto& [ring, pos] : read_positions) {
+        ring->read_pos.store(pos, std::memory_order_release);
+    }
+
+    // Free the rings of any threads that have exited, once they are empty
+    for (auto& [ring, pos] : read_positions) {
+        if ((ring->state.load(std::memory_order_acquire) == TraceRingState::CLOSED) &&
+            (ring->write_pos.load(std::memory_order_acquire) == pos)) {
+            ring->write_pos.store(0, std::memory_order_relaxed);
+            ring->read_pos.store(0, std::memory_order_relaxed);
+            ring->state.store(TraceRingState::FREE, std::memory_order_release);
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// _process_trace
+//----------------------------------------------------------------------------
+static void _process_trace()
+{
+    // Write the queued messages until stopped
+    while (_running) {
+        std::this_thread::sleep_for(TRACE_THREAD_POLL_TIME);
+        _write_msgs();
+    }
+
+    // Write any remaining messages
+    _write_msgs();
+}
+
+//----------------------------------------------------------------------------
+// Start
+//----------------------------------------------------------------------------
+void Trace::Start()
+{
+    // Start the trace thread
+    if (!_trace_thread) {
+        _running = true;
+        _trace_thread = new std::thread(_process_trace);
+    }
+}
+
+//----------------------------------------------------------------------------
+// StartupComplete
+//----------------------------------------------------------------------------
+void Trace::StartupComplete()
+{
+    // From now on a message is dropped if its thread's ring is full
+    _startup_complete = true;
+}
+
+//----------------------------------------------------------------------------
+// Stop
+//----------------------------------------------------------------------------
+void Trace::Stop()
+{
+    // Stop the trace thread - any messages traced after this are written
+    // directly to the console
+    if (_trace_thread) {
+        _running = false;
+        if (_trace_thread->joinable()) {
+            _trace_thread->join();
+        }
+        delete _trace_thread;
+        _trace_thread = nullptr;
+
+        // Wait for any thread still formatting a message into its ring, then
+        // write any messages queued while the thread was stopping
+        while (_num_writers.load() > 0) {
+            std::this_thread::yield();
+        }
+        _write_msgs();
+    }
+}
+
+//----------------------------------------------------------------------------
+// Begin
+//----------------------------------------------------------------------------
+std::ostream& Trace::Begin()
+{
+    auto& tt = _thread_trace;
+
+    // If the trace thread is running, format into the next message in this
+    // thread's ring, otherwise into a local buffer
+    // Note: The writer count is held until End, so that Stop always waits for a
+    // message being formatted into a ring to be queued before writing the rings
+    // for the last time
+    char *buf = tt.direct_buf;
+    _num_writers.fetch_add(1);
+    auto ring = _running ? _get_thread_ring() : nullptr;
+    if (ring) {
+        // Wait for space in the ring if needed
+        // Note: Once startup is complete no thread ever waits - if the ring is full
+        // the message is formatted into the local buffer and then dropped. During
+        // startup the thread waits for the trace thread to write its queued messages,
+        // so that the startup output is never lost
+        uint64_t write_pos = ring->write_pos.load(std::memory_order_relaxed);
+        while (true) {
+            if ((write_pos - ring->read_pos.load(std::memory_order_acquire)) < TRACE_RING_SIZE) {
+                buf = ring->msgs[write_pos % TRACE_RING_SIZE].text;
+                break;
+            }
+            if (_startup_complete || !_running) {
+                break;
+            }
+            std::this_thread::sleep_for(TRACE_RING_FULL_WAIT);
+        }
+    }
+    tt.stream.clear();
+    tt.stream_buf.reset(buf, TRACE_MSG_MAX_LEN);
+    return tt.stream;
+}
+
+//----------------------------------------------------------------------------
+// End
+//----------------------------------------------------------------------------
+void Trace::End()
+{
+    auto& tt = _thread_trace;
+
+    // Was the message formatted into the ring?
+    if (tt.stream_buf.buf() != tt.direct_buf) {
+        // Queue the message
+        uint64_t write_pos = tt.ring->write_pos.load(std::memory_order_relaxed);
+        auto& msg = tt.ring->msgs[write_pos % TRACE_RING_SIZE];
+        msg.seq = _next_seq.fetch_add(1, std::memory_order_relaxed);
+        msg.len = tt.stream_buf.len();
+        tt.ring->write_pos.store(write_pos + 1, std::memory_order_release);
+    }
+    else if (_running && _startup_complete) {
+        // The ring is full (or no ring is available), drop the message
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        _dropped_msgs.inc();
+    }
+    else {
+        // The trace thread is not running (or no ring is available during startup),
+        // write the message directly
+        std::cout.write(tt.direct_buf, tt.stream_buf.len()) << std::endl;
+    }
+    _num_writers.fetch_sub(1);
+}
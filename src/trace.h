@@ -0,0 +1,34 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  trace.h
+ * @brief Trace class definitions.
+ *-----------------------------------------------------------------------------
+ */
+#ifndef _TRACE_H
+#define _TRACE_H
+
+#include <ostream>
+
+// Trace
+// Console messages (MSG/DEBUG_MSG) are formatted into a fixed size per-thread
+// buffer, and queued in a per-thread lock-free ring. A background thread writes
+// the queued messages to the console, so the calling thread never blocks on
+// the console output. Once startup is complete, a message is dropped if its
+// thread's ring is full, and the number of dropped messages is reported (and
+// counted in the trace_dropped_total metric) - during startup the thread waits for
+// space in its ring instead, so no startup message is lost. If the trace thread is
+// not running, messages are written directly to the console
+class Trace
+{
+public:
+    // Public functions
+    static void Start();
+    static void StartupComplete();
+    static void Stop();
+    static std::ostream& Begin();
+    static void End();
+};
+
+#endif // _TRACE_H
@@ -14,9 +14,11 @@
 #include <chrono>
 #include <iostream>
 #include "common.h"
+#include "trace.h"
 
 // MACRO to show a string on the console
-#define MSG(str) do { std::cout << str << std::endl; } while( false )
+// Note: The string is queued and written by the trace thread, see trace.h
+#define MSG(str) do { Trace::Begin() << str; Trace::End(); } while( false )
 
 // MACRO to show a debug string on the console
 #ifndef NDEBUG
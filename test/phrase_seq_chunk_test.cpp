@@ -0,0 +1,211 @@
+/**
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2023-2024 Melbourne Instruments, Australia
+ *-----------------------------------------------------------------------------
+ * @file  phrase_seq_chunk_test.cpp
+ * @brief Phrase Sequencer Chunk test.
+ *
+ * Records a phrase of well over 2000 events (the previous max phrase length)
+ * into a Phrase Sequencer Timeline, saves it as chunks, reloads it from the
+ * chunks and checks every event is unchanged. Also checks a phrase saved with
+ * the previous 10 event chunks still loads, and that a phrase without an end of
+ * phrase event does not continue into a chunk saved previously. Returns a non-zero
+ * exit code if any check fails.
+ *-----------------------------------------------------------------------------
+ */
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "phrase_seq_chunk.h"
+
+// Constants
+constexpr uint MAX_EVENTS          = 20000;
+constexpr uint MAX_CHUNKS          = (MAX_EVENTS / phrase_seq_chunk::CHUNK_MAX_EVENTS) + 1;
+constexpr uint NUM_RECORDED_NOTES  = 4000;
+constexpr uint NOTE_TICKS          = (PPQN / 4);
+constexpr uint MAX_REPORTED_ERRORS = 20;
+
+// Global variables
+static uint _num_errors = 0;
+
+//----------------------------------------------------------------------------
+// _check
+//----------------------------------------------------------------------------
+static void _check(bool result, const std::string& msg)
+{
+    // Report the check if it failed
+    if (!result) {
+        if (_num_errors < MAX_REPORTED_ERRORS) {
+            std::printf("FAILED: %s\n", msg.c_str());
+        }
+        _num_errors++;
+    }
+}
+
+//----------------------------------------------------------------------------
+// _note_event
+//----------------------------------------------------------------------------
+static PhraseSeqEvent _note_event(uint32_t ticks, uint note, uint velocity)
+{
+    // Create a note event on channel 0
+    auto ev = PhraseSeqEvent();
+    ev.type = PhraseSeqEventType::NOTE;
+    ev.note_event.type = velocity ? snd_seq_event_type::SND_SEQ_EVENT_NOTEON : snd_seq_event_type::SND_SEQ_EVENT_NOTEOFF;
+    ev.note_event.data.note.channel = 0;
+    ev.note_event.data.note.note = note;
+    ev.note_event.data.note.velocity = velocity;
+    ev.ticks = ticks;
+    ev.qnt_ticks = ticks;
+    return ev;
+}
+
+//----------------------------------------------------------------------------
+// _load
+//----------------------------------------------------------------------------
+static std::vector<PhraseSeqEvent> _load(const std::vector<std::string>& chunks)
+{
+    std::vector<PhraseSeqEvent> events;
+
+    // Decode each chunk until the end of the phrase
+    for (const auto& chunk : chunks) {
+        if (!phrase_seq_chunk::decode(chunk, events)) {
+            break;
+        }
+    }
+    return events;
+}
+
+//----------------------------------------------------------------------------
+// _same_event
+//----------------------------------------------------------------------------
+static bool _same_event(const PhraseSeqEvent& a, const PhraseSeqEvent& b)
+{
+    // Compare the saved fields of each event
+    if ((a.type != b.type) || (a.ticks != b.ticks)) {
+        return false;
+    }
+    return (a.type == PhraseSeqEventType::END_OF_PHRASE) ||
+           ((a.note_event.type == b.note_event.type) &&
+            (a.note_event.data.note.channel == b.note_event.data.note.channel) &&
+            (a.note_event.data.note.note == b.note_event.data.note.note) &&
+            (a.note_event.data.note.velocity == b.note_event.data.note.velocity));
+}
+
+//----------------------------------------------------------------------------
+// _check_long_phrase
+//----------------------------------------------------------------------------
+static void _check_long_phrase()
+{
+    // Record a NOTE ON and NOTE OFF for each note, followed by the end of phrase
+    PhraseSeqTimeline timeline(MAX_EVENTS, [](PhraseSeqEvent&, const PhraseSeqEvent *) {});
+    for (uint i=0; i<NUM_RECORDED_NOTES; i++) {
+        timeline.add_event(_note_event((i * NOTE_TICKS), (i % 128), ((i % 127) + 1)));
+        timeline.add_event(_note_event(((i * NOTE_TICKS) + (NOTE_TICKS / 2)), (i % 128), 0));
+    }
+    auto eop = PhraseSeqEvent();
+    eop.type = PhraseSeqEventType::END_OF_PHRASE;
+    eop.ticks = NUM_RECORDED_NOTES * NOTE_TICKS;
+    eop.qnt_ticks = eop.ticks;
+    timeline.add_event(eop);
+    auto& recorded = timeline.events();
+    _check(!timeline.full(), "Timeline full after " + std::to_string(recorded.size()) + " events");
+    _check(recorded.size() > 2000, "Recorded phrase not longer than 2000 events");
+
+    // Save the phrase, and check it fits in the chunks
+    auto chunks = phrase_seq_chunk::encode(recorded, 0, MAX_CHUNKS);
+    _check(chunks.size() <= MAX_CHUNKS, "Too many chunks: " + std::to_string(chunks.size()));
+
+    // Reload the phrase and check every event
+    auto loaded = _load(chunks);
+    _check(loaded.size() == recorded.size(), "Loaded " + std::to_string(loaded.size()) + " events, recorded " + std::to_string(recorded.size()));
+    for (uint i=0; (i<loaded.size()) && (i<recorded.size()); i++) {
+        _check(_same_event(loaded[i], recorded[i]), "Event " + std::to_string(i) + " differs");
+    }
+
+    // Re-save from a later chunk (as when events are added), and check the chunks
+    // before it are not needed and the chunks after are unchanged
+    uint first_chunk = chunks.size() / 2;
+    auto later_chunks = phrase_seq_chunk::encode(recorded, first_chunk, MAX_CHUNKS);
+    _check(later_chunks.size() == (chunks.size() - first_chunk), "Re-saved chunk count differs");
+    for (uint i=0; (i<later_chunks.size()) && ((first_chunk + i)<chunks.size()); i++) {
+        _check(later_chunks[i] == chunks[first_chunk + i], "Re-saved chunk " + std::to_string(first_chunk + i) + " differs");
+    }
+}
+
+//----------------------------------------------------------------------------
+// _check_previous_chunks
+//----------------------------------------------------------------------------
+static void _check_previous_chunks()
+{
+    // A phrase of 15 notes saved with the previous 10 event chunks - the last chunk
+    // is padded with the chunk reset value
+    std::string padding = "00000000FFFFFF";
+    std::string chunk_1;
+    std::string chunk_2;
+    for (uint i=0; i<10; i++) {
+        char str_event[15];
+        std::snprintf(str_event, sizeof(str_event), "%08X%02X%02X%02X", (i * NOTE_TICKS), 0, (60 + i), 100);
+        chunk_1 += str_event;
+    }
+    for (uint i=10; i<15; i++) {
+        char str_event[15];
+        std::snprintf(str_event, sizeof(str_event), "%08X%02X%02X%02X", (i * NOTE_TICKS), 0, (60 + i), 100);
+        chunk_2 += str_event;
+    }
+    chunk_2 += "000005A0FEFFFF";
+    while (chunk_2.size() < chunk_1.size()) {
+        chunk_2 += padding;
+    }
+
+    // Check the phrase loads
+    auto loaded = _load({chunk_1, chunk_2, chunk_1});
+    _check(loaded.size() == 16, "Previous chunks loaded " + std::to_string(loaded.size()) + " events, expected 16");
+    for (uint i=0; (i<loaded.size()) && (i<15); i++) {
+        _check(_same_event(loaded[i], _note_event((i * NOTE_TICKS), (60 + i), 100)), "Previous chunks event " + std::to_string(i) + " differs");
+    }
+    _check(!loaded.empty() && (loaded.back().type == PhraseSeqEventType::END_OF_PHRASE) && (loaded.back().ticks == 0x5A0),
+           "Previous chunks end of phrase differs");
+}
+
+//----------------------------------------------------------------------------
+// _check_no_end_of_phrase
+//----------------------------------------------------------------------------
+static void _check_no_end_of_phrase()
+{
+    // Save a long phrase, and then a short phrase without an end of phrase event
+    // over it
+    std::vector<PhraseSeqEvent> long_phrase;
+    for (uint i=0; i<(phrase_seq_chunk::CHUNK_MAX_EVENTS * 3); i++) {
+        long_phrase.push_back(_note_event((i * NOTE_TICKS), 60, 100));
+    }
+    std::vector<PhraseSeqEvent> short_phrase(long_phrase.begin(), long_phrase.begin() + (phrase_seq_chunk::CHUNK_MAX_EVENTS + 1));
+    auto chunks = phrase_seq_chunk::encode(long_phrase, 0, MAX_CHUNKS);
+    auto short_chunks = phrase_seq_chunk::encode(short_phrase, 0, MAX_CHUNKS);
+    for (uint i=0; i<short_chunks.size(); i++) {
+        chunks[i] = short_chunks[i];
+    }
+
+    // Check only the short phrase loads
+    auto loaded = _load(chunks);
+    _check(loaded.size() == short_phrase.size(), "Phrase without end of phrase loaded " + std::to_string(loaded.size()) +
+                                                 " events, expected " + std::to_string(short_phrase.size()));
+}
+
+//----------------------------------------------------------------------------
+// main
+//----------------------------------------------------------------------------
+int main()
+{
+    // Run the checks
+    _check_long_phrase();
+    _check_previous_chunks();
+    _check_no_end_of_phrase();
+
+    // Show the result
+    if (_num_errors) {
+        std::printf("Phrase seq chunk test: %u checks FAILED\n", _num_errors);
+        return 1;
+    }
+    std::printf("Phrase seq chunk test: PASSED\n");
+    return 0;
+}